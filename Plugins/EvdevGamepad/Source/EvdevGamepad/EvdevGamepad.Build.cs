@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class EvdevGamepad : ModuleRules
+{
+	public EvdevGamepad(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "InputDevice" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "ApplicationCore", "InputCore" });
+	}
+}
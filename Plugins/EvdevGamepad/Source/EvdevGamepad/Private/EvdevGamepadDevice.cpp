@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EvdevGamepadDevice.h"
+#include "GenericPlatform/GenericApplicationMessageHandler.h"
+
+FEvdevGamepadDevice::FEvdevGamepadDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler)
+	: MessageHandler(InMessageHandler)
+{
+	Reader.Start();
+}
+
+void FEvdevGamepadDevice::SendControllerEvents()
+{
+	Reader.DequeueEvents(Events);
+
+	for (const FEvdevInputEvent& Event : Events)
+	{
+		switch (Event.Type)
+		{
+		case FEvdevInputEvent::EType::Analog:
+			MessageHandler->OnControllerAnalog(Event.Key, Event.ControllerId, Event.Value);
+			break;
+		case FEvdevInputEvent::EType::Pressed:
+			MessageHandler->OnControllerButtonPressed(Event.Key, Event.ControllerId, false);
+			break;
+		case FEvdevInputEvent::EType::Released:
+			MessageHandler->OnControllerButtonReleased(Event.Key, Event.ControllerId, false);
+			break;
+		}
+	}
+	Events.Reset();
+}
+
+void FEvdevGamepadDevice::SetMessageHandler(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler)
+{
+	MessageHandler = InMessageHandler;
+}
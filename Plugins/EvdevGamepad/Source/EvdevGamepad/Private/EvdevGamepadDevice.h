@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IInputDevice.h"
+#include "EvdevReader.h"
+
+/** Hands the reader's events to the application whenever it polls the game devices */
+class FEvdevGamepadDevice : public IInputDevice
+{
+public:
+	FEvdevGamepadDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler);
+
+	// IInputDevice interface
+	virtual void Tick(float DeltaTime) override {}
+	virtual void SendControllerEvents() override;
+	virtual void SetMessageHandler(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler) override;
+	virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override { return false; }
+	virtual void SetChannelValue(int32 ControllerId, FForceFeedbackChannelType ChannelType, float Value) override {}
+	virtual void SetChannelValues(int32 ControllerId, const FForceFeedbackValues& Values) override {}
+	// End of IInputDevice interface
+
+	bool GetRightStick(FEvdevStickState& OutState) const { return Reader.GetRightStick(OutState); }
+	int32 GetNumGamepads() const { return Reader.GetNumGamepads(); }
+
+private:
+	TSharedRef<FGenericApplicationMessageHandler> MessageHandler;
+	FEvdevReader Reader;
+
+	/** Reused every poll */
+	TArray<FEvdevInputEvent> Events;
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "IEvdevGamepadModule.h"
+#include "EvdevGamepadDevice.h"
+
+class FEvdevGamepadModule : public IEvdevGamepadModule
+{
+public:
+	virtual TSharedPtr<IInputDevice> CreateInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler) override
+	{
+		TSharedPtr<FEvdevGamepadDevice> NewDevice = MakeShared<FEvdevGamepadDevice>(InMessageHandler);
+		Device = NewDevice;
+		return NewDevice;
+	}
+
+	virtual bool GetRightStick(FEvdevStickState& OutState) const override
+	{
+		TSharedPtr<FEvdevGamepadDevice> PinnedDevice = Device.Pin();
+		return PinnedDevice.IsValid() && PinnedDevice->GetRightStick(OutState);
+	}
+
+	virtual int32 GetNumGamepads() const override
+	{
+		TSharedPtr<FEvdevGamepadDevice> PinnedDevice = Device.Pin();
+		return PinnedDevice.IsValid() ? PinnedDevice->GetNumGamepads() : 0;
+	}
+
+private:
+	/** Owned by the application */
+	TWeakPtr<FEvdevGamepadDevice> Device;
+};
+
+IMPLEMENT_MODULE(FEvdevGamepadModule, EvdevGamepad)
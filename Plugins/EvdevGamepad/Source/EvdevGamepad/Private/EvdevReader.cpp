@@ -0,0 +1,606 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EvdevReader.h"
+#include "GenericPlatform/GenericApplicationMessageHandler.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+DEFINE_LOG_CATEGORY_STATIC(LogEvdevGamepad, Log, All);
+
+static TAutoConsoleVariable<int32> CVarEvdevGrab(
+	TEXT("EvdevGamepad.Grab"),
+	1,
+	TEXT("Grab gamepads exclusively when they are opened, so the platform's joystick layer doesn't report them a second time."),
+	ECVF_Default);
+
+namespace EvdevReader
+{
+	static const TCHAR* InputDirectory = TEXT("/dev/input");
+
+	/** Events not picked up by the game thread are dropped beyond this, oldest first */
+	static const int32 MaxQueuedEvents = 1024;
+
+	struct FAxisMapping
+	{
+		uint16 Code;
+		const FGamepadKeyNames::Type* Key;
+
+		/** evdev's Y axes grow downwards, the engine's upwards */
+		float Scale;
+
+		/** Rests at the minimum instead of the center */
+		bool bTrigger;
+	};
+
+	struct FButtonMapping
+	{
+		uint16 Code;
+		const FGamepadKeyNames::Type* Key;
+	};
+
+	struct FHatMapping
+	{
+		uint16 Code;
+		const FGamepadKeyNames::Type* NegativeKey;
+		const FGamepadKeyNames::Type* PositiveKey;
+	};
+
+	static const FAxisMapping AxisMappings[] =
+	{
+		{ ABS_X, &FGamepadKeyNames::LeftAnalogX, 1.f, false },
+		{ ABS_Y, &FGamepadKeyNames::LeftAnalogY, -1.f, false },
+		{ ABS_RX, &FGamepadKeyNames::RightAnalogX, 1.f, false },
+		{ ABS_RY, &FGamepadKeyNames::RightAnalogY, -1.f, false },
+		{ ABS_Z, &FGamepadKeyNames::LeftTriggerAnalog, 1.f, true },
+		{ ABS_RZ, &FGamepadKeyNames::RightTriggerAnalog, 1.f, true },
+	};
+
+	static const FButtonMapping ButtonMappings[] =
+	{
+		{ BTN_SOUTH, &FGamepadKeyNames::FaceButtonBottom },
+		{ BTN_EAST, &FGamepadKeyNames::FaceButtonRight },
+		{ BTN_WEST, &FGamepadKeyNames::FaceButtonLeft },
+		{ BTN_NORTH, &FGamepadKeyNames::FaceButtonTop },
+		{ BTN_TL, &FGamepadKeyNames::LeftShoulder },
+		{ BTN_TR, &FGamepadKeyNames::RightShoulder },
+		{ BTN_SELECT, &FGamepadKeyNames::SpecialLeft },
+		{ BTN_START, &FGamepadKeyNames::SpecialRight },
+		{ BTN_THUMBL, &FGamepadKeyNames::LeftThumb },
+		{ BTN_THUMBR, &FGamepadKeyNames::RightThumb },
+	};
+
+	static const FHatMapping HatMappings[] =
+	{
+		{ ABS_HAT0X, &FGamepadKeyNames::DPadLeft, &FGamepadKeyNames::DPadRight },
+		{ ABS_HAT0Y, &FGamepadKeyNames::DPadUp, &FGamepadKeyNames::DPadDown },
+	};
+
+	static bool TestBit(const uint8* Bits, int32 Bit)
+	{
+		return (Bits[Bit / 8] >> (Bit % 8)) & 1;
+	}
+
+	static double GetMonotonicSeconds()
+	{
+		timespec Now;
+		clock_gettime(CLOCK_MONOTONIC, &Now);
+		return Now.tv_sec + Now.tv_nsec * 1e-9;
+	}
+
+	static double ToSeconds(const timeval& Time)
+	{
+		return Time.tv_sec + Time.tv_usec * 1e-6;
+	}
+}
+
+FEvdevReader::FEvdevReader()
+	: EpollFd(-1)
+	, InotifyFd(-1)
+	, WakeFd(-1)
+	, Thread(nullptr)
+	, bHasRightStick(false)
+	, NumGamepads(0)
+{
+}
+
+FEvdevReader::~FEvdevReader()
+{
+	if (Thread != nullptr)
+	{
+		// calls Stop and waits for Run to return
+		Thread->Kill(true);
+		delete Thread;
+	}
+
+	TArray<int32> Fds;
+	Devices.GetKeys(Fds);
+	for (int32 Fd : Fds)
+	{
+		CloseDevice(Fd);
+	}
+
+	for (int32 Fd : { EpollFd, InotifyFd, WakeFd })
+	{
+		if (Fd >= 0)
+		{
+			close(Fd);
+		}
+	}
+}
+
+bool FEvdevReader::Start()
+{
+	EpollFd = epoll_create1(EPOLL_CLOEXEC);
+	WakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	InotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	if (EpollFd < 0 || WakeFd < 0 || InotifyFd < 0)
+	{
+		UE_LOG(LogEvdevGamepad, Warning, TEXT("Failed to set up epoll (errno %d), evdev gamepads are disabled"), errno);
+		return false;
+	}
+
+	// udev fixes the permissions after the node appears, so opening is retried on IN_ATTRIB
+	if (inotify_add_watch(InotifyFd, TCHAR_TO_UTF8(EvdevReader::InputDirectory), IN_CREATE | IN_ATTRIB) < 0)
+	{
+		UE_LOG(LogEvdevGamepad, Warning, TEXT("Can't watch %s (errno %d), gamepads connected later won't be seen"), EvdevReader::InputDirectory, errno);
+	}
+
+	for (int32 Fd : { WakeFd, InotifyFd })
+	{
+		epoll_event Event = {};
+		Event.events = EPOLLIN;
+		Event.data.fd = Fd;
+		epoll_ctl(EpollFd, EPOLL_CTL_ADD, Fd, &Event);
+	}
+
+	if (DIR* Directory = opendir(TCHAR_TO_UTF8(EvdevReader::InputDirectory)))
+	{
+		while (dirent* Entry = readdir(Directory))
+		{
+			if (FCStringAnsi::Strncmp(Entry->d_name, "event", 5) == 0)
+			{
+				OpenDevice(FString(EvdevReader::InputDirectory) / UTF8_TO_TCHAR(Entry->d_name));
+			}
+		}
+		closedir(Directory);
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("EvdevGamepad"), 0, TPri_AboveNormal);
+	return Thread != nullptr;
+}
+
+uint32 FEvdevReader::Run()
+{
+	epoll_event Events[16];
+	while (!bStopping)
+	{
+		const int32 NumReady = epoll_wait(EpollFd, Events, ARRAY_COUNT(Events), -1);
+		if (NumReady < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			UE_LOG(LogEvdevGamepad, Error, TEXT("epoll_wait failed (errno %d), no more gamepad input"), errno);
+			break;
+		}
+
+		for (int32 Index = 0; Index < NumReady; ++Index)
+		{
+			const int32 Fd = Events[Index].data.fd;
+			if (Fd == WakeFd)
+			{
+				continue;
+			}
+
+			if (Fd == InotifyFd)
+			{
+				ReadHotplug();
+			}
+			else if (Events[Index].events & EPOLLIN)
+			{
+				ReadDevice(Fd);
+			}
+			else
+			{
+				// unplugged
+				CloseDevice(Fd);
+			}
+		}
+	}
+	return 0;
+}
+
+void FEvdevReader::Stop()
+{
+	bStopping = true;
+
+	const uint64 One = 1;
+	if (write(WakeFd, &One, sizeof(One)) < 0)
+	{
+		UE_LOG(LogEvdevGamepad, Warning, TEXT("Failed to wake the reader thread (errno %d)"), errno);
+	}
+}
+
+void FEvdevReader::OpenDevice(const FString& Path)
+{
+	for (const TPair<int32, FDevice>& Pair : Devices)
+	{
+		if (Pair.Value.Path == Path)
+		{
+			return;
+		}
+	}
+
+	const int32 Fd = open(TCHAR_TO_UTF8(*Path), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (Fd < 0)
+	{
+		return;
+	}
+
+	uint8 KeyBits[KEY_MAX / 8 + 1] = {};
+	uint8 AbsBits[ABS_MAX / 8 + 1] = {};
+	ioctl(Fd, EVIOCGBIT(EV_KEY, sizeof(KeyBits)), KeyBits);
+	ioctl(Fd, EVIOCGBIT(EV_ABS, sizeof(AbsBits)), AbsBits);
+	if (!EvdevReader::TestBit(KeyBits, BTN_GAMEPAD) || !EvdevReader::TestBit(AbsBits, ABS_X))
+	{
+		close(Fd);
+		return;
+	}
+
+	// timestamps on the same clock as GetMonotonicSeconds, whatever the system default is
+	int32 ClockId = CLOCK_MONOTONIC;
+	ioctl(Fd, EVIOCSCLOCKID, &ClockId);
+
+	if (CVarEvdevGrab.GetValueOnAnyThread() != 0 && ioctl(Fd, EVIOCGRAB, 1) < 0)
+	{
+		UE_LOG(LogEvdevGamepad, Warning, TEXT("Can't grab %s, it may be reported twice"), *Path);
+	}
+
+	FDevice& Device = Devices.Add(Fd);
+	Device.Path = Path;
+
+	// lowest controller id that isn't taken
+	for (bool bTaken = true; bTaken; )
+	{
+		bTaken = false;
+		for (const TPair<int32, FDevice>& Pair : Devices)
+		{
+			if (Pair.Key != Fd && Pair.Value.ControllerId == Device.ControllerId)
+			{
+				++Device.ControllerId;
+				bTaken = true;
+			}
+		}
+	}
+
+	for (int32 Code = 0; Code < ABS_CNT; ++Code)
+	{
+		input_absinfo Info;
+		if (EvdevReader::TestBit(AbsBits, Code) && ioctl(Fd, EVIOCGABS(Code), &Info) == 0)
+		{
+			Device.AbsMin[Code] = Info.minimum;
+			Device.AbsMax[Code] = Info.maximum;
+			Device.AbsValue[Code] = Info.value;
+		}
+	}
+
+	epoll_event Event = {};
+	Event.events = EPOLLIN;
+	Event.data.fd = Fd;
+	epoll_ctl(EpollFd, EPOLL_CTL_ADD, Fd, &Event);
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		++NumGamepads;
+	}
+
+	char Name[256] = {};
+	ioctl(Fd, EVIOCGNAME(sizeof(Name) - 1), Name);
+	UE_LOG(LogEvdevGamepad, Display, TEXT("Opened %s (%s) as controller %d"), *Path, UTF8_TO_TCHAR(Name), Device.ControllerId);
+}
+
+void FEvdevReader::CloseDevice(int32 Fd)
+{
+	FDevice Device;
+	if (!Devices.RemoveAndCopyValue(Fd, Device))
+	{
+		return;
+	}
+
+	epoll_ctl(EpollFd, EPOLL_CTL_DEL, Fd, nullptr);
+	close(Fd);
+
+	// nothing stays held or deflected on a pad that's gone
+	const double Seconds = FPlatformTime::Seconds();
+	FScopeLock ScopeLock(&Lock);
+	for (const EvdevReader::FAxisMapping& Mapping : EvdevReader::AxisMappings)
+	{
+		QueueEvent(FEvdevInputEvent::EType::Analog, *Mapping.Key, Device.ControllerId, 0.f, Seconds);
+	}
+	for (int32 Index = 0; Index < ARRAY_COUNT(EvdevReader::ButtonMappings); ++Index)
+	{
+		if (Device.Buttons & (1u << Index))
+		{
+			QueueEvent(FEvdevInputEvent::EType::Released, *EvdevReader::ButtonMappings[Index].Key, Device.ControllerId, 0.f, Seconds);
+		}
+	}
+	for (int32 Index = 0; Index < ARRAY_COUNT(EvdevReader::HatMappings) * 2; ++Index)
+	{
+		if (Device.HatDirections & (1u << Index))
+		{
+			const EvdevReader::FHatMapping& Mapping = EvdevReader::HatMappings[Index / 2];
+			QueueEvent(FEvdevInputEvent::EType::Released, *(Index % 2 ? Mapping.PositiveKey : Mapping.NegativeKey), Device.ControllerId, 0.f, Seconds);
+		}
+	}
+
+	if (RightStick.ControllerId == Device.ControllerId)
+	{
+		bHasRightStick = false;
+	}
+	--NumGamepads;
+
+	UE_LOG(LogEvdevGamepad, Display, TEXT("Closed %s"), *Device.Path);
+}
+
+void FEvdevReader::ReadHotplug()
+{
+	alignas(inotify_event) char Buffer[4096];
+	for (;;)
+	{
+		const ssize_t Bytes = read(InotifyFd, Buffer, sizeof(Buffer));
+		if (Bytes <= 0)
+		{
+			return;
+		}
+
+		for (ssize_t Offset = 0; Offset < Bytes; )
+		{
+			const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+			if (Event->len > 0 && FCStringAnsi::Strncmp(Event->name, "event", 5) == 0)
+			{
+				OpenDevice(FString(EvdevReader::InputDirectory) / UTF8_TO_TCHAR(Event->name));
+			}
+			Offset += sizeof(inotify_event) + Event->len;
+		}
+	}
+}
+
+void FEvdevReader::ReadDevice(int32 Fd)
+{
+	FDevice* Device = Devices.Find(Fd);
+	if (Device == nullptr)
+	{
+		return;
+	}
+
+	input_event Events[64];
+	for (;;)
+	{
+		const ssize_t Bytes = read(Fd, Events, sizeof(Events));
+		if (Bytes < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			if (errno != EAGAIN)
+			{
+				CloseDevice(Fd);
+			}
+			return;
+		}
+		if (Bytes == 0)
+		{
+			return;
+		}
+
+		// kernel timestamps are CLOCK_MONOTONIC, the game runs on FPlatformTime
+		const double ClockOffset = FPlatformTime::Seconds() - EvdevReader::GetMonotonicSeconds();
+		const int32 NumEvents = Bytes / sizeof(input_event);
+		for (int32 Index = 0; Index < NumEvents; ++Index)
+		{
+			HandleEvent(Fd, *Device, Events[Index], ClockOffset);
+		}
+	}
+}
+
+void FEvdevReader::HandleEvent(int32 Fd, FDevice& Device, const input_event& Event, double ClockOffset)
+{
+	if (Event.type == EV_SYN)
+	{
+		if (Event.code == SYN_DROPPED)
+		{
+			Device.bDropped = true;
+		}
+		else if (Event.code == SYN_REPORT)
+		{
+			if (Device.bDropped)
+			{
+				Resync(Fd, Device);
+			}
+			Commit(Device, EvdevReader::ToSeconds(Event.time) + ClockOffset);
+		}
+		return;
+	}
+
+	// everything up to the report after a drop is incomplete, the resync replaces it
+	if (Device.bDropped)
+	{
+		return;
+	}
+
+	if (Event.type == EV_ABS && Event.code < ABS_CNT)
+	{
+		Device.AbsValue[Event.code] = Event.value;
+		Device.DirtyAbs |= 1ull << Event.code;
+	}
+	else if (Event.type == EV_KEY)
+	{
+		for (int32 Index = 0; Index < ARRAY_COUNT(EvdevReader::ButtonMappings); ++Index)
+		{
+			if (EvdevReader::ButtonMappings[Index].Code == Event.code)
+			{
+				// 2 is autorepeat, still held
+				const uint32 Bit = 1u << Index;
+				Device.Buttons = Event.value != 0 ? Device.Buttons | Bit : Device.Buttons & ~Bit;
+				Device.DirtyButtons |= Bit;
+				break;
+			}
+		}
+	}
+}
+
+void FEvdevReader::Resync(int32 Fd, FDevice& Device)
+{
+	for (int32 Code = 0; Code < ABS_CNT; ++Code)
+	{
+		input_absinfo Info;
+		if (Device.AbsMax[Code] != Device.AbsMin[Code] && ioctl(Fd, EVIOCGABS(Code), &Info) == 0)
+		{
+			Device.AbsValue[Code] = Info.value;
+			Device.DirtyAbs |= 1ull << Code;
+		}
+	}
+
+	uint8 KeyBits[KEY_MAX / 8 + 1] = {};
+	ioctl(Fd, EVIOCGKEY(sizeof(KeyBits)), KeyBits);
+	uint32 Buttons = 0;
+	for (int32 Index = 0; Index < ARRAY_COUNT(EvdevReader::ButtonMappings); ++Index)
+	{
+		if (EvdevReader::TestBit(KeyBits, EvdevReader::ButtonMappings[Index].Code))
+		{
+			Buttons |= 1u << Index;
+		}
+	}
+	Device.DirtyButtons |= Buttons ^ Device.Buttons;
+	Device.Buttons = Buttons;
+
+	Device.bDropped = false;
+	UE_LOG(LogEvdevGamepad, Verbose, TEXT("Resynced %s after dropped events"), *Device.Path);
+}
+
+void FEvdevReader::Commit(FDevice& Device, double Seconds)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	for (const EvdevReader::FAxisMapping& Mapping : EvdevReader::AxisMappings)
+	{
+		if (Device.DirtyAbs & (1ull << Mapping.Code))
+		{
+			QueueEvent(FEvdevInputEvent::EType::Analog, *Mapping.Key, Device.ControllerId, GetAxisValue(Device, Mapping.Code, Mapping.bTrigger) * Mapping.Scale, Seconds);
+		}
+	}
+
+	for (int32 Index = 0; Index < ARRAY_COUNT(EvdevReader::ButtonMappings); ++Index)
+	{
+		const uint32 Bit = 1u << Index;
+		if (Device.DirtyButtons & Bit)
+		{
+			const FEvdevInputEvent::EType Type = (Device.Buttons & Bit) ? FEvdevInputEvent::EType::Pressed : FEvdevInputEvent::EType::Released;
+			QueueEvent(Type, *EvdevReader::ButtonMappings[Index].Key, Device.ControllerId, 0.f, Seconds);
+		}
+	}
+
+	for (int32 Index = 0; Index < ARRAY_COUNT(EvdevReader::HatMappings); ++Index)
+	{
+		const EvdevReader::FHatMapping& Mapping = EvdevReader::HatMappings[Index];
+		if (Device.DirtyAbs & (1ull << Mapping.Code))
+		{
+			const int32 Value = Device.AbsValue[Mapping.Code];
+			const uint32 Directions = (Value < 0 ? 1u : 0u) | (Value > 0 ? 2u : 0u);
+			const uint32 Changed = Directions ^ ((Device.HatDirections >> (Index * 2)) & 3u);
+			if (Changed & 1u)
+			{
+				QueueEvent((Directions & 1u) ? FEvdevInputEvent::EType::Pressed : FEvdevInputEvent::EType::Released, *Mapping.NegativeKey, Device.ControllerId, 0.f, Seconds);
+			}
+			if (Changed & 2u)
+			{
+				QueueEvent((Directions & 2u) ? FEvdevInputEvent::EType::Pressed : FEvdevInputEvent::EType::Released, *Mapping.PositiveKey, Device.ControllerId, 0.f, Seconds);
+			}
+			Device.HatDirections = (Device.HatDirections & ~(3u << (Index * 2))) | (Directions << (Index * 2));
+		}
+	}
+
+	// the stick that moved last is the one aiming, every later report of its pad says it's still current
+	const uint64 RightStickBits = (1ull << ABS_RX) | (1ull << ABS_RY);
+	if (Device.DirtyAbs & RightStickBits)
+	{
+		RightStick.X = GetAxisValue(Device, ABS_RX, false);
+		RightStick.Y = -GetAxisValue(Device, ABS_RY, false);
+		RightStick.ControllerId = Device.ControllerId;
+		bHasRightStick = true;
+	}
+	if (bHasRightStick && RightStick.ControllerId == Device.ControllerId)
+	{
+		RightStick.Seconds = Seconds;
+	}
+
+	Device.DirtyAbs = 0;
+	Device.DirtyButtons = 0;
+}
+
+void FEvdevReader::QueueEvent(FEvdevInputEvent::EType Type, FName Key, int32 ControllerId, float Value, double Seconds)
+{
+	if (Queue.Num() >= EvdevReader::MaxQueuedEvents)
+	{
+		// nobody is sending the events on, e.g. no viewport
+		Queue.RemoveAt(0, Queue.Num() - EvdevReader::MaxQueuedEvents + 1, false);
+	}
+
+	FEvdevInputEvent& Event = Queue[Queue.AddUninitialized()];
+	Event.Type = Type;
+	Event.Key = Key;
+	Event.ControllerId = ControllerId;
+	Event.Value = Value;
+	Event.Seconds = Seconds;
+}
+
+float FEvdevReader::GetAxisValue(const FDevice& Device, int32 Code, bool bTrigger)
+{
+	const float Min = Device.AbsMin[Code];
+	const float Max = Device.AbsMax[Code];
+	if (Max <= Min)
+	{
+		return 0.f;
+	}
+
+	const float Value = Device.AbsValue[Code];
+	if (bTrigger)
+	{
+		return FMath::Clamp((Value - Min) / (Max - Min), 0.f, 1.f);
+	}
+	return FMath::Clamp((2.f * Value - Min - Max) / (Max - Min), -1.f, 1.f);
+}
+
+void FEvdevReader::DequeueEvents(TArray<FEvdevInputEvent>& OutEvents)
+{
+	// the queue keeps going in OutEvents' old allocation
+	OutEvents.Reset();
+	FScopeLock ScopeLock(&Lock);
+	Swap(OutEvents, Queue);
+}
+
+bool FEvdevReader::GetRightStick(FEvdevStickState& OutState) const
+{
+	FScopeLock ScopeLock(&Lock);
+	OutState = RightStick;
+	return bHasRightStick;
+}
+
+int32 FEvdevReader::GetNumGamepads() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumGamepads;
+}
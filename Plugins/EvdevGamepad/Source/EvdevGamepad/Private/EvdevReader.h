@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "IEvdevGamepadModule.h"
+
+#include <linux/input.h>
+
+class FRunnableThread;
+
+/** A gamepad event waiting to be sent to the game */
+struct FEvdevInputEvent
+{
+	enum class EType : uint8
+	{
+		Analog,
+		Pressed,
+		Released
+	};
+
+	EType Type;
+	FName Key;
+	int32 ControllerId;
+	float Value;
+
+	/** Kernel timestamp, in FPlatformTime::Seconds() */
+	double Seconds;
+};
+
+/**
+ * Watches /dev/input for gamepads and reads them with epoll on its own thread. Everything a
+ * device reports between two SYN_REPORTs is translated into engine gamepad keys at once and
+ * queued for the game thread.
+ */
+class FEvdevReader : public FRunnable
+{
+public:
+	FEvdevReader();
+	virtual ~FEvdevReader();
+
+	/** Opens the gamepads that are already connected and starts the thread */
+	bool Start();
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End of FRunnable interface
+
+	/** Moves the queued events to OutEvents, oldest first */
+	void DequeueEvents(TArray<FEvdevInputEvent>& OutEvents);
+
+	bool GetRightStick(FEvdevStickState& OutState) const;
+
+	int32 GetNumGamepads() const;
+
+private:
+	struct FDevice
+	{
+		FDevice()
+			: ControllerId(0)
+			, DirtyAbs(0)
+			, DirtyButtons(0)
+			, Buttons(0)
+			, HatDirections(0)
+			, bDropped(false)
+		{
+			FMemory::Memzero(AbsMin);
+			FMemory::Memzero(AbsMax);
+			FMemory::Memzero(AbsValue);
+		}
+
+		FString Path;
+		int32 ControllerId;
+
+		/** Range and last value of every absolute axis */
+		int32 AbsMin[ABS_CNT];
+		int32 AbsMax[ABS_CNT];
+		int32 AbsValue[ABS_CNT];
+
+		/** Axes and buttons that changed since the last report */
+		uint64 DirtyAbs;
+		uint32 DirtyButtons;
+
+		/** Pressed state of every button mapping and hat direction */
+		uint32 Buttons;
+		uint32 HatDirections;
+
+		/** Events were lost, everything is read back from the device after the next report */
+		bool bDropped;
+	};
+
+	/** Opens the node if it is a gamepad we don't have yet */
+	void OpenDevice(const FString& Path);
+	void CloseDevice(int32 Fd);
+
+	void ReadHotplug();
+	void ReadDevice(int32 Fd);
+	void HandleEvent(int32 Fd, FDevice& Device, const input_event& Event, double ClockOffset);
+
+	/** Reads the current state back after the kernel dropped events */
+	void Resync(int32 Fd, FDevice& Device);
+
+	/** Queues everything that changed since the last report */
+	void Commit(FDevice& Device, double Seconds);
+
+	void QueueEvent(FEvdevInputEvent::EType Type, FName Key, int32 ControllerId, float Value, double Seconds);
+
+	/** Normalized value of one of the mapped axes */
+	static float GetAxisValue(const FDevice& Device, int32 Code, bool bTrigger);
+
+	int32 EpollFd;
+	int32 InotifyFd;
+	int32 WakeFd;
+
+	/** Open gamepads by file descriptor, only touched by the reader thread */
+	TMap<int32, FDevice> Devices;
+
+	FRunnableThread* Thread;
+	FThreadSafeBool bStopping;
+
+	/** Guards everything below, shared with the game thread */
+	mutable FCriticalSection Lock;
+	TArray<FEvdevInputEvent> Queue;
+	FEvdevStickState RightStick;
+	bool bHasRightStick;
+	int32 NumGamepads;
+};
@@ -0,0 +1,282 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EvdevVirtualGamepad.h"
+#include "IEvdevGamepadModule.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CString.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+DEFINE_LOG_CATEGORY_STATIC(LogEvdevVirtualGamepad, Log, All);
+
+namespace EvdevVirtualGamepad
+{
+	static const int32 AxisRange = 32767;
+
+	/** What the reader needs to see to take the device for a gamepad */
+	static const uint16 Buttons[] = { BTN_SOUTH, BTN_EAST, BTN_WEST, BTN_NORTH, BTN_TL, BTN_TR, BTN_SELECT, BTN_START };
+	static const uint16 Axes[] = { ABS_X, ABS_Y, ABS_RX, ABS_RY };
+}
+
+FEvdevVirtualGamepad::FEvdevVirtualGamepad()
+	: Fd(-1)
+{
+}
+
+FEvdevVirtualGamepad::~FEvdevVirtualGamepad()
+{
+	Destroy();
+}
+
+bool FEvdevVirtualGamepad::Create()
+{
+	if (IsCreated())
+	{
+		return true;
+	}
+
+	Fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+	if (Fd < 0)
+	{
+		UE_LOG(LogEvdevVirtualGamepad, Error, TEXT("Can't open /dev/uinput (errno %d)"), errno);
+		return false;
+	}
+
+	ioctl(Fd, UI_SET_EVBIT, EV_SYN);
+	ioctl(Fd, UI_SET_EVBIT, EV_KEY);
+	ioctl(Fd, UI_SET_EVBIT, EV_ABS);
+	for (uint16 Button : EvdevVirtualGamepad::Buttons)
+	{
+		ioctl(Fd, UI_SET_KEYBIT, Button);
+	}
+
+	// the legacy setup, it works on every kernel that has uinput
+	uinput_user_dev Setup = {};
+	FCStringAnsi::Strncpy(Setup.name, "EvdevGamepad virtual pad", UINPUT_MAX_NAME_SIZE);
+	Setup.id.bustype = BUS_VIRTUAL;
+	Setup.id.vendor = 0x1234;
+	Setup.id.product = 0x5678;
+	Setup.id.version = 1;
+	for (uint16 Axis : EvdevVirtualGamepad::Axes)
+	{
+		ioctl(Fd, UI_SET_ABSBIT, Axis);
+		Setup.absmin[Axis] = -EvdevVirtualGamepad::AxisRange;
+		Setup.absmax[Axis] = EvdevVirtualGamepad::AxisRange;
+	}
+
+	if (write(Fd, &Setup, sizeof(Setup)) != sizeof(Setup) || ioctl(Fd, UI_DEV_CREATE) < 0)
+	{
+		UE_LOG(LogEvdevVirtualGamepad, Error, TEXT("Failed to create the virtual pad (errno %d)"), errno);
+		close(Fd);
+		Fd = -1;
+		return false;
+	}
+
+	UE_LOG(LogEvdevVirtualGamepad, Display, TEXT("Virtual pad created"));
+	return true;
+}
+
+void FEvdevVirtualGamepad::Destroy()
+{
+	if (!IsCreated())
+	{
+		return;
+	}
+
+	ioctl(Fd, UI_DEV_DESTROY);
+	close(Fd);
+	Fd = -1;
+
+	UE_LOG(LogEvdevVirtualGamepad, Display, TEXT("Virtual pad destroyed"));
+}
+
+void FEvdevVirtualGamepad::SetRightStick(float X, float Y)
+{
+	if (!IsCreated())
+	{
+		return;
+	}
+
+	Emit(EV_ABS, ABS_RX, FMath::RoundToInt(FMath::Clamp(X, -1.f, 1.f) * EvdevVirtualGamepad::AxisRange));
+	Emit(EV_ABS, ABS_RY, FMath::RoundToInt(-FMath::Clamp(Y, -1.f, 1.f) * EvdevVirtualGamepad::AxisRange));
+	Emit(EV_SYN, SYN_REPORT, 0);
+}
+
+void FEvdevVirtualGamepad::Emit(uint16 Type, uint16 Code, int32 Value)
+{
+	// the kernel stamps the event when it's written
+	input_event Event = {};
+	Event.type = Type;
+	Event.code = Code;
+	Event.value = Value;
+	if (write(Fd, &Event, sizeof(Event)) != sizeof(Event))
+	{
+		UE_LOG(LogEvdevVirtualGamepad, Warning, TEXT("Failed to write to the virtual pad (errno %d)"), errno);
+	}
+}
+
+namespace EvdevVirtualGamepad
+{
+	/** Not a static object, destroying it would log during static destruction */
+	static FEvdevVirtualGamepad* ConsolePad = nullptr;
+
+	/** Polls Condition for up to Seconds, the reader fills in its state on its own thread */
+	template <typename ConditionType>
+	static bool WaitFor(ConditionType Condition, double Seconds = 2.0)
+	{
+		const double EndSeconds = FPlatformTime::Seconds() + Seconds;
+		while (!Condition())
+		{
+			if (FPlatformTime::Seconds() > EndSeconds)
+			{
+				return false;
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return true;
+	}
+
+	static void RunVirtualPadCommand(const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0 || Args[0] == TEXT("Create"))
+		{
+			if (ConsolePad == nullptr)
+			{
+				ConsolePad = new FEvdevVirtualGamepad();
+			}
+			ConsolePad->Create();
+		}
+		else if (Args[0] == TEXT("Destroy"))
+		{
+			delete ConsolePad;
+			ConsolePad = nullptr;
+		}
+		else if (Args[0] == TEXT("RightStick") && Args.Num() >= 3 && ConsolePad != nullptr)
+		{
+			ConsolePad->SetRightStick(FCString::Atof(*Args[1]), FCString::Atof(*Args[2]));
+		}
+		else
+		{
+			UE_LOG(LogEvdevVirtualGamepad, Warning, TEXT("Usage: EvdevGamepad.VirtualPad Create|Destroy|RightStick X Y, RightStick needs a pad"));
+		}
+	}
+
+	/** Drives a virtual pad through the reader and checks values and kernel timestamps on the way out */
+	static void RunSelfTest(TArray<FString>& OutErrors)
+	{
+		if (!IEvdevGamepadModule::IsAvailable())
+		{
+			OutErrors.Add(TEXT("The EvdevGamepad module isn't loaded"));
+			return;
+		}
+
+		IEvdevGamepadModule& Module = IEvdevGamepadModule::Get();
+		const int32 NumGamepads = Module.GetNumGamepads();
+
+		FEvdevVirtualGamepad Pad;
+		if (!Pad.Create())
+		{
+			OutErrors.Add(TEXT("Can't create a virtual pad, /dev/uinput needs to be writable"));
+			return;
+		}
+		if (!WaitFor([&Module, NumGamepads]() { return Module.GetNumGamepads() > NumGamepads; }))
+		{
+			OutErrors.Add(TEXT("The reader never opened the virtual pad"));
+			return;
+		}
+
+		// every step moves both axes, the kernel drops events that don't change anything
+		const FVector2D Steps[] = { FVector2D(0.5f, -0.25f), FVector2D(-1.f, 1.f), FVector2D(0.f, 0.75f) };
+		const float Tolerance = 2.f / AxisRange;
+
+		for (const FVector2D& Stick : Steps)
+		{
+			const double WriteSeconds = FPlatformTime::Seconds();
+			Pad.SetRightStick(Stick.X, Stick.Y);
+
+			FEvdevStickState State;
+			const bool bArrived = WaitFor([&Module, &State, &Stick, Tolerance]()
+			{
+				return Module.GetRightStick(State) && FMath::IsNearlyEqual(State.X, Stick.X, Tolerance) && FMath::IsNearlyEqual(State.Y, Stick.Y, Tolerance);
+			});
+			const double ReadSeconds = FPlatformTime::Seconds();
+
+			if (!bArrived)
+			{
+				OutErrors.Add(FString::Printf(TEXT("Wrote (%.3f, %.3f), the reader has (%.3f, %.3f)"), Stick.X, Stick.Y, State.X, State.Y));
+			}
+			// allow for the clock offset being measured a little after the event
+			else if (State.Seconds < WriteSeconds - 0.001 || State.Seconds > ReadSeconds + 0.001)
+			{
+				OutErrors.Add(FString::Printf(TEXT("Timestamp %.6f is outside the write at %.6f and the read at %.6f"), State.Seconds, WriteSeconds, ReadSeconds));
+			}
+			else
+			{
+				UE_LOG(LogEvdevVirtualGamepad, Display, TEXT("(%.3f, %.3f) arrived %.3f ms after the kernel stamped it"), Stick.X, Stick.Y, (ReadSeconds - State.Seconds) * 1000.0);
+			}
+		}
+
+		Pad.Destroy();
+		if (!WaitFor([&Module, NumGamepads]() { return Module.GetNumGamepads() == NumGamepads; }))
+		{
+			OutErrors.Add(TEXT("The reader never closed the virtual pad"));
+		}
+	}
+
+	static void RunSelfTestCommand(const TArray<FString>& Args)
+	{
+		TArray<FString> Errors;
+		RunSelfTest(Errors);
+
+		for (const FString& Error : Errors)
+		{
+			UE_LOG(LogEvdevVirtualGamepad, Error, TEXT("%s"), *Error);
+		}
+		if (Errors.Num() == 0)
+		{
+			UE_LOG(LogEvdevVirtualGamepad, Display, TEXT("Evdev self test passed"));
+		}
+		else
+		{
+			UE_LOG(LogEvdevVirtualGamepad, Error, TEXT("Evdev self test FAILED"));
+		}
+
+		if (Args.Contains(TEXT("Quit")))
+		{
+			FPlatformMisc::RequestExitWithStatus(false, Errors.Num() == 0 ? 0 : 1);
+		}
+	}
+
+	static FAutoConsoleCommand VirtualPadCommand(
+		TEXT("EvdevGamepad.VirtualPad"),
+		TEXT("Creates a uinput gamepad the evdev reader picks up like a real one. Usage: EvdevGamepad.VirtualPad Create|Destroy|RightStick X Y"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunVirtualPadCommand));
+
+	static FAutoConsoleCommand SelfTestCommand(
+		TEXT("EvdevGamepad.SelfTest"),
+		TEXT("Drives a uinput gamepad through the evdev reader and checks stick values and kernel timestamps. Usage: EvdevGamepad.SelfTest [Quit], Quit exits with 1 on failure"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunSelfTestCommand));
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEvdevGamepadSelfTest, "EvdevGamepad.SelfTest", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEvdevGamepadSelfTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Errors;
+	EvdevVirtualGamepad::RunSelfTest(Errors);
+	for (const FString& Error : Errors)
+	{
+		AddError(Error);
+	}
+	return Errors.Num() == 0;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A gamepad made up through /dev/uinput. The kernel treats it like a real one, so the reader
+ * picks it up and everything from epoll to the game can be driven without hardware:
+ *
+ *	EvdevGamepad.VirtualPad Create|Destroy|RightStick X Y
+ *	EvdevGamepad.SelfTest [Quit]
+ *
+ * The self test is also the EvdevGamepad.SelfTest automation test.
+ */
+class FEvdevVirtualGamepad
+{
+public:
+	FEvdevVirtualGamepad();
+	~FEvdevVirtualGamepad();
+
+	/** @returns false if /dev/uinput can't be opened, usually for lack of permissions */
+	bool Create();
+	void Destroy();
+	bool IsCreated() const { return Fd >= 0; }
+
+	/** Deflects the right stick, right and up positive in [-1, 1] like the engine's axes */
+	void SetRightStick(float X, float Y);
+
+private:
+	void Emit(uint16 Type, uint16 Code, int32 Value);
+
+	int32 Fd;
+};
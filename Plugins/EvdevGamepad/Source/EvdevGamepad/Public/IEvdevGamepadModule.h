@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IInputDeviceModule.h"
+#include "Modules/ModuleManager.h"
+
+/** Right stick of the gamepad that last moved it */
+struct FEvdevStickState
+{
+	/** Deflection in [-1, 1], right and up positive like the engine's gamepad axes */
+	float X = 0.f;
+	float Y = 0.f;
+
+	/**
+	 * Kernel timestamp of the device's latest report, in FPlatformTime::Seconds(). The stick is
+	 * current as of this time, the pad reports again as soon as anything changes.
+	 */
+	double Seconds = 0.0;
+
+	int32 ControllerId = INDEX_NONE;
+};
+
+/**
+ * Gamepads read from /dev/input/event* on a dedicated thread, bypassing the platform's generic
+ * joystick layer. The events are sent to the game as regular gamepad keys, so the project's
+ * axis mappings apply unchanged, and the kernel event timestamps are kept for the look pipeline.
+ */
+class IEvdevGamepadModule : public IInputDeviceModule
+{
+public:
+	static inline IEvdevGamepadModule& Get()
+	{
+		return FModuleManager::LoadModuleChecked<IEvdevGamepadModule>("EvdevGamepad");
+	}
+
+	static inline bool IsAvailable()
+	{
+		return FModuleManager::Get().IsModuleLoaded("EvdevGamepad");
+	}
+
+	/** @returns false until a gamepad has reported its right stick */
+	virtual bool GetRightStick(FEvdevStickState& OutState) const = 0;
+
+	/** Gamepads currently open */
+	virtual int32 GetNumGamepads() const = 0;
+};
@@ -0,0 +1,538 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AimBot.h"
+#include "AimResponseCurve.h"
+#include "HoffmannMehatBenchmark.h"
+#include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatGameMode.h"
+#include "SpawnVolume.h"
+#include "Async/ParallelFor.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/BoxComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimBot, Log, All);
+
+namespace AimBot
+{
+	/** Time between the live driver's shots at a target it has settled on (s) */
+	static const float RefireSeconds = 0.25f;
+}
+
+FAimMotorModel::FAimMotorModel(const FAimMotorSettings& InSettings, int32 Seed)
+	: Settings(InSettings)
+	, Random(Seed)
+	, HistoryStart(0)
+	, Integral(FVector2D::ZeroVector)
+	, LastPerceived(FVector2D::ZeroVector)
+	, bHasPerceived(false)
+{
+}
+
+FVector2D FAimMotorModel::Update(float Time, float DeltaTime, const FVector2D& Error)
+{
+	History.Emplace(Time, Error);
+
+	// the newest error old enough to have been noticed
+	const float SeenTime = Time - Settings.ReactionDelay;
+	while (HistoryStart + 1 < History.Num() && History[HistoryStart + 1].Key <= SeenTime)
+	{
+		++HistoryStart;
+	}
+	if (History[HistoryStart].Key > SeenTime)
+	{
+		// still reacting
+		return FVector2D::ZeroVector;
+	}
+
+	const FVector2D Perceived = History[HistoryStart].Value;
+	if (HistoryStart > 1024)
+	{
+		History.RemoveAt(0, HistoryStart, false);
+		HistoryStart = 0;
+	}
+
+	const FVector2D Derivative = (bHasPerceived && DeltaTime > 0.f) ? (Perceived - LastPerceived) / DeltaTime : FVector2D::ZeroVector;
+	Integral += Perceived * DeltaTime;
+	LastPerceived = Perceived;
+	bHasPerceived = true;
+
+	FVector2D Stick = Perceived * Settings.Kp + Integral * Settings.Ki + Derivative * Settings.Kd;
+
+	// signal dependent noise, bigger movements are less precise
+	auto Gaussian = [this]()
+	{
+		const float U1 = FMath::Max(Random.GetFraction(), KINDA_SMALL_NUMBER);
+		const float U2 = Random.GetFraction();
+		return FMath::Sqrt(-2.f * FMath::Loge(U1)) * FMath::Cos(2.f * PI * U2);
+	};
+	Stick.X += Gaussian() * (Settings.NoiseBase + Settings.NoiseGain * FMath::Abs(Stick.X));
+	Stick.Y += Gaussian() * (Settings.NoiseBase + Settings.NoiseGain * FMath::Abs(Stick.Y));
+
+	return FVector2D(FMath::Clamp(Stick.X, -1.f, 1.f), FMath::Clamp(Stick.Y, -1.f, 1.f));
+}
+
+FAimBotTrialSettings FAimBotTrialSettings::FromCharacter(const AHoffmannMehatCharacter* Character)
+{
+	const AHoffmannMehatCharacter* LookSource = Character ? Character : GetDefault<AHoffmannMehatCharacter>();
+	const APlayerController* Controller = Character ? Cast<APlayerController>(Character->GetController()) : nullptr;
+	if (Controller == nullptr)
+	{
+		Controller = GetDefault<APlayerController>();
+	}
+
+	FAimBotTrialSettings Settings;
+	Settings.DeadZone = LookSource->DeadZone;
+	Settings.BaseTurnRate = LookSource->BaseTurnRate;
+	Settings.BaseLookUpRate = LookSource->BaseLookUpRate;
+	Settings.bFixedStepAim = LookSource->bFixedStepAim;
+	Settings.AimStepRate = LookSource->AimStepRate;
+	Settings.MaxAimSubsteps = LookSource->MaxAimSubsteps;
+	Settings.InputYawScale = Controller->InputYawScale;
+	Settings.InputPitchScale = Controller->InputPitchScale;
+	return Settings;
+}
+
+FAimBotTrialResult AimBot::RunTrial(const FAimResponseProfile& Profile, const FAimMotorSettings& Motor, const FAimBotTrialSettings& Settings, const FVector2D& InitialError, float TargetAngularRadius, int32 Seed)
+{
+	FAimBotTrialResult Result;
+	FAimMotorModel Model(Motor, Seed);
+
+	const float InitialDistance = InitialError.Size();
+	const FVector2D InitialDirection = InitialDistance > KINDA_SMALL_NUMBER ? InitialError / InitialDistance : FVector2D(1.f, 0.f);
+
+	// what TurnAtRate and LookUpAtRate do with a stick, with the profile as both curves
+	auto Curve = [&Profile](float Stick, float DeadZone) { return Profile.EvaluateStick(Stick, DeadZone); };
+	FFixedStepAimAxis TurnAxis;
+	FFixedStepAimAxis LookUpAxis;
+	auto CalcInput = [&](FFixedStepAimAxis& Axis, float Stick, float BaseRate, int32 Frame)
+	{
+		const float DegreesPerSecond = BaseRate * Settings.Sensitivity;
+		if (Settings.bFixedStepAim)
+		{
+			return Axis.Advance(Curve, Stick, Settings.DeadZone, DegreesPerSecond, Settings.FrameSeconds, 1.f / Settings.AimStepRate, Settings.MaxAimSubsteps, Frame);
+		}
+		return Curve(Stick, Settings.DeadZone) * DegreesPerSecond * Settings.FrameSeconds;
+	};
+
+	FVector2D Aim = FVector2D::ZeroVector;
+	float OnTargetSince = -1.f;
+	const int32 NumFrames = FMath::CeilToInt(Settings.MaxSeconds / Settings.FrameSeconds);
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const float Time = Frame * Settings.FrameSeconds;
+		const FVector2D Error = InitialError - Aim;
+
+		if (Error.Size() <= TargetAngularRadius)
+		{
+			if (!Result.bAcquired)
+			{
+				Result.bAcquired = true;
+				Result.TimeToTarget = Time;
+			}
+			if (OnTargetSince < 0.f)
+			{
+				OnTargetSince = Time;
+			}
+			if (Time - OnTargetSince >= Settings.HoldSeconds)
+			{
+				Result.bSettled = true;
+				Result.SettleTime = OnTargetSince;
+				break;
+			}
+		}
+		else
+		{
+			OnTargetSince = -1.f;
+		}
+
+		// past the target is a negative error along the way we started
+		Result.Overshoot = FMath::Max(Result.Overshoot, -FVector2D::DotProduct(Error, InitialDirection));
+
+		// the stick the live driver overrides with, then the controller scales the character's input
+		const FVector2D Stick = Model.Update(Time, Settings.FrameSeconds, Error);
+		Aim.X += CalcInput(TurnAxis, Stick.X * FMath::Sign(Settings.InputYawScale), Settings.BaseTurnRate, Frame) * Settings.InputYawScale;
+		Aim.Y += CalcInput(LookUpAxis, Stick.Y * FMath::Sign(Settings.InputPitchScale), Settings.BaseLookUpRate, Frame) * Settings.InputPitchScale;
+	}
+
+	return Result;
+}
+
+FAimBotDriver::FAimBotDriver(UWorld* InWorld, const FAimMotorSettings& InMotor, float InSeconds)
+	: World(InWorld)
+	, Motor(InMotor, 0)
+	, Seconds(InSeconds)
+	, Time(0.f)
+	, TargetStartTime(0.f)
+	, OnTargetTime(-1.f)
+	, LastShotTime(-1.f)
+	, bShotAtTarget(false)
+	, NumShots(0)
+	, NumKills(0)
+	, bFinished(false)
+{
+	APlayerController* Controller = InWorld ? InWorld->GetFirstPlayerController() : nullptr;
+	Character = Controller ? Cast<AHoffmannMehatCharacter>(Controller->GetPawn()) : nullptr;
+}
+
+TStatId FAimBotDriver::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FAimBotDriver, STATGROUP_Tickables);
+}
+
+void FAimBotDriver::Stop()
+{
+	if (bFinished)
+	{
+		return;
+	}
+	bFinished = true;
+
+	if (AHoffmannMehatCharacter* Pawn = Character.Get())
+	{
+		Pawn->ClearLookInputOverride();
+	}
+
+	float Sum = 0.f;
+	for (float TimeToTarget : TimesToTarget)
+	{
+		Sum += TimeToTarget;
+	}
+	UE_LOG(LogAimBot, Display, TEXT("Aim bot acquired %d targets, %.3f s to target on average, killed %d with %d shots"), TimesToTarget.Num(), TimesToTarget.Num() ? Sum / TimesToTarget.Num() : 0.f, NumKills, NumShots);
+}
+
+AActor* FAimBotDriver::FindTarget(const FVector& CameraLocation, const FRotator& CameraRotation)
+{
+	UWorld* CurrentWorld = World.Get();
+	const AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(CurrentWorld->GetAuthGameMode());
+	if (GameMode == nullptr)
+	{
+		return nullptr;
+	}
+
+	// stay on the current target until it's gone
+	if (Target.IsValid() && GameMode->GetLiveTargets().Contains(Target.Get()))
+	{
+		return Target.Get();
+	}
+
+	const FVector Forward = CameraRotation.Vector();
+	AActor* ClosestTarget = nullptr;
+	float ClosestDot = -2.f;
+	for (AActor* LiveTarget : GameMode->GetLiveTargets())
+	{
+		const float Dot = FVector::DotProduct(Forward, (LiveTarget->GetActorLocation() - CameraLocation).GetSafeNormal());
+		if (Dot > ClosestDot)
+		{
+			ClosestDot = Dot;
+			ClosestTarget = LiveTarget;
+		}
+	}
+
+	if (ClosestTarget == nullptr)
+	{
+		TActorIterator<ASpawnVolume> SpawnVolumeIt(CurrentWorld);
+		if (SpawnVolumeIt)
+		{
+			SpawnVolumeIt->SpawnPickup();
+		}
+	}
+	return ClosestTarget;
+}
+
+void FAimBotDriver::Tick(float DeltaTime)
+{
+	AHoffmannMehatCharacter* Pawn = Character.Get();
+	if (Pawn == nullptr || !World.IsValid() || Time >= Seconds)
+	{
+		Stop();
+		return;
+	}
+	Time += DeltaTime;
+
+	const APlayerController* Controller = Cast<APlayerController>(Pawn->GetController());
+	if (Controller == nullptr || Controller->PlayerCameraManager == nullptr)
+	{
+		return;
+	}
+
+	const FVector CameraLocation = Controller->PlayerCameraManager->GetCameraLocation();
+	const FRotator CameraRotation = Controller->PlayerCameraManager->GetCameraRotation();
+
+	AActor* NewTarget = FindTarget(CameraLocation, CameraRotation);
+	if (NewTarget != Target.Get())
+	{
+		// the old target left play, the shots decided whether that was a kill
+		NumKills += bShotAtTarget ? 1 : 0;
+		bShotAtTarget = false;
+		Target = NewTarget;
+		TargetStartTime = Time;
+		OnTargetTime = -1.f;
+	}
+
+	if (NewTarget == nullptr)
+	{
+		Pawn->SetLookInputOverride(FVector2D::ZeroVector);
+		return;
+	}
+
+	const FVector ToTarget = NewTarget->GetActorLocation() - CameraLocation;
+	const FRotator Error = (ToTarget.Rotation() - CameraRotation).GetNormalized();
+	const FVector2D AimError(Error.Yaw, Error.Pitch);
+	const float AngularRadius = FMath::RadiansToDegrees(FMath::Atan2(NewTarget->GetSimpleCollisionRadius(), ToTarget.Size()));
+
+	if (AimError.Size() <= AngularRadius)
+	{
+		if (OnTargetTime < 0.f)
+		{
+			OnTargetTime = Time;
+			TimesToTarget.Add(Time - TargetStartTime);
+		}
+		else if (Time - OnTargetTime >= FAimBotTrialSettings().HoldSeconds && (LastShotTime < 0.f || Time - LastShotTime >= AimBot::RefireSeconds))
+		{
+			// settled, shoot until the target goes, the next one is picked once it has
+			Pawn->OnFire();
+			LastShotTime = Time;
+			bShotAtTarget = true;
+			++NumShots;
+		}
+	}
+	else
+	{
+		OnTargetTime = -1.f;
+	}
+
+	// the controller's input scales decide which way a positive stick turns
+	const FVector2D Stick = Motor.Update(Time, DeltaTime, AimError);
+	Pawn->SetLookInputOverride(FVector2D(Stick.X * FMath::Sign(Controller->InputYawScale), Stick.Y * FMath::Sign(Controller->InputPitchScale)));
+}
+
+namespace AimBot
+{
+	static const float DefaultTargetRadius = 50.f;
+
+	/** Initial aim errors and target sizes, from the world's spawn volumes as seen by the player */
+	static void MakeScenarios(UWorld* World, int32 NumTrials, int32 Seed, TArray<FVector2D>& OutErrors, TArray<float>& OutRadii)
+	{
+		FVector CameraLocation = FVector::ZeroVector;
+		FRotator CameraRotation = FRotator::ZeroRotator;
+		const APlayerController* Controller = World ? World->GetFirstPlayerController() : nullptr;
+		if (Controller != nullptr && Controller->PlayerCameraManager != nullptr)
+		{
+			CameraLocation = Controller->PlayerCameraManager->GetCameraLocation();
+			CameraRotation = Controller->PlayerCameraManager->GetCameraRotation();
+		}
+
+		TArray<FBox> SpawnBoxes;
+		if (World != nullptr)
+		{
+			for (TActorIterator<ASpawnVolume> It(World); It; ++It)
+			{
+				const FBoxSphereBounds& Bounds = It->GetWhereToSpawn()->Bounds;
+				SpawnBoxes.Add(FBox(Bounds.Origin - Bounds.BoxExtent, Bounds.Origin + Bounds.BoxExtent));
+			}
+		}
+		if (SpawnBoxes.Num() == 0)
+		{
+			// no map to go by, use a wall of targets in front of the player
+			const FVector Center = CameraLocation + CameraRotation.Vector() * 2000.f;
+			SpawnBoxes.Add(FBox(Center - FVector(200.f, 1500.f, 600.f), Center + FVector(200.f, 1500.f, 600.f)));
+		}
+
+		FRandomStream Random(Seed);
+		OutErrors.Reset(NumTrials);
+		OutRadii.Reset(NumTrials);
+		for (int32 Trial = 0; Trial < NumTrials; ++Trial)
+		{
+			const FBox& Box = SpawnBoxes[Random.RandHelper(SpawnBoxes.Num())];
+			const FVector Location(Random.FRandRange(Box.Min.X, Box.Max.X), Random.FRandRange(Box.Min.Y, Box.Max.Y), Random.FRandRange(Box.Min.Z, Box.Max.Z));
+			const FVector ToTarget = Location - CameraLocation;
+			const FRotator Error = (ToTarget.Rotation() - CameraRotation).GetNormalized();
+			OutErrors.Add(FVector2D(Error.Yaw, Error.Pitch));
+			OutRadii.Add(FMath::RadiansToDegrees(FMath::Atan2(DefaultTargetRadius, FMath::Max(ToTarget.Size(), 1.f))));
+		}
+	}
+
+	/** Runs every trial for one curve and sensitivity across all cores, adding the ones that never settled to OutNumUnsettled */
+	static TSharedRef<FJsonObject> RunTrials(const FAimResponseProfile& Profile, const FAimBotTrialSettings& LookSettings, float Sensitivity, const FAimMotorSettings& Motor, const TArray<FVector2D>& Errors, const TArray<float>& Radii, int32 Seed, int32& OutNumUnsettled)
+	{
+		FAimBotTrialSettings Settings = LookSettings;
+		Settings.Sensitivity = Sensitivity;
+
+		TArray<FAimBotTrialResult> Results;
+		Results.SetNum(Errors.Num());
+		ParallelFor(Errors.Num(), [&](int32 Trial)
+		{
+			Results[Trial] = RunTrial(Profile, Motor, Settings, Errors[Trial], Radii[Trial], Seed + Trial);
+		});
+
+		TArray<float> TimesToTarget, SettleTimes, Overshoots;
+		for (const FAimBotTrialResult& Result : Results)
+		{
+			if (Result.bAcquired)
+			{
+				TimesToTarget.Add(Result.TimeToTarget);
+				Overshoots.Add(Result.Overshoot);
+			}
+			if (Result.bSettled)
+			{
+				SettleTimes.Add(Result.SettleTime);
+			}
+		}
+
+		UE_LOG(LogAimBot, Display, TEXT("%s x%.2f: %d/%d settled"), *Profile.Name.ToString(), Sensitivity, SettleTimes.Num(), Results.Num());
+		OutNumUnsettled += Results.Num() - SettleTimes.Num();
+
+		TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+		Summary->SetNumberField(TEXT("trials"), Results.Num());
+		Summary->SetNumberField(TEXT("acquired"), TimesToTarget.Num());
+		Summary->SetNumberField(TEXT("settled"), SettleTimes.Num());
+		Summary->SetObjectField(TEXT("time_to_target_s"), FHoffmannMehatBenchmark::MakeDistribution(TimesToTarget));
+		Summary->SetObjectField(TEXT("settle_time_s"), FHoffmannMehatBenchmark::MakeDistribution(SettleTimes));
+		Summary->SetObjectField(TEXT("overshoot_deg"), FHoffmannMehatBenchmark::MakeDistribution(Overshoots));
+		return Summary;
+	}
+
+	static void RunHeadless(UWorld* World, const FString& Params, bool bQuit)
+	{
+		int32 NumTrials = 2000;
+		int32 Seed = 1;
+		FString SensitivityList = TEXT("0.5,1,2");
+		FString ProfileList;
+		FParse::Value(*Params, TEXT("Trials="), NumTrials);
+		FParse::Value(*Params, TEXT("Seed="), Seed);
+		FParse::Value(*Params, TEXT("Sensitivity="), SensitivityList);
+		FParse::Value(*Params, TEXT("Profiles="), ProfileList);
+
+		// with Quit, an unknown profile, a trial that never settled or unwritten results exit with status 1
+		bool bFailed = false;
+
+		TArray<const FAimResponseProfile*> Profiles;
+		if (ProfileList.IsEmpty())
+		{
+			for (const FAimResponseProfile& Profile : FAimResponseProfile::GetBuiltInProfiles())
+			{
+				Profiles.Add(&Profile);
+			}
+		}
+		else
+		{
+			TArray<FString> Names;
+			ProfileList.ParseIntoArray(Names, TEXT(","));
+			for (const FString& Name : Names)
+			{
+				if (const FAimResponseProfile* Profile = FAimResponseProfile::FindBuiltInProfile(*Name))
+				{
+					Profiles.Add(Profile);
+				}
+				else
+				{
+					UE_LOG(LogAimBot, Error, TEXT("Unknown curve profile %s"), *Name);
+					bFailed = true;
+				}
+			}
+		}
+
+		TArray<FString> Sensitivities;
+		SensitivityList.ParseIntoArray(Sensitivities, TEXT(","));
+
+		TArray<FVector2D> Errors;
+		TArray<float> Radii;
+		MakeScenarios(World, FMath::Max(NumTrials, 1), Seed, Errors, Radii);
+
+		const FAimMotorSettings Motor;
+		const APlayerController* Controller = World ? World->GetFirstPlayerController() : nullptr;
+		const FAimBotTrialSettings LookSettings = FAimBotTrialSettings::FromCharacter(Controller ? Cast<AHoffmannMehatCharacter>(Controller->GetPawn()) : nullptr);
+		const double StartSeconds = FPlatformTime::Seconds();
+		int32 NumUnsettled = 0;
+
+		TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+		for (const FAimResponseProfile* Profile : Profiles)
+		{
+			TSharedRef<FJsonObject> ProfileResults = MakeShared<FJsonObject>();
+			for (const FString& Sensitivity : Sensitivities)
+			{
+				ProfileResults->SetObjectField(Sensitivity, RunTrials(*Profile, LookSettings, FCString::Atof(*Sensitivity), Motor, Errors, Radii, Seed, NumUnsettled));
+			}
+			Results->SetObjectField(Profile->Name.ToString(), ProfileResults);
+		}
+
+		FString Json;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Results, Writer);
+
+		const FString Path = FPaths::ProjectSavedDir() / TEXT("AimBot") / FString::Printf(TEXT("AimBot-%s.json"), *FDateTime::Now().ToString());
+		if (FFileHelper::SaveStringToFile(Json, *Path))
+		{
+			UE_LOG(LogAimBot, Display, TEXT("%d trials per curve written to %s in %.2f s"), Errors.Num(), *Path, FPlatformTime::Seconds() - StartSeconds);
+		}
+		else
+		{
+			UE_LOG(LogAimBot, Error, TEXT("Failed to write %s"), *Path);
+			bFailed = true;
+		}
+
+		if (NumUnsettled > 0)
+		{
+			UE_LOG(LogAimBot, Error, TEXT("%d trials never settled on their target"), NumUnsettled);
+			bFailed = true;
+		}
+
+		if (bQuit)
+		{
+			FPlatformMisc::RequestExitWithStatus(false, bFailed ? 1 : 0);
+		}
+	}
+
+	/** The live bot, only kept alive by the ticker until it finishes */
+	static TWeakPtr<FAimBotDriver> ActiveDriver;
+
+	static void RunAimBotCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+
+		if (Args.Contains(TEXT("Stop")))
+		{
+			if (TSharedPtr<FAimBotDriver> Driver = ActiveDriver.Pin())
+			{
+				Driver->Stop();
+			}
+			return;
+		}
+
+		if (Args.Contains(TEXT("Live")))
+		{
+			if (ActiveDriver.IsValid())
+			{
+				UE_LOG(LogAimBot, Warning, TEXT("The aim bot is already playing"));
+				return;
+			}
+
+			float Seconds = 60.f;
+			FParse::Value(*Params, TEXT("Seconds="), Seconds);
+			TSharedPtr<FAimBotDriver> Driver = MakeShared<FAimBotDriver>(World, FAimMotorSettings(), Seconds);
+			ActiveDriver = Driver;
+			FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Driver](float)
+			{
+				return !Driver->IsFinished();
+			}));
+			return;
+		}
+
+		RunHeadless(World, Params, Args.Contains(TEXT("Quit")));
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs AimBotCommand(
+		TEXT("HoffmannMehat.AimBot"),
+		TEXT("Measures time to target, overshoot and settle time of a synthetic player for each curve profile and sensitivity, written to Saved/AimBot. Quit exits with status 1 if a trial never settled. Usage: HoffmannMehat.AimBot [Trials=N] [Profiles=A,B] [Sensitivity=X,Y] [Seed=N] [Quit] | Live [Seconds=N] | Stop"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunAimBotCommand));
+}
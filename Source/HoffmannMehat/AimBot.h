@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+
+struct FAimResponseProfile;
+class AHoffmannMehatCharacter;
+class UWorld;
+
+/** How the synthetic player perceives and corrects aim error */
+struct FAimMotorSettings
+{
+	/** Time before a change in aim error is acted on (s) */
+	float ReactionDelay = 0.2f;
+
+	/** Stick per degree of perceived error */
+	float Kp = 0.04f;
+
+	/** Stick per degree second of accumulated error */
+	float Ki = 0.f;
+
+	/** Stick per degree per second of perceived error change */
+	float Kd = 0.004f;
+
+	/** Standard deviation of the stick noise at rest, and how much it grows with deflection */
+	float NoiseBase = 0.01f;
+	float NoiseGain = 0.1f;
+};
+
+/**
+ * Human-like stick control: the aim error is seen after a reaction delay, corrected with a PID
+ * rule, and the resulting stick deflection carries signal dependent noise.
+ */
+class FAimMotorModel
+{
+public:
+	FAimMotorModel(const FAimMotorSettings& InSettings, int32 Seed);
+
+	/**
+	 * Feeds the current aim error and returns the stick to hold until the next update
+	 * @param Time		Seconds since the model was created, increasing
+	 * @param Error		Yaw and pitch from the crosshair to the target (deg)
+	 * @returns stick deflection for yaw and pitch, positive turns right / up, in [-1, 1]
+	 */
+	FVector2D Update(float Time, float DeltaTime, const FVector2D& Error);
+
+private:
+	FAimMotorSettings Settings;
+	FRandomStream Random;
+
+	/** Errors with the time they were seen, oldest first from HistoryStart */
+	TArray<TPair<float, FVector2D>> History;
+	int32 HistoryStart;
+
+	FVector2D Integral;
+	FVector2D LastPerceived;
+	bool bHasPerceived;
+};
+
+/**
+ * Everything about a headless trial that isn't the motor model or the curve. The look settings
+ * come from the character and its controller, see FromCharacter.
+ */
+struct FAimBotTrialSettings
+{
+	/** Frame length, the motor model and the look input are updated once per frame like in the live driver (s) */
+	float FrameSeconds = 1.f / 120.f;
+
+	/** Trials that haven't settled by then fail (s) */
+	float MaxSeconds = 3.f;
+
+	/** Time the crosshair has to stay on the target to count as settled (s) */
+	float HoldSeconds = 0.2f;
+
+	/** AHoffmannMehatCharacter's look settings */
+	float DeadZone;
+	float BaseTurnRate;
+	float BaseLookUpRate;
+	bool bFixedStepAim;
+	float AimStepRate;
+	int32 MaxAimSubsteps;
+
+	/** Multiplier on both base rates */
+	float Sensitivity = 1.f;
+
+	/** APlayerController's input scales */
+	float InputYawScale;
+	float InputPitchScale;
+
+	/** Look settings of Character and its controller, or of the class defaults where there are none */
+	static FAimBotTrialSettings FromCharacter(const AHoffmannMehatCharacter* Character);
+};
+
+struct FAimBotTrialResult
+{
+	/** The crosshair reached the target */
+	bool bAcquired = false;
+
+	/** The crosshair stayed on the target for HoldSeconds */
+	bool bSettled = false;
+
+	/** First time on the target (s) */
+	float TimeToTarget = 0.f;
+
+	/** Time after which the crosshair never left the target again (s) */
+	float SettleTime = 0.f;
+
+	/** Furthest the crosshair went past the target, along the initial error (deg) */
+	float Overshoot = 0.f;
+};
+
+/** Headless trials of the synthetic player against a response curve */
+namespace AimBot
+{
+	/**
+	 * Flicks from InitialError to a target of the given angular radius. Each frame's stick goes
+	 * through the character's fixed step look integration and the controller's input scales, as
+	 * TurnAtRate and LookUpAtRate would, with Profile in place of the character's curves.
+	 * @returns the trial's timings, deterministic for a given Seed
+	 */
+	FAimBotTrialResult RunTrial(const FAimResponseProfile& Profile, const FAimMotorSettings& Motor, const FAimBotTrialSettings& Settings, const FVector2D& InitialError, float TargetAngularRadius, int32 Seed);
+}
+
+/**
+ * Drives the possessed character with the motor model through the normal input path. Targets
+ * come from the game mode's registry, and the ASpawnVolume spawns a new one whenever it runs
+ * out. Once the crosshair has settled on a target the bot shoots at it until the target leaves
+ * play, the shots resolve like the player's. Started with
+ *
+ *	HoffmannMehat.AimBot Live [Seconds=N]
+ */
+class FAimBotDriver : public FTickableGameObject
+{
+public:
+	FAimBotDriver(UWorld* InWorld, const FAimMotorSettings& InMotor, float InSeconds);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !bFinished; }
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	bool IsFinished() const { return bFinished; }
+
+	/** Hands the stick back to the player */
+	void Stop();
+
+private:
+	/** Closest live target to the crosshair, spawning one if there is none */
+	AActor* FindTarget(const FVector& CameraLocation, const FRotator& CameraRotation);
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<AHoffmannMehatCharacter> Character;
+	FAimMotorModel Motor;
+	float Seconds;
+	float Time;
+
+	TWeakObjectPtr<AActor> Target;
+	float TargetStartTime;
+	float OnTargetTime;
+	TArray<float> TimesToTarget;
+
+	/** Time of the last shot, at Target or an earlier one, negative before the first */
+	float LastShotTime;
+	bool bShotAtTarget;
+	int32 NumShots;
+
+	/** Targets that left play after being shot at */
+	int32 NumKills;
+
+	bool bFinished;
+};
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AimHeatmap.h"
+#include "AimSessionRecorder.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+
+namespace AimHeatmap
+{
+	/** Samples binned by one parallel task */
+	static const int32 ChunkSize = 4096;
+
+	/** Frames further apart than this are treated as a gap in the recording (sec) */
+	static const float MaxFrameGap = 0.1f;
+
+	/** Bins a sample stream in parallel chunks and sums the partial histograms */
+	static void BinParallel(const TArray<float>& X, const TArray<float>& Y, float Range, int32 Resolution, TArray<uint32>& OutBins)
+	{
+		check(X.Num() == Y.Num());
+
+		const int32 NumBins = Resolution * Resolution;
+		const int32 NumChunks = FMath::DivideAndRoundUp(X.Num(), ChunkSize);
+
+		TArray<TArray<uint32>> ChunkBins;
+		ChunkBins.SetNum(NumChunks);
+
+		ParallelFor(NumChunks, [&](int32 ChunkIndex)
+		{
+			const int32 Start = ChunkIndex * ChunkSize;
+			const int32 Count = FMath::Min(ChunkSize, X.Num() - Start);
+
+			TArray<uint32>& Bins = ChunkBins[ChunkIndex];
+			Bins.SetNumZeroed(NumBins);
+			FAimHeatmapBuilder::BinSamples(X.GetData() + Start, Y.GetData() + Start, Count, Range, Resolution, Bins.GetData());
+		});
+
+		OutBins.SetNumZeroed(NumBins);
+		for (const TArray<uint32>& Bins : ChunkBins)
+		{
+			for (int32 Index = 0; Index < NumBins; ++Index)
+			{
+				OutBins[Index] += Bins[Index];
+			}
+		}
+	}
+
+	/** Maps bin counts onto a transparent -> red -> yellow ramp */
+	static void ColorizeBins(const TArray<uint32>& Bins, TArray<FColor>& OutPixels)
+	{
+		uint32 MaxCount = 0;
+		for (uint32 Count : Bins)
+		{
+			MaxCount = FMath::Max(MaxCount, Count);
+		}
+
+		OutPixels.SetNumUninitialized(Bins.Num());
+		const float InvMax = MaxCount > 0 ? 1.f / MaxCount : 0.f;
+		for (int32 Index = 0; Index < Bins.Num(); ++Index)
+		{
+			// sqrt so a handful of stray shots still show up next to the dense center
+			const float Heat = FMath::Sqrt(Bins[Index] * InvMax);
+			const FLinearColor Color(1.f, FMath::Clamp(Heat * 2.f - 1.f, 0.f, 1.f), 0.f, FMath::Clamp(Heat * 2.f, 0.f, 1.f));
+			OutPixels[Index] = Color.ToFColor(false);
+		}
+	}
+}
+
+FAimHeatmapResult FAimHeatmapBuilder::Build(const FAimSessionData& Data, float Range, int32 Resolution, float FlickSpeedThreshold)
+{
+	FAimHeatmapResult Result;
+	Result.Resolution = Resolution;
+
+	TArray<uint32> Bins;
+	AimHeatmap::BinParallel(Data.ShotErrorYaw, Data.ShotErrorPitch, Range, Resolution, Bins);
+	AimHeatmap::ColorizeBins(Bins, Result.ShotPixels);
+
+	TArray<float> Along;
+	TArray<float> Across;
+	ExtractFlickErrors(Data, FlickSpeedThreshold, Along, Across);
+	AimHeatmap::BinParallel(Along, Across, Range, Resolution, Bins);
+	AimHeatmap::ColorizeBins(Bins, Result.FlickPixels);
+
+	return Result;
+}
+
+void FAimHeatmapBuilder::BinSamples(const float* X, const float* Y, int32 Count, float Range, int32 Resolution, uint32* Bins)
+{
+	// Blueprints can set the range past the property's clamp, and there's no window to bin into
+	if (Range <= 0.f)
+	{
+		return;
+	}
+
+	// Cell = clamp((Value + Range) * Resolution / (2 * Range), 0, Resolution - 1)
+	const float Scale = Resolution / (2.f * Range);
+	const VectorRegister VScale = VectorSetFloat1(Scale);
+	const VectorRegister VOffset = VectorSetFloat1(Range * Scale);
+	const VectorRegister VMin = VectorZero();
+	const VectorRegister VMax = VectorSetFloat1(Resolution - 1.f);
+
+	MS_ALIGN(16) float CellX[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float CellY[4] GCC_ALIGN(16);
+
+	int32 Index = 0;
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		const VectorRegister VX = VectorMin(VectorMax(VectorMultiplyAdd(VectorLoad(X + Index), VScale, VOffset), VMin), VMax);
+		const VectorRegister VY = VectorMin(VectorMax(VectorMultiplyAdd(VectorLoad(Y + Index), VScale, VOffset), VMin), VMax);
+		VectorStoreAligned(VX, CellX);
+		VectorStoreAligned(VY, CellY);
+
+		// clamped to >= 0, so truncating is the same as flooring
+		++Bins[(int32)CellY[0] * Resolution + (int32)CellX[0]];
+		++Bins[(int32)CellY[1] * Resolution + (int32)CellX[1]];
+		++Bins[(int32)CellY[2] * Resolution + (int32)CellX[2]];
+		++Bins[(int32)CellY[3] * Resolution + (int32)CellX[3]];
+	}
+
+	for (; Index < Count; ++Index)
+	{
+		const int32 CX = (int32)FMath::Clamp(X[Index] * Scale + Range * Scale, 0.f, Resolution - 1.f);
+		const int32 CY = (int32)FMath::Clamp(Y[Index] * Scale + Range * Scale, 0.f, Resolution - 1.f);
+		++Bins[CY * Resolution + CX];
+	}
+}
+
+void FAimHeatmapBuilder::ExtractFlickErrors(const FAimSessionData& Data, float FlickSpeedThreshold, TArray<float>& OutAlong, TArray<float>& OutAcross)
+{
+	OutAlong.Reset();
+	OutAcross.Reset();
+
+	for (int32 Index = 1; Index < Data.FrameTime.Num(); ++Index)
+	{
+		const float DeltaTime = Data.FrameTime[Index] - Data.FrameTime[Index - 1];
+		if (DeltaTime <= 0.f || DeltaTime > AimHeatmap::MaxFrameGap)
+		{
+			continue;
+		}
+
+		const float YawSpeed = FMath::FindDeltaAngleDegrees(Data.FrameYaw[Index - 1], Data.FrameYaw[Index]) / DeltaTime;
+		const float PitchSpeed = FMath::FindDeltaAngleDegrees(Data.FramePitch[Index - 1], Data.FramePitch[Index]) / DeltaTime;
+		const float Speed = FMath::Sqrt(YawSpeed * YawSpeed + PitchSpeed * PitchSpeed);
+		if (Speed < FlickSpeedThreshold)
+		{
+			continue;
+		}
+
+		// positive along the motion means the crosshair is past the target, i.e. overshooting
+		const float DirYaw = YawSpeed / Speed;
+		const float DirPitch = PitchSpeed / Speed;
+		const float ErrorYaw = Data.FrameErrorYaw[Index];
+		const float ErrorPitch = Data.FrameErrorPitch[Index];
+		OutAlong.Add(ErrorYaw * DirYaw + ErrorPitch * DirPitch);
+		OutAcross.Add(ErrorPitch * DirYaw - ErrorYaw * DirPitch);
+	}
+}
+
+UTexture2D* FAimHeatmapBuilder::CreateTexture(const TArray<FColor>& Pixels, int32 Resolution)
+{
+	check(IsInGameThread());
+	check(Pixels.Num() == Resolution * Resolution);
+
+	UTexture2D* Texture = UTexture2D::CreateTransient(Resolution, Resolution, PF_B8G8R8A8);
+	if (Texture == nullptr)
+	{
+		return nullptr;
+	}
+
+	Texture->Filter = TF_Nearest;
+
+	FTexture2DMipMap& Mip = Texture->PlatformData->Mips[0];
+	void* MipData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(MipData, Pixels.GetData(), Pixels.Num() * sizeof(FColor));
+	Mip.BulkData.Unlock();
+
+	Texture->UpdateResource();
+	return Texture;
+}
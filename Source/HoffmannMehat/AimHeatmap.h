@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAimSessionData;
+class UTexture2D;
+
+/** Pixels of the post-session heatmaps, ready to be copied into textures */
+struct FAimHeatmapResult
+{
+	int32 Resolution = 0;
+
+	/** Where shots landed relative to the target (x = yaw error, y = pitch error) */
+	TArray<FColor> ShotPixels;
+
+	/** Error while flicking (x = along the flick, positive is overshoot; y = across it) */
+	TArray<FColor> FlickPixels;
+};
+
+/**
+ * Turns a recorded session into 2D error histograms. Everything except CreateTexture is
+ * safe to run off the game thread.
+ */
+struct HOFFMANNMEHAT_API FAimHeatmapBuilder
+{
+	/** Builds both heatmaps, binning chunks of the session in parallel */
+	static FAimHeatmapResult Build(const FAimSessionData& Data, float Range, int32 Resolution, float FlickSpeedThreshold);
+
+	/**
+	 * Adds Count (X, Y) samples in [-Range, Range] to a Resolution x Resolution histogram.
+	 * Samples outside the window land in the edge bins. Adds nothing if Range isn't positive.
+	 */
+	static void BinSamples(const float* X, const float* Y, int32 Count, float Range, int32 Resolution, uint32* Bins);
+
+	/** Splits each frame's error into components along and across the camera motion, for frames moving faster than FlickSpeedThreshold */
+	static void ExtractFlickErrors(const FAimSessionData& Data, float FlickSpeedThreshold, TArray<float>& OutAlong, TArray<float>& OutAcross);
+
+	/** Creates a transient texture from heatmap pixels. Game thread only. */
+	static UTexture2D* CreateTexture(const TArray<FColor>& Pixels, int32 Resolution);
+};
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AimHeatmapWidget.h"
+#include "AimSessionRecorder.h"
+#include "Components/Image.h"
+
+void UAimHeatmapWidget::ShowSession(UAimSessionRecorder* Recorder)
+{
+	if (Recorder == nullptr)
+	{
+		return;
+	}
+
+	if (BoundRecorder != Recorder)
+	{
+		if (BoundRecorder != nullptr)
+		{
+			BoundRecorder->OnHeatmapsReady.RemoveDynamic(this, &UAimHeatmapWidget::HandleHeatmapsReady);
+		}
+		BoundRecorder = Recorder;
+		BoundRecorder->OnHeatmapsReady.AddUniqueDynamic(this, &UAimHeatmapWidget::HandleHeatmapsReady);
+	}
+
+	Recorder->BuildHeatmaps();
+}
+
+void UAimHeatmapWidget::NativeDestruct()
+{
+	if (BoundRecorder != nullptr)
+	{
+		BoundRecorder->OnHeatmapsReady.RemoveDynamic(this, &UAimHeatmapWidget::HandleHeatmapsReady);
+		BoundRecorder = nullptr;
+	}
+
+	Super::NativeDestruct();
+}
+
+void UAimHeatmapWidget::HandleHeatmapsReady(UTexture2D* ShotHeatmap, UTexture2D* FlickHeatmap)
+{
+	if (ShotHeatmapImage != nullptr && ShotHeatmap != nullptr)
+	{
+		ShotHeatmapImage->SetBrushFromTexture(ShotHeatmap);
+	}
+	if (FlickHeatmapImage != nullptr && FlickHeatmap != nullptr)
+	{
+		FlickHeatmapImage->SetBrushFromTexture(FlickHeatmap);
+	}
+
+	OnHeatmapsShown(ShotHeatmap, FlickHeatmap);
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "AimHeatmapWidget.generated.h"
+
+class UAimSessionRecorder;
+class UImage;
+class UTexture2D;
+
+/**
+ * Post-session review screen showing where shots landed and how flicks over/undershot
+ */
+UCLASS()
+class HOFFMANNMEHAT_API UAimHeatmapWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/** Ends the recorder's session and shows its heatmaps once they have been built */
+	UFUNCTION(BlueprintCallable, Category = "Statistics")
+	void ShowSession(UAimSessionRecorder* Recorder);
+
+	/** Called when new heatmaps have been applied to the images */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Statistics")
+	void OnHeatmapsShown(UTexture2D* ShotHeatmap, UTexture2D* FlickHeatmap);
+
+protected:
+	virtual void NativeDestruct() override;
+
+	UFUNCTION()
+	void HandleHeatmapsReady(UTexture2D* ShotHeatmap, UTexture2D* FlickHeatmap);
+
+	/** Shot error around the target */
+	UPROPERTY(meta = (BindWidgetOptional))
+	UImage* ShotHeatmapImage;
+
+	/** Flick error, along the motion horizontally and across it vertically */
+	UPROPERTY(meta = (BindWidgetOptional))
+	UImage* FlickHeatmapImage;
+
+private:
+	UPROPERTY(Transient)
+	UAimSessionRecorder* BoundRecorder;
+};
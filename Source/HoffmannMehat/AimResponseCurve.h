@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Response curve lookups, piecewise linear approximations of the target game's curve
+ * @param Rate	Stick deflection past the dead zone, in percent [0, 100]
+ * @returns the normalized rate [0, 1]
+ */
+float CalcXInputRate(float xRate);
+float CalcYInputRate(float yRate);
+
+/**
+ * Turns a raw stick value into the normalized turn rate TurnAtRate applies: dead zone,
+ * rescale of the remaining range, response curve, then the stick's sign.
+ */
+float EvaluateTurnRate(float xRate, float DeadZone);
+
+/** Same as EvaluateTurnRate for LookUpAtRate and the vertical curve */
+float EvaluateLookUpRate(float yRate, float DeadZone);
+
+/**
+ * Checks both curves against the checked-in golden table, for monotonicity, for continuity
+ * at the knots and for sign symmetry, then times them. Failures are logged as errors. The
+ * HoffmannMehat.AimCurve automation tests run the same checks.
+ * @param MaxNanosecondsPerEval	Timing budget per curve evaluation, <= 0 skips the timing gate
+ * @returns true if every check passed
+ */
+bool ValidateResponseCurves(float MaxNanosecondsPerEval);
+
+/**
+ * A response curve as a table of knots with linear interpolation between them, so alternative
+ * curves can be compared with the built-in ones by the aim bot and the shadow evaluation
+ */
+struct FAimResponseProfile
+{
+	FName Name;
+
+	/** Stick deflection past the dead zone at each knot, in percent, ascending from 0 to 100 */
+	TArray<float> Inputs;
+
+	/** Normalized rate at each knot */
+	TArray<float> Outputs;
+
+	/** Same contract as CalcXInputRate */
+	float Evaluate(float Rate) const;
+
+	/** Same contract as EvaluateTurnRate */
+	float EvaluateStick(float Stick, float DeadZone) const;
+
+	/** Samples a curve at the knots of the built-in curves, which reproduces them exactly */
+	static FAimResponseProfile FromCurve(FName Name, float (*Curve)(float));
+
+	/** Rate = Deflection ^ Exponent */
+	static FAimResponseProfile FromPower(FName Name, float Exponent);
+
+	/** X and Y curves, linear, and two power curves */
+	static const TArray<FAimResponseProfile>& GetBuiltInProfiles();
+
+	/** Finds a built-in profile by name, nullptr if there is none */
+	static const FAimResponseProfile* FindBuiltInProfile(FName Name);
+};
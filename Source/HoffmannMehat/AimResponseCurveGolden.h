@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Expected output of CalcXInputRate / CalcYInputRate at every half percent of stick travel,
+ * used by ValidateResponseCurves. Only regenerate this (HoffmannMehat.ValidateCurve Dump)
+ * when a curve change is intended.
+ */
+namespace AimCurveGolden
+{
+	/** Samples are taken at Index * Step percent */
+	static const int32 NumSamples = 201;
+	static const float Step = 0.5f;
+}
+
+static const float GoldenXInputRate[AimCurveGolden::NumSamples] =
+{
+	0.f, 0.000790660735f, 0.00158132147f, 0.00237198221f, 0.00316264294f, 0.00395330368f, 0.00474396441f, 0.00553462515f,
+	0.00632528588f, 0.0071110893f, 0.00789552927f, 0.00867997017f, 0.00946441013f, 0.0102488501f, 0.0110432487f, 0.0118607329f,
+	0.0126782162f, 0.0134957004f, 0.0143131837f, 0.015130667f, 0.015998628f, 0.0168775246f, 0.0177564193f, 0.0186353158f,
+	0.0195142124f, 0.0204229783f, 0.0213890914f, 0.0223552063f, 0.0233213194f, 0.0242874343f, 0.0252535474f, 0.026323285f,
+	0.0274094697f, 0.0284956526f, 0.0295818374f, 0.0306680221f, 0.0318125822f, 0.0330509581f, 0.034289334f, 0.0355277099f,
+	0.0367660858f, 0.0380044617f, 0.0394006185f, 0.0408135094f, 0.0422264002f, 0.0436392911f, 0.0450521819f, 0.0465600193f,
+	0.0481964909f, 0.0498329662f, 0.0514694415f, 0.0531059168f, 0.0547423922f, 0.0565839671f, 0.0584374331f, 0.0602908954f,
+	0.0621443614f, 0.0639978275f, 0.0659737214f, 0.0680900514f, 0.0702063814f, 0.0723227039f, 0.0744390339f, 0.0765553638f,
+	0.0790028274f, 0.081454888f, 0.0839069411f, 0.0863590017f, 0.0888110623f, 0.0914085507f, 0.0941475332f, 0.0968865156f,
+	0.0996254981f, 0.102364473f, 0.105113484f, 0.108218431f, 0.111323379f, 0.114428326f, 0.117533274f, 0.120638222f,
+	0.123955853f, 0.127448946f, 0.130942047f, 0.134435147f, 0.137928247f, 0.14145346f, 0.14541547f, 0.149377495f,
+	0.153339505f, 0.15730153f, 0.16126354f, 0.165429786f, 0.169738531f, 0.174047261f, 0.178355992f, 0.182664722f,
+	0.187028497f, 0.191839501f, 0.19665052f, 0.201461539f, 0.206272542f, 0.211083561f, 0.216137677f, 0.221334487f,
+	0.226531297f, 0.231728107f, 0.236924931f, 0.242135555f, 0.247424096f, 0.252712637f, 0.258001179f, 0.26328972f,
+	0.268578261f, 0.274144709f, 0.279847264f, 0.285549849f, 0.291252404f, 0.296954989f, 0.30279842f, 0.309235483f,
+	0.315672517f, 0.32210958f, 0.328546643f, 0.334983677f, 0.340761304f, 0.346272647f, 0.351783961f, 0.357295305f,
+	0.362806618f, 0.368587643f, 0.375257075f, 0.381926477f, 0.388595909f, 0.395265341f, 0.401934773f, 0.409385085f,
+	0.417090982f, 0.424796849f, 0.432502747f, 0.440208644f, 0.447847426f, 0.455308348f, 0.4627693f, 0.470230252f,
+	0.477691174f, 0.485152125f, 0.492619276f, 0.500087976f, 0.507556736f, 0.515025496f, 0.522494197f, 0.530202568f,
+	0.538431764f, 0.546661019f, 0.554890215f, 0.563119471f, 0.571348727f, 0.58024466f, 0.589271784f, 0.598298848f,
+	0.607325971f, 0.616353095f, 0.625374794f, 0.634386778f, 0.643398762f, 0.652410746f, 0.661422729f, 0.670434654f,
+	0.680156767f, 0.689978719f, 0.699800611f, 0.709622562f, 0.719444513f, 0.729218781f, 0.738920629f, 0.748622477f,
+	0.758324325f, 0.768026173f, 0.777728021f, 0.788749516f, 0.799889147f, 0.811028779f, 0.822168469f, 0.833308101f,
+	0.844532788f, 0.855866492f, 0.867200196f, 0.878533959f, 0.889867663f, 0.901201367f, 0.912476003f, 0.923748195f,
+	0.935020328f, 0.94629246f, 0.957564592f, 0.966631949f, 0.973305583f, 0.979979157f, 0.986652792f, 0.993326366f,
+	1.f,
+};
+
+static const float GoldenYInputRate[AimCurveGolden::NumSamples] =
+{
+	0.f, 0.000761503179f, 0.00152300636f, 0.0022845096f, 0.00304601272f, 0.00380751584f, 0.00456901919f, 0.00533052208f,
+	0.00609202543f, 0.00685036508f, 0.00760781625f, 0.00836526789f, 0.00912271999f, 0.00988017116f, 0.0106455144f, 0.0114291497f,
+	0.012212785f, 0.0129964212f, 0.0137800565f, 0.0145636918f, 0.015401938f, 0.0162520166f, 0.0171020944f, 0.0179521721f,
+	0.0188022498f, 0.0196807701f, 0.0206138976f, 0.0215470251f, 0.0224801525f, 0.0234132819f, 0.0243464094f, 0.0253746845f,
+	0.0264180638f, 0.0274614412f, 0.0285048205f, 0.0295481998f, 0.0306453183f, 0.0318288058f, 0.0330122896f, 0.034195777f,
+	0.0353792608f, 0.0365627483f, 0.0379217826f, 0.0392994396f, 0.0406770967f, 0.04205475f, 0.0434324071f, 0.0448819399f,
+	0.0464288518f, 0.0479757674f, 0.0495226793f, 0.0510695949f, 0.0526165105f, 0.0544187091f, 0.0562357083f, 0.0580527075f,
+	0.0598697066f, 0.0616867058f, 0.063613981f, 0.0656677485f, 0.0677215233f, 0.0697752908f, 0.0718290657f, 0.0738828331f,
+	0.0762333199f, 0.0785879195f, 0.0809425265f, 0.0832971334f, 0.0856517404f, 0.0881619975f, 0.0908236951f, 0.0934854001f,
+	0.0961471051f, 0.0988088027f, 0.101479001f, 0.104450881f, 0.107422762f, 0.110394642f, 0.113366514f, 0.116338395f,
+	0.119501255f, 0.122821674f, 0.126142099f, 0.12946251f, 0.132782936f, 0.136136144f, 0.13993524f, 0.143734336f,
+	0.147533447f, 0.151332542f, 0.155131638f, 0.159130871f, 0.163269743f, 0.1674086f, 0.171547472f, 0.17568633f,
+	0.179894552f, 0.184666231f, 0.189437926f, 0.194209605f, 0.1989813f, 0.20375298f, 0.208449632f, 0.213102251f,
+	0.217754856f, 0.22240746f, 0.22706008f, 0.231804371f, 0.237065479f, 0.242326587f, 0.247587696f, 0.252848804f,
+	0.258109897f, 0.263390213f, 0.268679947f, 0.27396968f, 0.279259413f, 0.284549117f, 0.290006638f, 0.296171248f,
+	0.302335858f, 0.308500469f, 0.314665079f, 0.32082969f, 0.326884657f, 0.332895398f, 0.338906109f, 0.34491685f,
+	0.350927562f, 0.357002199f, 0.36328733f, 0.369572461f, 0.375857592f, 0.382142723f, 0.388427854f, 0.395581871f,
+	0.403020263f, 0.410458654f, 0.417897046f, 0.425335467f, 0.432618767f, 0.439491153f, 0.446363509f, 0.453235865f,
+	0.46010825f, 0.466980606f, 0.473579288f, 0.480107218f, 0.486635119f, 0.493163049f, 0.49969098f, 0.507263184f,
+	0.51710552f, 0.526947916f, 0.536790252f, 0.546632648f, 0.556475043f, 0.564352572f, 0.571843624f, 0.579334676f,
+	0.586825728f, 0.594316781f, 0.601315141f, 0.607422829f, 0.613530576f, 0.619638264f, 0.625746012f, 0.6318537f,
+	0.645045936f, 0.659234405f, 0.673422933f, 0.687611401f, 0.70179987f, 0.713560164f, 0.721636295f, 0.729712427f,
+	0.737788558f, 0.74586463f, 0.753940761f, 0.763157666f, 0.772476792f, 0.781795859f, 0.791114926f, 0.800433993f,
+	0.811790884f, 0.825758696f, 0.839726508f, 0.85369432f, 0.867662132f, 0.881629884f, 0.890226662f, 0.898593187f,
+	0.906959713f, 0.915326238f, 0.923692763f, 0.934343755f, 0.947475016f, 0.960606277f, 0.973737478f, 0.986868739f,
+	1.f,
+};
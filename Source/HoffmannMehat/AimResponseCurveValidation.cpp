@@ -0,0 +1,305 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AimResponseCurve.h"
+#include "AimResponseCurveGolden.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimCurve, Log, All);
+
+namespace AimCurveValidation
+{
+	/** Allowed difference from the golden table, loose enough for compiler float reordering */
+	static const float GoldenTolerance = 1e-5f;
+
+	/** Step of the monotonicity sweep (percent) */
+	static const float SweepStep = 0.01f;
+
+	/** Curves are sampled this far either side of a knot (percent) */
+	static const float KnotProbe = 1e-3f;
+
+	/** Largest allowed jump across a knot. The steepest segment moves ~5.7e-5 over two probes. */
+	static const float KnotTolerance = 1e-4f;
+
+	/** Knots sit at (n + 0.5) / 36.5 of the stick's travel */
+	static const int32 NumKnots = 35;
+
+	static const float SymmetryDeadZone = 0.1f;
+
+	static const int32 TimingIterations = 1000000;
+
+	static volatile float Sink = 0.f;
+
+	static TAutoConsoleVariable<float> CVarMaxNanosecondsPerEval(
+		TEXT("HoffmannMehat.CurveMaxNsPerEval"),
+		50.f,
+		TEXT("Timing budget of one response curve evaluation used by HoffmannMehat.ValidateCurve, <= 0 disables the timing gate"));
+
+	typedef float (*FCurveFunction)(float);
+	typedef float (*FEvaluateFunction)(float, float);
+
+	static void CheckGolden(const TCHAR* Name, FCurveFunction Curve, const float* Golden, TArray<FString>& OutErrors)
+	{
+		for (int32 Index = 0; Index < AimCurveGolden::NumSamples; ++Index)
+		{
+			const float Rate = Index * AimCurveGolden::Step;
+			const float Value = Curve(Rate);
+			if (!FMath::IsNearlyEqual(Value, Golden[Index], GoldenTolerance))
+			{
+				OutErrors.Add(FString::Printf(TEXT("%s(%.2f) = %.9g, golden table has %.9g"), Name, Rate, Value, Golden[Index]));
+			}
+		}
+	}
+
+	static void CheckShape(const TCHAR* Name, FCurveFunction Curve, TArray<FString>& OutErrors)
+	{
+		if (Curve(0.f) != 0.f || Curve(100.f) != 1.f)
+		{
+			OutErrors.Add(FString::Printf(TEXT("%s should map [0, 100] onto [0, 1], got %.9g and %.9g"), Name, Curve(0.f), Curve(100.f)));
+		}
+
+		const int32 NumSteps = FMath::RoundToInt(100.f / SweepStep);
+		float Previous = Curve(0.f);
+		for (int32 Step = 1; Step <= NumSteps; ++Step)
+		{
+			const float Rate = Step * SweepStep;
+			const float Value = Curve(Rate);
+			if (Value < Previous)
+			{
+				OutErrors.Add(FString::Printf(TEXT("%s decreases at %.2f: %.9g -> %.9g"), Name, Rate, Previous, Value));
+			}
+			Previous = Value;
+		}
+
+		for (int32 Knot = 1; Knot <= NumKnots; ++Knot)
+		{
+			const float Rate = (Knot + 0.5f) * 100.f / 36.5f;
+			const float Jump = FMath::Abs(Curve(Rate + KnotProbe) - Curve(Rate - KnotProbe));
+			if (Jump > KnotTolerance)
+			{
+				OutErrors.Add(FString::Printf(TEXT("%s jumps by %.9g at the knot at %.4f"), Name, Jump, Rate));
+			}
+		}
+	}
+
+	static void CheckSymmetry(const TCHAR* Name, FEvaluateFunction Evaluate, TArray<FString>& OutErrors)
+	{
+		for (int32 Step = 0; Step <= 1000; ++Step)
+		{
+			const float Stick = Step * 0.001f;
+			const float Positive = Evaluate(Stick, SymmetryDeadZone);
+			const float Negative = Evaluate(-Stick, SymmetryDeadZone);
+			if (Positive != -Negative || Positive < 0.f)
+			{
+				OutErrors.Add(FString::Printf(TEXT("%s is not odd at %.3f: %.9g and %.9g"), Name, Stick, Positive, Negative));
+			}
+		}
+	}
+
+	static double TimeCurve(FCurveFunction Curve)
+	{
+		float Sum = 0.f;
+		const double Start = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < TimingIterations; ++Index)
+		{
+			Sum += Curve((Index % 10001) * 0.01f);
+		}
+		const double Seconds = FPlatformTime::Seconds() - Start;
+		Sink = Sum;
+		return Seconds * 1e9 / TimingIterations;
+	}
+
+	static void CheckTiming(const TCHAR* Name, FCurveFunction Curve, float MaxNanosecondsPerEval, TArray<FString>& OutErrors)
+	{
+		// Best of a few runs so one preemption doesn't fail the gate
+		double Best = TimeCurve(Curve);
+		for (int32 Run = 1; Run < 3; ++Run)
+		{
+			Best = FMath::Min(Best, TimeCurve(Curve));
+		}
+
+		if (Best > MaxNanosecondsPerEval)
+		{
+			OutErrors.Add(FString::Printf(TEXT("%s takes %.2f ns per evaluation, the budget is %.2f ns"), Name, Best, MaxNanosecondsPerEval));
+			return;
+		}
+
+		UE_LOG(LogAimCurve, Display, TEXT("%s takes %.2f ns per evaluation"), Name, Best);
+	}
+
+	static void CheckAllGolden(TArray<FString>& OutErrors)
+	{
+		CheckGolden(TEXT("CalcXInputRate"), &CalcXInputRate, GoldenXInputRate, OutErrors);
+		CheckGolden(TEXT("CalcYInputRate"), &CalcYInputRate, GoldenYInputRate, OutErrors);
+	}
+
+	static void CheckAllShapes(TArray<FString>& OutErrors)
+	{
+		CheckShape(TEXT("CalcXInputRate"), &CalcXInputRate, OutErrors);
+		CheckShape(TEXT("CalcYInputRate"), &CalcYInputRate, OutErrors);
+	}
+
+	static void CheckAllSymmetry(TArray<FString>& OutErrors)
+	{
+		CheckSymmetry(TEXT("EvaluateTurnRate"), &EvaluateTurnRate, OutErrors);
+		CheckSymmetry(TEXT("EvaluateLookUpRate"), &EvaluateLookUpRate, OutErrors);
+	}
+
+	static void CheckAllTiming(float MaxNanosecondsPerEval, TArray<FString>& OutErrors)
+	{
+		CheckTiming(TEXT("CalcXInputRate"), &CalcXInputRate, MaxNanosecondsPerEval, OutErrors);
+		CheckTiming(TEXT("CalcYInputRate"), &CalcYInputRate, MaxNanosecondsPerEval, OutErrors);
+	}
+
+	static void AppendTable(FString& Out, const TCHAR* Name, FCurveFunction Curve)
+	{
+		Out += FString::Printf(TEXT("static const float %s[AimCurveGolden::NumSamples] =\n{\n"), Name);
+		for (int32 Index = 0; Index < AimCurveGolden::NumSamples; ++Index)
+		{
+			FString Value = FString::Printf(TEXT("%.9g"), Curve(Index * AimCurveGolden::Step));
+			if (!Value.Contains(TEXT(".")) && !Value.Contains(TEXT("e")))
+			{
+				Value += TEXT(".");
+			}
+
+			Out += (Index % 8 == 0) ? TEXT("\t") : TEXT(" ");
+			Out += Value + TEXT("f,");
+			if (Index % 8 == 7 || Index == AimCurveGolden::NumSamples - 1)
+			{
+				Out += TEXT("\n");
+			}
+		}
+		Out += TEXT("};\n");
+	}
+
+	/** Writes the current curves in the layout of AimResponseCurveGolden.h */
+	static void DumpGoldenTables()
+	{
+		FString Tables;
+		AppendTable(Tables, TEXT("GoldenXInputRate"), &CalcXInputRate);
+		Tables += TEXT("\n");
+		AppendTable(Tables, TEXT("GoldenYInputRate"), &CalcYInputRate);
+
+		const FString Path = FPaths::ProjectSavedDir() / TEXT("AimResponseCurveGolden.txt");
+		if (FFileHelper::SaveStringToFile(Tables, *Path))
+		{
+			UE_LOG(LogAimCurve, Display, TEXT("Golden tables written to %s"), *Path);
+		}
+		else
+		{
+			UE_LOG(LogAimCurve, Error, TEXT("Failed to write %s"), *Path);
+		}
+	}
+
+	static void RunValidateCommand(const TArray<FString>& Args)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+		float MaxNanoseconds = CVarMaxNanosecondsPerEval.GetValueOnGameThread();
+		FParse::Value(*Params, TEXT("MaxNs="), MaxNanoseconds);
+
+		if (Args.Contains(TEXT("Dump")))
+		{
+			DumpGoldenTables();
+		}
+
+		const bool bPassed = ValidateResponseCurves(MaxNanoseconds);
+
+		if (Args.Contains(TEXT("Quit")))
+		{
+			FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1);
+		}
+	}
+
+	static FAutoConsoleCommand ValidateCommand(
+		TEXT("HoffmannMehat.ValidateCurve"),
+		TEXT("Checks the response curves against the golden table, for monotonicity, knot continuity, sign symmetry and speed. Usage: HoffmannMehat.ValidateCurve [MaxNs=X] [Dump] [Quit]. The same checks run as the HoffmannMehat.AimCurve automation tests."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunValidateCommand));
+}
+
+bool ValidateResponseCurves(float MaxNanosecondsPerEval)
+{
+	using namespace AimCurveValidation;
+
+	TArray<FString> Errors;
+	CheckAllGolden(Errors);
+	CheckAllShapes(Errors);
+	CheckAllSymmetry(Errors);
+	if (MaxNanosecondsPerEval > 0.f)
+	{
+		CheckAllTiming(MaxNanosecondsPerEval, Errors);
+	}
+
+	if (Errors.Num() > 0)
+	{
+		for (const FString& Error : Errors)
+		{
+			UE_LOG(LogAimCurve, Error, TEXT("%s"), *Error);
+		}
+		UE_LOG(LogAimCurve, Error, TEXT("Response curve validation failed with %d errors"), Errors.Num());
+		return false;
+	}
+
+	UE_LOG(LogAimCurve, Display, TEXT("Response curve validation passed"));
+	return true;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace AimCurveValidation
+{
+	static bool ReportErrors(FAutomationTestBase& Test, const TArray<FString>& Errors)
+	{
+		for (const FString& Error : Errors)
+		{
+			Test.AddError(Error);
+		}
+		return Errors.Num() == 0;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAimCurveGoldenTest, "HoffmannMehat.AimCurve.Golden", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FAimCurveGoldenTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Errors;
+	AimCurveValidation::CheckAllGolden(Errors);
+	return AimCurveValidation::ReportErrors(*this, Errors);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAimCurveShapeTest, "HoffmannMehat.AimCurve.Shape", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FAimCurveShapeTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Errors;
+	AimCurveValidation::CheckAllShapes(Errors);
+	return AimCurveValidation::ReportErrors(*this, Errors);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAimCurveSymmetryTest, "HoffmannMehat.AimCurve.Symmetry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FAimCurveSymmetryTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Errors;
+	AimCurveValidation::CheckAllSymmetry(Errors);
+	return AimCurveValidation::ReportErrors(*this, Errors);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAimCurveTimingTest, "HoffmannMehat.AimCurve.Timing", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FAimCurveTimingTest::RunTest(const FString& Parameters)
+{
+	const float MaxNanoseconds = AimCurveValidation::CVarMaxNanosecondsPerEval.GetValueOnGameThread();
+	if (MaxNanoseconds <= 0.f)
+	{
+		AddInfo(TEXT("HoffmannMehat.CurveMaxNsPerEval is off, timing not checked"));
+		return true;
+	}
+
+	TArray<FString> Errors;
+	AimCurveValidation::CheckAllTiming(MaxNanoseconds, Errors);
+	return AimCurveValidation::ReportErrors(*this, Errors);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,494 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AimSessionRecorder.h"
+#include "AimHeatmap.h"
+#include "HoffmannMehatGameMode.h"
+#include "HoffmannMehatMemory.h"
+#include "TrackingScore.h"
+#include "AimShadow.h"
+#include "Async/Async.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimSessionRecorder, Log, All);
+
+namespace AimSessionRecorder
+{
+	/** Bisection steps for a crossing, each halves the interval, 24 is below a microsecond even at 10 fps */
+	static const int32 CrossingIterations = 24;
+
+	/**
+	 * Time the crosshair crossed onto a target between two camera samples. The camera rotation is
+	 * slerped and the camera and target positions are lerped along the way.
+	 */
+	static double SolveCrossing(const FVector& Location0, const FQuat& Rotation0, const FVector& Center0, double Seconds0,
+		const FVector& Location1, const FQuat& Rotation1, const FVector& Center1, double Seconds1, float Radius)
+	{
+		// off target at the start, on at the end
+		float Low = 0.f;
+		float High = 1.f;
+		for (int32 Iteration = 0; Iteration < CrossingIterations; ++Iteration)
+		{
+			const float Alpha = 0.5f * (Low + High);
+			const FVector Direction = FQuat::Slerp(Rotation0, Rotation1, Alpha).GetForwardVector();
+			if (FTrackingScoreBatch::ComputeMargin(FMath::Lerp(Location0, Location1, Alpha), Direction, FMath::Lerp(Center0, Center1, Alpha), Radius) <= 0.f)
+			{
+				High = Alpha;
+			}
+			else
+			{
+				Low = Alpha;
+			}
+		}
+		return Seconds0 + High * (Seconds1 - Seconds0);
+	}
+
+	/** Mean of the entries that happened */
+	static float MeanOfValid(const TArray<double>& Times)
+	{
+		double Sum = 0.0;
+		int32 Count = 0;
+		for (double Time : Times)
+		{
+			if (Time >= 0.0)
+			{
+				Sum += Time;
+				++Count;
+			}
+		}
+		return Count > 0 ? (float)(Sum / Count) : 0.f;
+	}
+}
+
+UAimSessionRecorder::UAimSessionRecorder()
+{
+	// Sample after everything has moved this frame
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	HeatmapRange = 10.f;
+	HeatmapResolution = 64;
+	FlickSpeedThreshold = 90.f;
+	SessionStartTime = 0.f;
+	bInShadowWindow = false;
+	bRecording = false;
+
+	LastCameraLocation = FVector::ZeroVector;
+	LastCameraRotation = FQuat::Identity;
+	LastCameraSeconds = 0.0;
+	bHasLastCamera = false;
+	AimShadow = nullptr;
+}
+
+void UAimSessionRecorder::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AimShadow = GetOwner()->FindComponentByClass<UAimShadowComponent>();
+	BeginSession();
+}
+
+void UAimSessionRecorder::BeginSession()
+{
+	// A heatmap task may still be reading the old session, so start a fresh one instead of clearing it
+	Session = MakeShared<FAimSessionData, ESPMode::ThreadSafe>();
+	SessionStartTime = GetWorld()->GetTimeSeconds();
+	ReactionTrials.Reset();
+	bHasLastCamera = false;
+	bInShadowWindow = false;
+	bRecording = true;
+
+	// the shadows start over from the view the session starts with
+	if (AimShadow != nullptr)
+	{
+		AimShadow->ResetShadows();
+	}
+}
+
+void UAimSessionRecorder::EndSession()
+{
+	CloseShadowWindow();
+	bRecording = false;
+
+	if (Session.IsValid() && Session->ShadowProfiles.Num() > 0)
+	{
+		// shadowing may have been turned off before the end
+		PadShadowFrames(Session->FrameTime.Num());
+
+		UE_LOG(LogAimSessionRecorder, Log, TEXT("Live curve: mean error %.2f deg"), GetShadowMeanError(INDEX_NONE));
+		for (int32 Profile = 0; Profile < Session->ShadowProfiles.Num(); ++Profile)
+		{
+			UE_LOG(LogAimSessionRecorder, Log, TEXT("Shadow %s: mean error %.2f deg"), *Session->ShadowProfiles[Profile].ToString(), GetShadowMeanError(Profile));
+		}
+	}
+}
+
+void UAimSessionRecorder::OpenShadowWindow()
+{
+	CloseShadowWindow();
+
+	if (AimShadow != nullptr)
+	{
+		AimShadow->ResetShadows();
+	}
+	Session->ShadowWindowStart.Add(Session->FrameTime.Num());
+	bInShadowWindow = true;
+}
+
+void UAimSessionRecorder::CloseShadowWindow()
+{
+	if (!bInShadowWindow)
+	{
+		return;
+	}
+	bInShadowWindow = false;
+
+	if (Session->ShadowWindowStart.Last() == Session->FrameTime.Num())
+	{
+		// not a single frame recorded
+		Session->ShadowWindowStart.Pop();
+	}
+	else
+	{
+		Session->ShadowWindowEnd.Add(Session->FrameTime.Num());
+	}
+}
+
+void UAimSessionRecorder::RecordShadowFrame(const FRotator& CameraRotation)
+{
+	if (AimShadow == nullptr || !AimShadow->IsShadowEnabled())
+	{
+		return;
+	}
+
+	// the component resolves its profiles in its own BeginPlay, which may come after ours
+	const int32 NumProfiles = AimShadow->GetNumProfiles();
+	if (Session->ShadowProfiles.Num() != 0 && Session->ShadowProfiles.Num() != NumProfiles)
+	{
+		UE_LOG(LogAimSessionRecorder, Warning, TEXT("The shadow profiles changed during the session, the shadows recorded so far are dropped"));
+		Session->ShadowProfiles.Reset();
+		Session->ShadowFrameYaw.Reset();
+		Session->ShadowFramePitch.Reset();
+	}
+	if (Session->ShadowProfiles.Num() == 0)
+	{
+		for (int32 Profile = 0; Profile < NumProfiles; ++Profile)
+		{
+			Session->ShadowProfiles.Add(AimShadow->GetProfileName(Profile));
+		}
+	}
+
+	PadShadowFrames(Session->FrameTime.Num() - 1);
+
+	// until the first look sample every shadow is where the view is
+	for (int32 Profile = 0; Profile < NumProfiles; ++Profile)
+	{
+		const FRotator Shadow = AimShadow->HasShadowRotations() ? AimShadow->GetShadowRotation(Profile) : CameraRotation;
+		Session->ShadowFrameYaw.Add(FRotator::NormalizeAxis(Shadow.Yaw));
+		Session->ShadowFramePitch.Add(Shadow.Pitch);
+	}
+}
+
+void UAimSessionRecorder::PadShadowFrames(int32 EndFrame)
+{
+	// frames recorded before the profiles were known, or while shadowing was off, had no shadows
+	// to move the view, so they have the real one
+	const int32 NumProfiles = Session->ShadowProfiles.Num();
+	for (int32 Frame = Session->ShadowFrameYaw.Num() / NumProfiles; Frame < EndFrame; ++Frame)
+	{
+		for (int32 Profile = 0; Profile < NumProfiles; ++Profile)
+		{
+			Session->ShadowFrameYaw.Add(FRotator::NormalizeAxis(Session->FrameYaw[Frame]));
+			Session->ShadowFramePitch.Add(Session->FramePitch[Frame]);
+		}
+	}
+}
+
+float UAimSessionRecorder::GetShadowMeanError(int32 Profile) const
+{
+	if (!Session.IsValid() || Session->FrameTime.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	const FAimSessionData& Data = *Session;
+	const int32 NumProfiles = Data.ShadowProfiles.Num();
+	const bool bLive = Profile == INDEX_NONE;
+	if (!bLive && (Profile < 0 || Profile >= NumProfiles || Data.ShadowFrameYaw.Num() != Data.FrameTime.Num() * NumProfiles))
+	{
+		return 0.f;
+	}
+
+	double ErrorSum = 0.0;
+	int32 NumFrames = 0;
+	for (int32 Window = 0; Window < Data.ShadowWindowStart.Num(); ++Window)
+	{
+		const int32 End = Window < Data.ShadowWindowEnd.Num() ? Data.ShadowWindowEnd[Window] : Data.FrameTime.Num();
+		for (int32 Frame = Data.ShadowWindowStart[Window]; Frame < End; ++Frame)
+		{
+			float ErrorYaw = Data.FrameErrorYaw[Frame];
+			float ErrorPitch = Data.FrameErrorPitch[Frame];
+			if (!bLive)
+			{
+				// the error moves with the crosshair, the targets stay where they were
+				const int32 Index = Frame * NumProfiles + Profile;
+				ErrorYaw += FMath::FindDeltaAngleDegrees(Data.FrameYaw[Frame], Data.ShadowFrameYaw[Index]);
+				ErrorPitch += FMath::FindDeltaAngleDegrees(Data.FramePitch[Frame], Data.ShadowFramePitch[Index]);
+			}
+			ErrorSum += FMath::Sqrt(FMath::Square(ErrorYaw) + FMath::Square(ErrorPitch));
+		}
+		NumFrames += End - Data.ShadowWindowStart[Window];
+	}
+	return NumFrames > 0 ? (float)(ErrorSum / NumFrames) : 0.f;
+}
+
+APlayerCameraManager* UAimSessionRecorder::GetCameraManager() const
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	const APlayerController* Controller = Pawn ? Cast<APlayerController>(Pawn->GetController()) : nullptr;
+	return Controller ? Controller->PlayerCameraManager : nullptr;
+}
+
+void UAimSessionRecorder::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	HOFFMANNMEHAT_LLM_SCOPE(Analytics);
+
+	const APlayerCameraManager* CameraManager = GetCameraManager();
+	if (!bRecording || CameraManager == nullptr)
+	{
+		bHasLastCamera = false;
+		return;
+	}
+
+	const FVector CameraLocation = CameraManager->GetCameraLocation();
+	const FRotator CameraRotation = CameraManager->GetCameraRotation();
+
+	UpdateReactionTrials(CameraLocation, CameraRotation, FPlatformTime::Seconds());
+
+	float ErrorYaw, ErrorPitch;
+	if (FindAimError(CameraLocation, CameraRotation, ErrorYaw, ErrorPitch))
+	{
+		Session->FrameTime.Add(GetWorld()->GetTimeSeconds() - SessionStartTime);
+		Session->FrameYaw.Add(CameraRotation.Yaw);
+		Session->FramePitch.Add(CameraRotation.Pitch);
+		Session->FrameErrorYaw.Add(ErrorYaw);
+		Session->FrameErrorPitch.Add(ErrorPitch);
+		RecordShadowFrame(CameraRotation);
+	}
+}
+
+void UAimSessionRecorder::RecordShot(const FVector& CameraLocation, const FRotator& CameraRotation)
+{
+	HOFFMANNMEHAT_LLM_SCOPE(Analytics);
+
+	const double FireSeconds = FPlatformTime::Seconds();
+
+	float ErrorYaw, ErrorPitch;
+	if (bRecording && FindAimError(CameraLocation, CameraRotation, ErrorYaw, ErrorPitch))
+	{
+		Session->ShotErrorYaw.Add(ErrorYaw);
+		Session->ShotErrorPitch.Add(ErrorPitch);
+	}
+
+	// the shot was meant for the trial target closest to the crosshair
+	const FVector Direction = CameraRotation.Vector();
+	int32 ClosestTrial = INDEX_NONE;
+	float ClosestMargin = MAX_flt;
+	for (int32 Index = 0; bRecording && Index < ReactionTrials.Num(); ++Index)
+	{
+		const FReactionTrial& Trial = ReactionTrials[Index];
+		if (const AActor* Target = Trial.Target.Get())
+		{
+			const FVector Center = Target->GetActorTransform().TransformPosition(Trial.LocalCenter);
+			const float Margin = FTrackingScoreBatch::ComputeMargin(CameraLocation, Direction, Center, Trial.Radius);
+			if (Margin < ClosestMargin)
+			{
+				ClosestMargin = Margin;
+				ClosestTrial = Index;
+			}
+		}
+	}
+
+	if (ClosestTrial != INDEX_NONE)
+	{
+		FinishReactionTrial(ClosestTrial, FireSeconds);
+	}
+}
+
+void UAimSessionRecorder::RecordTargetSpawn(AActor* Target, double SpawnSeconds)
+{
+	if (!bRecording || Target == nullptr)
+	{
+		return;
+	}
+
+	FVector Origin, Extent;
+	Target->GetActorBounds(true, Origin, Extent);
+
+	FReactionTrial& Trial = ReactionTrials[ReactionTrials.AddDefaulted()];
+	Trial.Target = Target;
+	Trial.LocalCenter = Target->GetActorTransform().InverseTransformPosition(Origin);
+	Trial.Radius = Extent.Size();
+	Trial.SpawnSeconds = SpawnSeconds;
+	Trial.MoveSeconds = 0.0;
+	Trial.AcquireSeconds = 0.0;
+	Trial.LastCenter = Origin;
+	Trial.bHasLastCenter = false;
+
+	// every trial starts the shadows from where the player actually is
+	OpenShadowWindow();
+}
+
+void UAimSessionRecorder::RecordLookMovement(double SampleSeconds)
+{
+	for (FReactionTrial& Trial : ReactionTrials)
+	{
+		if (Trial.MoveSeconds == 0.0 && SampleSeconds >= Trial.SpawnSeconds)
+		{
+			Trial.MoveSeconds = SampleSeconds;
+		}
+	}
+}
+
+void UAimSessionRecorder::UpdateReactionTrials(const FVector& CameraLocation, const FRotator& CameraRotation, double Seconds)
+{
+	const FQuat Rotation = CameraRotation.Quaternion();
+	const FVector Direction = Rotation.GetForwardVector();
+
+	for (int32 Index = ReactionTrials.Num() - 1; Index >= 0; --Index)
+	{
+		FReactionTrial& Trial = ReactionTrials[Index];
+		const AActor* Target = Trial.Target.Get();
+		if (Target == nullptr)
+		{
+			// gone before anyone shot at it, there's no reaction to measure
+			ReactionTrials.RemoveAtSwap(Index);
+			if (ReactionTrials.Num() == 0)
+			{
+				CloseShadowWindow();
+			}
+			continue;
+		}
+
+		const FVector Center = Target->GetActorTransform().TransformPosition(Trial.LocalCenter);
+		if (Trial.AcquireSeconds == 0.0 && FTrackingScoreBatch::ComputeMargin(CameraLocation, Direction, Center, Trial.Radius) <= 0.f)
+		{
+			if (bHasLastCamera && Trial.bHasLastCenter)
+			{
+				const double Crossing = AimSessionRecorder::SolveCrossing(LastCameraLocation, LastCameraRotation, Trial.LastCenter, LastCameraSeconds,
+					CameraLocation, Rotation, Center, Seconds, Trial.Radius);
+				Trial.AcquireSeconds = FMath::Max(Crossing, Trial.SpawnSeconds);
+			}
+			else
+			{
+				// on target the first time it was seen
+				Trial.AcquireSeconds = FMath::Max(Seconds, Trial.SpawnSeconds);
+			}
+		}
+
+		Trial.LastCenter = Center;
+		Trial.bHasLastCenter = true;
+	}
+
+	LastCameraLocation = CameraLocation;
+	LastCameraRotation = Rotation;
+	LastCameraSeconds = Seconds;
+	bHasLastCamera = true;
+}
+
+void UAimSessionRecorder::FinishReactionTrial(int32 TrialIndex, double FireSeconds)
+{
+	const FReactionTrial& Trial = ReactionTrials[TrialIndex];
+	const double MoveTime = Trial.MoveSeconds > 0.0 ? Trial.MoveSeconds - Trial.SpawnSeconds : -1.0;
+	const double AcquireTime = Trial.AcquireSeconds > 0.0 ? Trial.AcquireSeconds - Trial.SpawnSeconds : -1.0;
+	const double FireTime = FireSeconds - Trial.SpawnSeconds;
+
+	Session->ReactionMoveTime.Add(MoveTime);
+	Session->ReactionAcquireTime.Add(AcquireTime);
+	Session->ReactionFireTime.Add(FireTime);
+
+	UE_LOG(LogAimSessionRecorder, Log, TEXT("Reaction: moved %.6f s, on target %.6f s, fired %.6f s after the spawn"), MoveTime, AcquireTime, FireTime);
+
+	ReactionTrials.RemoveAtSwap(TrialIndex);
+	if (ReactionTrials.Num() == 0)
+	{
+		CloseShadowWindow();
+	}
+}
+
+float UAimSessionRecorder::GetMeanReactionTime() const
+{
+	return Session.IsValid() ? AimSessionRecorder::MeanOfValid(Session->ReactionMoveTime) : 0.f;
+}
+
+float UAimSessionRecorder::GetMeanAcquireTime() const
+{
+	return Session.IsValid() ? AimSessionRecorder::MeanOfValid(Session->ReactionAcquireTime) : 0.f;
+}
+
+bool UAimSessionRecorder::FindAimError(const FVector& CameraLocation, const FRotator& CameraRotation, float& OutErrorYaw, float& OutErrorPitch) const
+{
+	const AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode());
+	if (GameMode == nullptr)
+	{
+		return false;
+	}
+
+	// the closest target to the crosshair is the one the player is going for
+	const FVector Forward = CameraRotation.Vector();
+	const AActor* ClosestTarget = nullptr;
+	float ClosestDot = -2.f;
+	for (const AActor* Target : GameMode->GetLiveTargets())
+	{
+		const float Dot = FVector::DotProduct(Forward, (Target->GetActorLocation() - CameraLocation).GetSafeNormal());
+		if (Dot > ClosestDot)
+		{
+			ClosestDot = Dot;
+			ClosestTarget = Target;
+		}
+	}
+
+	if (ClosestTarget == nullptr)
+	{
+		return false;
+	}
+
+	const FRotator TargetRotation = (ClosestTarget->GetActorLocation() - CameraLocation).Rotation();
+	const FRotator Error = (CameraRotation - TargetRotation).GetNormalized();
+	OutErrorYaw = Error.Yaw;
+	OutErrorPitch = Error.Pitch;
+	return true;
+}
+
+void UAimSessionRecorder::BuildHeatmaps()
+{
+	EndSession();
+
+	TSharedPtr<FAimSessionData, ESPMode::ThreadSafe> Data = Session;
+	TWeakObjectPtr<UAimSessionRecorder> WeakThis(this);
+	const float Range = HeatmapRange;
+	const int32 Resolution = HeatmapResolution;
+	const float FlickThreshold = FlickSpeedThreshold;
+
+	// Binning cost grows with the session, keep all of it off the game thread
+	Async<void>(EAsyncExecution::ThreadPool, [WeakThis, Data, Range, Resolution, FlickThreshold]()
+	{
+		HOFFMANNMEHAT_LLM_SCOPE(Analytics);
+
+		TSharedRef<FAimHeatmapResult, ESPMode::ThreadSafe> Result = MakeShared<FAimHeatmapResult, ESPMode::ThreadSafe>(FAimHeatmapBuilder::Build(*Data, Range, Resolution, FlickThreshold));
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Result]()
+		{
+			if (UAimSessionRecorder* Recorder = WeakThis.Get())
+			{
+				UTexture2D* ShotHeatmap = FAimHeatmapBuilder::CreateTexture(Result->ShotPixels, Result->Resolution);
+				UTexture2D* FlickHeatmap = FAimHeatmapBuilder::CreateTexture(Result->FlickPixels, Result->Resolution);
+				Recorder->OnHeatmapsReady.Broadcast(ShotHeatmap, FlickHeatmap);
+			}
+		});
+	});
+}
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AimSessionRecorder.generated.h"
+
+class UTexture2D;
+
+/**
+ * Everything recorded about the crosshair during one session, stored as parallel arrays
+ * so the heatmap pass can read it with vector loads.
+ */
+struct FAimSessionData
+{
+	/** Seconds since the session started, one entry per recorded frame */
+	TArray<float> FrameTime;
+
+	/** Camera yaw/pitch for each recorded frame (deg) */
+	TArray<float> FrameYaw;
+	TArray<float> FramePitch;
+
+	/** Crosshair minus closest target direction for each recorded frame (deg) */
+	TArray<float> FrameErrorYaw;
+	TArray<float> FrameErrorPitch;
+
+	/** Crosshair minus closest target direction at the moment of each shot (deg) */
+	TArray<float> ShotErrorYaw;
+	TArray<float> ShotErrorPitch;
+
+	/**
+	 * One entry per target from its spawn to the first shot after it, relative to the spawn (s).
+	 * Kept in double for microsecond resolution, negative where the event never happened.
+	 */
+	TArray<double> ReactionMoveTime;
+	TArray<double> ReactionAcquireTime;
+	TArray<double> ReactionFireTime;
+
+	/** Curves shadowed during the session, see UAimShadowComponent */
+	TArray<FName> ShadowProfiles;
+
+	/**
+	 * View yaw/pitch each shadow profile would have reached, for each recorded frame (deg).
+	 * Frame major, ShadowProfiles.Num() entries per frame.
+	 */
+	TArray<float> ShadowFrameYaw;
+	TArray<float> ShadowFramePitch;
+
+	/**
+	 * Recorded frames [ShadowWindowStart, ShadowWindowEnd) of each stretch with reaction trials
+	 * open. The shadows restart from the real view at every target spawn, so inside these they
+	 * haven't drifted from it, and only these are scored. The last window has no end while open.
+	 */
+	TArray<int32> ShadowWindowStart;
+	TArray<int32> ShadowWindowEnd;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAimHeatmapsReady, UTexture2D*, ShotHeatmap, UTexture2D*, FlickHeatmap);
+
+/**
+ * Records the camera and shot stream of a drill against the live targets, and turns it
+ * into post-session heatmaps on a worker thread.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class HOFFMANNMEHAT_API UAimSessionRecorder : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAimSessionRecorder();
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Throws away the current recording and starts a new one */
+	UFUNCTION(BlueprintCallable, Category = "Statistics")
+	void BeginSession();
+
+	/** Stops recording. The data is kept until the next BeginSession. */
+	UFUNCTION(BlueprintCallable, Category = "Statistics")
+	void EndSession();
+
+	/** Records a shot fired along the given camera ray, ending the reaction trial of the target closest to it */
+	void RecordShot(const FVector& CameraLocation, const FRotator& CameraRotation);
+
+	/** Starts a reaction trial for a target that just spawned */
+	void RecordTargetSpawn(AActor* Target, double SpawnSeconds);
+
+	/** Notes the look stick leaving its dead zone, at the time of the stick sample */
+	void RecordLookMovement(double SampleSeconds);
+
+	/** Mean time from a target's spawn to the first stick movement (s) */
+	UFUNCTION(BlueprintPure, Category = "Statistics")
+	float GetMeanReactionTime() const;
+
+	/** Mean time from a target's spawn to the crosshair first crossing onto it (s) */
+	UFUNCTION(BlueprintPure, Category = "Statistics")
+	float GetMeanAcquireTime() const;
+
+	/**
+	 * Estimated mean crosshair error had a shadowed profile been live: each frame's error is
+	 * moved by how far the profile's view differs from the real one (deg). Only frames from a
+	 * target's spawn to the end of the reaction trials count. INDEX_NONE gives the live curve's
+	 * own mean error over the same frames for comparison.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Statistics")
+	float GetShadowMeanError(int32 Profile) const;
+
+	/** Builds the shot and flick heatmaps in the background, OnHeatmapsReady fires when done */
+	UFUNCTION(BlueprintCallable, Category = "Statistics")
+	void BuildHeatmaps();
+
+	/** Fired on the game thread once BuildHeatmaps has finished */
+	UPROPERTY(BlueprintAssignable, Category = "Statistics")
+	FOnAimHeatmapsReady OnHeatmapsReady;
+
+	/** Half width of the heatmap window around the target (deg), the heatmaps stay empty if it isn't positive */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Statistics", meta = (ClampMin = "0.1"))
+	float HeatmapRange;
+
+	/** Width and height of the heatmap textures */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Statistics")
+	int32 HeatmapResolution;
+
+	/** Angular speed above which camera motion counts as a flick (deg/sec) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Statistics")
+	float FlickSpeedThreshold;
+
+	FORCEINLINE bool IsRecording() const { return bRecording; }
+
+protected:
+	/** Finds the crosshair error to the target closest to the camera ray. Returns false if there are no targets. */
+	bool FindAimError(const FVector& CameraLocation, const FRotator& CameraRotation, float& OutErrorYaw, float& OutErrorPitch) const;
+
+	/** Camera the player sees through, the same one OnFire shoots from */
+	class APlayerCameraManager* GetCameraManager() const;
+
+	/**
+	 * Advances the reaction trials to this frame's camera. A crossing onto a target between two
+	 * frames is solved for on the interpolated camera path, so it doesn't snap to frame times.
+	 */
+	void UpdateReactionTrials(const FVector& CameraLocation, const FRotator& CameraRotation, double Seconds);
+
+	/** Logs where each shadow profile would have the view this frame */
+	void RecordShadowFrame(const FRotator& CameraRotation);
+
+	/** Gives frames before EndFrame that have no shadows the real view as every profile's */
+	void PadShadowFrames(int32 EndFrame);
+
+	/** Adds a finished trial to the session */
+	void FinishReactionTrial(int32 TrialIndex, double FireSeconds);
+
+	/** Restarts the shadows from the real view and starts a scoring window at the next frame */
+	void OpenShadowWindow();
+
+	/** Ends the scoring window, if one is open, at the current frame */
+	void CloseShadowWindow();
+
+private:
+	/** A target from its spawn until the first shot after it */
+	struct FReactionTrial
+	{
+		TWeakObjectPtr<AActor> Target;
+
+		/** Bounding sphere relative to the target, measured at spawn */
+		FVector LocalCenter;
+		float Radius;
+
+		/** FPlatformTime::Seconds() of the events, 0 until they happen */
+		double SpawnSeconds;
+		double MoveSeconds;
+		double AcquireSeconds;
+
+		/** Bounding sphere center at the last camera sample */
+		FVector LastCenter;
+		bool bHasLastCenter;
+	};
+
+	TArray<FReactionTrial> ReactionTrials;
+
+	/** The owner's shadow curves, logged with every frame if it has any */
+	UPROPERTY(Transient)
+	class UAimShadowComponent* AimShadow;
+
+	/** Camera at the previous tick, the start of the interpolated path */
+	FVector LastCameraLocation;
+	FQuat LastCameraRotation;
+	double LastCameraSeconds;
+	bool bHasLastCamera;
+
+	/** Recording in progress, handed off to the heatmap task without a copy */
+	TSharedPtr<FAimSessionData, ESPMode::ThreadSafe> Session;
+
+	float SessionStartTime;
+
+	bool bInShadowWindow;
+
+	bool bRecording;
+};
@@ -0,0 +1,264 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AimShadow.h"
+#include "AimResponseCurve.h"
+#include "HoffmannMehatStats.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimShadow, Log, All);
+
+namespace AimShadow
+{
+	/** Keeps the per sample cost to two vectors */
+	static const int32 MaxProfiles = 8;
+
+	/** Same limits as the camera manager's default view pitch */
+	static const float MaxPitch = 89.9f;
+}
+
+void FAimShadowBatch::SetProfiles(const TArray<const FAimResponseProfile*>& Profiles)
+{
+	NumProfiles = Profiles.Num();
+	NumLanes = Align(NumProfiles, 4);
+	Table.SetNumZeroed((NumSegments + 1) * NumLanes);
+
+	for (int32 Knot = 0; Knot <= NumSegments; ++Knot)
+	{
+		const float Rate = Knot * 100.f / NumSegments;
+		for (int32 Profile = 0; Profile < NumProfiles; ++Profile)
+		{
+			Table[Knot * NumLanes + Profile] = Profiles[Profile]->Evaluate(Rate);
+		}
+	}
+}
+
+void FAimShadowBatch::EvaluateStick(float Stick, float DeadZone, float* OutRates) const
+{
+	// the dead zone and segment are the same for every profile, only the knot values differ
+	float ActiveRange = (FMath::Abs(Stick) - DeadZone) / (1 - DeadZone);
+	ActiveRange = FMath::Clamp(ActiveRange, 0.f, 1.f);
+
+	const float Position = ActiveRange * NumSegments;
+	const int32 Segment = FMath::Min(FMath::FloorToInt(Position), NumSegments - 1);
+	const VectorRegister T = VectorSetFloat1(Position - Segment);
+	const VectorRegister Sign = VectorSetFloat1(Stick < 0 ? -1.f : 1.f);
+
+	const float* Low = Table.GetData() + Segment * NumLanes;
+	const float* High = Low + NumLanes;
+	for (int32 Lane = 0; Lane < NumLanes; Lane += 4)
+	{
+		const VectorRegister A = VectorLoad(Low + Lane);
+		const VectorRegister B = VectorLoad(High + Lane);
+		VectorStore(VectorMultiply(VectorMultiplyAdd(T, VectorSubtract(B, A), A), Sign), OutRates + Lane);
+	}
+}
+
+UAimShadowComponent::UAimShadowComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	ProfileNames.Add(TEXT("Linear"));
+	ProfileNames.Add(TEXT("Squared"));
+	ProfileNames.Add(TEXT("Cubed"));
+	bShadowEnabled = true;
+	bHasRotations = false;
+	bSyncTurnAxes = true;
+	bSyncLookUpAxes = true;
+}
+
+void UAimShadowComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ResolvedProfiles.Reset();
+	ResolvedNames.Reset();
+	for (FName Name : ProfileNames)
+	{
+		const FAimResponseProfile* Profile = FAimResponseProfile::FindBuiltInProfile(Name);
+		if (Profile == nullptr)
+		{
+			UE_LOG(LogAimShadow, Warning, TEXT("There is no response profile called %s"), *Name.ToString());
+		}
+		else if (ResolvedProfiles.Num() >= AimShadow::MaxProfiles)
+		{
+			UE_LOG(LogAimShadow, Warning, TEXT("Only %d profiles can be shadowed, %s is left out"), AimShadow::MaxProfiles, *Name.ToString());
+		}
+		else
+		{
+			ResolvedProfiles.Add(Profile);
+			ResolvedNames.Add(Name);
+		}
+	}
+
+	Batch.SetProfiles(ResolvedProfiles);
+	Rates.SetNumZeroed(Batch.GetNumLanes());
+	ShadowYaw.SetNumZeroed(Batch.GetNumLanes());
+	ShadowPitch.SetNumZeroed(Batch.GetNumLanes());
+	TurnAxes.SetNum(ResolvedProfiles.Num());
+	LookUpAxes.SetNum(ResolvedProfiles.Num());
+	ResetShadows();
+}
+
+void UAimShadowComponent::ResetShadows()
+{
+	bHasRotations = false;
+	bSyncTurnAxes = true;
+	bSyncLookUpAxes = true;
+}
+
+bool UAimShadowComponent::EnsureShadowRotations()
+{
+	if (bHasRotations)
+	{
+		return true;
+	}
+
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	if (Pawn == nullptr || Pawn->GetController() == nullptr)
+	{
+		return false;
+	}
+
+	const FRotator Rotation = Pawn->GetControlRotation().GetNormalized();
+	for (int32 Lane = 0; Lane < ShadowYaw.Num(); ++Lane)
+	{
+		ShadowYaw[Lane] = Rotation.Yaw;
+		ShadowPitch[Lane] = Rotation.Pitch;
+	}
+	bHasRotations = true;
+	return true;
+}
+
+void UAimShadowComponent::Accumulate(float Stick, float DeadZone, float Scale, TArray<float>& Angles)
+{
+	Batch.EvaluateStick(Stick, DeadZone, Rates.GetData());
+
+	const VectorRegister VScale = VectorSetFloat1(Scale);
+	for (int32 Lane = 0; Lane < Angles.Num(); Lane += 4)
+	{
+		VectorStore(VectorMultiplyAdd(VectorLoad(Rates.GetData() + Lane), VScale, VectorLoad(Angles.GetData() + Lane)), Angles.GetData() + Lane);
+	}
+}
+
+float UAimShadowComponent::GetInputScale(bool bYaw) const
+{
+	// the controller scales input the same way for the live view
+	const APlayerController* Controller = Cast<APlayerController>(Cast<APawn>(GetOwner())->GetController());
+	if (Controller == nullptr)
+	{
+		return 1.f;
+	}
+	return bYaw ? Controller->InputYawScale : Controller->InputPitchScale;
+}
+
+void UAimShadowComponent::ClampPitch()
+{
+	for (int32 Profile = 0; Profile < GetNumProfiles(); ++Profile)
+	{
+		ShadowPitch[Profile] = FMath::Clamp(ShadowPitch[Profile], -AimShadow::MaxPitch, AimShadow::MaxPitch);
+	}
+}
+
+void UAimShadowComponent::AddTurnSample(float Stick, float DeadZone, float DegreesPerRate)
+{
+	HOFFMANNMEHAT_SCOPE(AimShadow);
+
+	if (!IsShadowEnabled() || !EnsureShadowRotations())
+	{
+		return;
+	}
+
+	Accumulate(Stick, DeadZone, DegreesPerRate * GetInputScale(true), ShadowYaw);
+}
+
+void UAimShadowComponent::AddLookUpSample(float Stick, float DeadZone, float DegreesPerRate)
+{
+	HOFFMANNMEHAT_SCOPE(AimShadow);
+
+	if (!IsShadowEnabled() || !EnsureShadowRotations())
+	{
+		return;
+	}
+
+	Accumulate(Stick, DeadZone, DegreesPerRate * GetInputScale(false), ShadowPitch);
+	ClampPitch();
+}
+
+void UAimShadowComponent::AdvanceAxes(TArray<FFixedStepAimAxis>& Axes, bool& bSyncAxes, const FFixedStepAimAxis& LiveAxis, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber, float Scale, TArray<float>& Angles)
+{
+	// same accumulated time, substep phase and stick history as the real view
+	if (bSyncAxes)
+	{
+		for (FFixedStepAimAxis& Axis : Axes)
+		{
+			Axis = LiveAxis;
+		}
+		bSyncAxes = false;
+	}
+
+	// each axis only evaluates its curve when the substep's stick changes, so no batch here
+	for (int32 Profile = 0; Profile < Axes.Num(); ++Profile)
+	{
+		const FAimResponseProfile* ResponseProfile = ResolvedProfiles[Profile];
+		const float Degrees = Axes[Profile].Advance([ResponseProfile](float InStick, float InDeadZone)
+		{
+			return ResponseProfile->EvaluateStick(InStick, InDeadZone);
+		}, Stick, DeadZone, DegreesPerSecond, DeltaSeconds, StepSeconds, MaxSubsteps, FrameNumber);
+		Angles[Profile] += Degrees * Scale;
+	}
+}
+
+void UAimShadowComponent::AddTurnSample(const FFixedStepAimAxis& LiveAxis, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber)
+{
+	HOFFMANNMEHAT_SCOPE(AimShadow);
+
+	if (!IsShadowEnabled() || !EnsureShadowRotations())
+	{
+		return;
+	}
+
+	AdvanceAxes(TurnAxes, bSyncTurnAxes, LiveAxis, Stick, DeadZone, DegreesPerSecond, DeltaSeconds, StepSeconds, MaxSubsteps, FrameNumber, GetInputScale(true), ShadowYaw);
+}
+
+void UAimShadowComponent::AddLookUpSample(const FFixedStepAimAxis& LiveAxis, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber)
+{
+	HOFFMANNMEHAT_SCOPE(AimShadow);
+
+	if (!IsShadowEnabled() || !EnsureShadowRotations())
+	{
+		return;
+	}
+
+	AdvanceAxes(LookUpAxes, bSyncLookUpAxes, LiveAxis, Stick, DeadZone, DegreesPerSecond, DeltaSeconds, StepSeconds, MaxSubsteps, FrameNumber, GetInputScale(false), ShadowPitch);
+	ClampPitch();
+}
+
+void UAimShadowComponent::AddTurnInput(float Input)
+{
+	if (Input == 0.f || !IsShadowEnabled() || !EnsureShadowRotations())
+	{
+		return;
+	}
+
+	const float Degrees = Input * GetInputScale(true);
+	for (int32 Profile = 0; Profile < GetNumProfiles(); ++Profile)
+	{
+		ShadowYaw[Profile] += Degrees;
+	}
+}
+
+void UAimShadowComponent::AddLookUpInput(float Input)
+{
+	if (Input == 0.f || !IsShadowEnabled() || !EnsureShadowRotations())
+	{
+		return;
+	}
+
+	const float Degrees = Input * GetInputScale(false);
+	for (int32 Profile = 0; Profile < GetNumProfiles(); ++Profile)
+	{
+		ShadowPitch[Profile] += Degrees;
+	}
+	ClampPitch();
+}
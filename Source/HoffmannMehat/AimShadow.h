@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AimSimulation.h"
+#include "AimShadow.generated.h"
+
+struct FAimResponseProfile;
+
+/**
+ * Response curves resampled onto one uniform grid of knots. Every profile then shares the
+ * segment a stick value falls in, so a sample evaluates all of them four lanes at a time.
+ */
+struct HOFFMANNMEHAT_API FAimShadowBatch
+{
+	/** Grid segments over [0, 100] percent, fine enough that resampling the built-in curves is invisible */
+	static const int32 NumSegments = 256;
+
+	void SetProfiles(const TArray<const FAimResponseProfile*>& Profiles);
+
+	int32 GetNumProfiles() const { return NumProfiles; }
+
+	/** NumProfiles rounded up to a whole vector */
+	int32 GetNumLanes() const { return NumLanes; }
+
+	/** Same contract as FAimResponseProfile::EvaluateStick, writes GetNumLanes() rates */
+	void EvaluateStick(float Stick, float DeadZone, float* OutRates) const;
+
+private:
+	int32 NumProfiles = 0;
+	int32 NumLanes = 0;
+
+	/** Output at each knot for each profile, knot major, NumLanes per knot */
+	TArray<float> Table;
+};
+
+/**
+ * Shadow evaluation of alternative response curves during live play. Each look sample the owner
+ * feeds in is also run through every shadow profile, and the rotation each one would have
+ * reached is integrated next to the real one without touching the camera. Mouse look skips the
+ * curves, so it moves every shadow like the real view. The session recorder restarts the
+ * shadows from the real view at each target spawn and logs them with every frame.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class HOFFMANNMEHAT_API UAimShadowComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAimShadowComponent();
+
+	virtual void BeginPlay() override;
+
+	/** Forgets the shadow rotations, they restart from the owner's control rotation at the next sample */
+	UFUNCTION(BlueprintCallable, Category = "Aiming")
+	void ResetShadows();
+
+	/**
+	 * One turn sample, with the same stick, dead zone and frame as the live curve
+	 * @param DegreesPerRate	Yaw input a normalized rate of 1 gives this sample, e.g. BaseTurnRate * DeltaSeconds
+	 */
+	void AddTurnSample(float Stick, float DeadZone, float DegreesPerRate);
+
+	/** Same as AddTurnSample for look up/down */
+	void AddLookUpSample(float Stick, float DeadZone, float DegreesPerRate);
+
+	/**
+	 * One turn sample for a view that integrates at a fixed rate. Every profile gets its own
+	 * axis, advanced with the same arguments as the live one, so the shadow of the live profile
+	 * stays on the real view.
+	 * @param LiveAxis	The live axis before this sample's Advance, the shadows' axes start from it after a reset
+	 */
+	void AddTurnSample(const FFixedStepAimAxis& LiveAxis, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber);
+
+	/** Same as the fixed step AddTurnSample for look up/down */
+	void AddLookUpSample(const FFixedStepAimAxis& LiveAxis, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber);
+
+	/** Yaw input that bypasses the curves, e.g. the mouse, added to every shadow as it is to the view */
+	void AddTurnInput(float Input);
+
+	/** Same as AddTurnInput for pitch */
+	void AddLookUpInput(float Input);
+
+	bool IsShadowEnabled() const { return bShadowEnabled && Batch.GetNumProfiles() > 0; }
+
+	int32 GetNumProfiles() const { return Batch.GetNumProfiles(); }
+	FName GetProfileName(int32 Profile) const { return ResolvedNames[Profile]; }
+
+	/** False until the first sample after a reset */
+	bool HasShadowRotations() const { return bHasRotations; }
+
+	/** Rotation the view would have under a profile, roll is always 0 */
+	FRotator GetShadowRotation(int32 Profile) const { return FRotator(ShadowPitch[Profile], ShadowYaw[Profile], 0.f); }
+
+	/** Built-in profiles to shadow, see FAimResponseProfile::GetBuiltInProfiles, at most 8 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aiming")
+	TArray<FName> ProfileNames;
+
+	/** Cheap enough to leave on in every session */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Aiming")
+	bool bShadowEnabled;
+
+protected:
+	/** Starts the shadows from the owner's control rotation, returns false if there's no controller yet */
+	bool EnsureShadowRotations();
+
+	/** Adds every profile's rate times Scale to Angles */
+	void Accumulate(float Stick, float DeadZone, float Scale, TArray<float>& Angles);
+
+	/** The owner's controller's InputYawScale or InputPitchScale, 1 without one */
+	float GetInputScale(bool bYaw) const;
+
+	/** Keeps the shadow pitches inside the view's limits */
+	void ClampPitch();
+
+	/** Advances every profile's axis and adds the result times Scale to Angles */
+	void AdvanceAxes(TArray<FFixedStepAimAxis>& Axes, bool& bSyncAxes, const FFixedStepAimAxis& LiveAxis, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber, float Scale, TArray<float>& Angles);
+
+private:
+	FAimShadowBatch Batch;
+	TArray<FName> ResolvedNames;
+	TArray<const FAimResponseProfile*> ResolvedProfiles;
+
+	/** Fixed step integration by profile, copied from the live axes after a reset */
+	TArray<FFixedStepAimAxis> TurnAxes;
+	TArray<FFixedStepAimAxis> LookUpAxes;
+	bool bSyncTurnAxes;
+	bool bSyncLookUpAxes;
+
+	/** By profile, padded to the batch's lanes */
+	TArray<float> Rates;
+	TArray<float> ShadowYaw;
+	TArray<float> ShadowPitch;
+
+	bool bHasRotations;
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AimSimulation.h"
+
+FFixedStepAimAxis::FFixedStepAimAxis()
+{
+	Reset();
+}
+
+void FFixedStepAimAxis::Reset()
+{
+	Accumulator = 0.f;
+	Previous = 0.f;
+	Current = 0.f;
+	PreviousStick = 0.f;
+	EvaluatedStick = 0.f;
+	EvaluatedRate = 0.f;
+	bHasEvaluated = false;
+	LastFrameNumber = MAX_uint64;
+	LastNumSubsteps = 0;
+}
+
+float FFixedStepAimAxis::Advance(FAimAxisCurve Curve, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber)
+{
+	// the frame's time was already simulated, a fresher stick only moves where the next frame starts from
+	if (FrameNumber == LastFrameNumber)
+	{
+		PreviousStick = Stick;
+		return 0.f;
+	}
+	LastFrameNumber = FrameNumber;
+
+	// substeps first use up the time left over from the previous frame
+	const float CarriedSeconds = Accumulator;
+	Accumulator += DeltaSeconds;
+
+	int32 NumSubsteps = FMath::FloorToInt(Accumulator / StepSeconds);
+	if (NumSubsteps > MaxSubsteps)
+	{
+		NumSubsteps = MaxSubsteps;
+		Accumulator = NumSubsteps * StepSeconds;
+	}
+
+	for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
+	{
+		// the stick moves from last frame's sample to this one's over the frame
+		const float StickAlpha = DeltaSeconds > 0.f ? FMath::Clamp(((Substep + 1) * StepSeconds - CarriedSeconds) / DeltaSeconds, 0.f, 1.f) : 1.f;
+		const float SubstepStick = FMath::Lerp(PreviousStick, Stick, StickAlpha);
+		if (!bHasEvaluated || SubstepStick != EvaluatedStick)
+		{
+			EvaluatedStick = SubstepStick;
+			EvaluatedRate = Curve(SubstepStick, DeadZone);
+			bHasEvaluated = true;
+		}
+
+		Previous = Current;
+		Current += EvaluatedRate * DegreesPerSecond * StepSeconds;
+	}
+	Accumulator -= NumSubsteps * StepSeconds;
+	LastNumSubsteps = NumSubsteps;
+	PreviousStick = Stick;
+
+	// the frame sits somewhere between the last two substeps
+	const float Alpha = FMath::Clamp(Accumulator / StepSeconds, 0.f, 1.f);
+	const float Rendered = FMath::Lerp(Previous, Current, Alpha);
+
+	Previous -= Rendered;
+	Current -= Rendered;
+	return Rendered;
+}
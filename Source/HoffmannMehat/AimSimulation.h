@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Response curve of one look axis, e.g. EvaluateTurnRate or a profile's EvaluateStick */
+typedef TFunctionRef<float(float Stick, float DeadZone)> FAimAxisCurve;
+
+/**
+ * One look axis integrated at a fixed rate. Real time is accumulated and the look pipeline
+ * (dead zone, response curve, rate) runs once per whole substep, with the stick interpolated
+ * between the previous frame's sample and this one's, so the same stick motion turns the
+ * camera the same amount at any frame rate. The curve is only evaluated again when a substep's
+ * stick value differs from the last one. The frame reads the rotation interpolated between the
+ * last two substeps.
+ */
+struct FFixedStepAimAxis
+{
+	FFixedStepAimAxis();
+
+	/**
+	 * Runs every substep that fits in the accumulated time, once per frame
+	 * @param Stick				Raw stick value at the end of the frame
+	 * @param DeltaSeconds		Length of the frame
+	 * @param StepSeconds		Length of a substep
+	 * @param MaxSubsteps		Time beyond this many substeps is dropped, so a hitch can't jump the camera
+	 * @param FrameNumber		GFrameCounter, further calls in the same frame return 0 and only update the stick
+	 * @returns the rotation to apply this frame (deg)
+	 */
+	float Advance(FAimAxisCurve Curve, float Stick, float DeadZone, float DegreesPerSecond, float DeltaSeconds, float StepSeconds, int32 MaxSubsteps, uint64 FrameNumber);
+
+	/** Forgets accumulated time and rotation */
+	void Reset();
+
+	/** Substeps run by the last Advance */
+	int32 GetLastNumSubsteps() const { return LastNumSubsteps; }
+
+private:
+	/** Time not yet simulated (s) */
+	float Accumulator;
+
+	/**
+	 * Rotation at the previous and latest substep (deg), relative to what has been applied
+	 * to the controller so far so they never grow large
+	 */
+	float Previous;
+	float Current;
+
+	/** Stick at the end of the previous frame, this frame's substeps start from it */
+	float PreviousStick;
+
+	/** Last stick value the curve was evaluated for and its rate */
+	float EvaluatedStick;
+	float EvaluatedRate;
+	bool bHasEvaluated;
+
+	/** Frame of the last Advance */
+	uint64 LastFrameNumber;
+
+	int32 LastNumSubsteps;
+};
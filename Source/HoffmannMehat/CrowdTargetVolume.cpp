@@ -0,0 +1,505 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CrowdTargetVolume.h"
+#include "HoffmannMehatGameMode.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatStats.h"
+#include "TheFirstActor.h"
+#include "Async/ParallelFor.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NavigationSystem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCrowdTargets, Log, All);
+
+namespace CrowdTargets
+{
+	static TAutoConsoleVariable<int32> CVarParallel(
+		TEXT("HoffmannMehat.CrowdParallel"),
+		1,
+		TEXT("Steer crowd targets on the task graph (1) or on the game thread (0)."),
+		ECVF_Default);
+
+	/** Keeps the fields small enough to rebuild in a frame or two */
+	static const int32 MaxCellsPerSide = 256;
+
+	/** Neighbours in link bit order, the first four are straight, the rest diagonal */
+	static const int32 NeighbourX[8] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+	static const int32 NeighbourY[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+	/** Index of the opposite direction */
+	static const int32 Opposite[8] = { 2, 3, 0, 1, 6, 7, 4, 5 };
+
+	/** A diagonal link also needs both straight links next to it, so agents don't cut corners */
+	static const int32 DiagonalSides[8][2] = { {}, {}, {}, {}, { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+
+	struct FOpenCell
+	{
+		float Cost;
+		int32 Cell;
+
+		bool operator<(const FOpenCell& Other) const { return Cost < Other.Cost; }
+	};
+}
+
+ACrowdTargetVolume::ACrowdTargetVolume()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	Arena = CreateDefaultSubobject<UBoxComponent>(TEXT("Arena"));
+	Arena->InitBoxExtent(FVector(1000.f, 1000.f, 200.f));
+	Arena->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RootComponent = Arena;
+
+	AgentClass = ATheFirstActor::StaticClass();
+	NumAgents = 200;
+	GoalPoints.Add(FVector(0.f, -800.f, 0.f));
+	GoalPoints.Add(FVector(0.f, 800.f, 0.f));
+	GoalInterval = 3.f;
+	CellSize = 100.f;
+	SeparationRadius = 80.f;
+	SeparationStrength = 1.f;
+	MaxSpeed = 400.f;
+	Responsiveness = 6.f;
+	ArriveRadius = 200.f;
+	AgentHeight = 90.f;
+
+	GridOrigin = FVector::ZeroVector;
+	NumCellsX = 0;
+	NumCellsY = 0;
+	CurrentGoal = 0;
+	GoalSeconds = 0.f;
+}
+
+void ACrowdTargetVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	HOFFMANNMEHAT_LLM_SCOPE(Targets);
+
+	BuildFlowFields();
+	SetNumAgents(NumAgents);
+}
+
+void ACrowdTargetVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// the agents go down with the level otherwise
+	if (EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		SetNumAgents(0);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+int32 ACrowdTargetVolume::GetCell(const FVector& Location) const
+{
+	const int32 X = FMath::FloorToInt((Location.X - GridOrigin.X) / CellSize);
+	const int32 Y = FMath::FloorToInt((Location.Y - GridOrigin.Y) / CellSize);
+	if (X < 0 || Y < 0 || X >= NumCellsX || Y >= NumCellsY)
+	{
+		return INDEX_NONE;
+	}
+	return Y * NumCellsX + X;
+}
+
+FVector ACrowdTargetVolume::GetCellCenter(int32 Cell) const
+{
+	const int32 X = Cell % NumCellsX;
+	const int32 Y = Cell / NumCellsX;
+	return FVector(GridOrigin.X + (X + 0.5f) * CellSize, GridOrigin.Y + (Y + 0.5f) * CellSize, CellHeights[Cell]);
+}
+
+void ACrowdTargetVolume::BuildFlowFields()
+{
+	const FBox Box = Arena->Bounds.GetBox();
+	const FVector Size = Box.GetSize();
+
+	GridOrigin = Box.Min;
+	NumCellsX = FMath::Clamp(FMath::CeilToInt(Size.X / CellSize), 1, CrowdTargets::MaxCellsPerSide);
+	NumCellsY = FMath::Clamp(FMath::CeilToInt(Size.Y / CellSize), 1, CrowdTargets::MaxCellsPerSide);
+	const int32 NumCells = NumCellsX * NumCellsY;
+
+	CellHeights.Init(Box.Min.Z, NumCells);
+	CellWalkable.Init(false, NumCells);
+	CellLinks.Init(0, NumCells);
+	CellFirstAgent.Init(INDEX_NONE, NumCells);
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavSys == nullptr)
+	{
+		UE_LOG(LogCrowdTargets, Warning, TEXT("%s: no navigation system, the whole arena is taken as flat floor"), *GetName());
+	}
+
+	// cell centers dropped onto the navmesh
+	const FVector QueryExtent(CellSize * 0.5f, CellSize * 0.5f, Box.GetExtent().Z);
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		const FVector Center(GridOrigin.X + (Cell % NumCellsX + 0.5f) * CellSize, GridOrigin.Y + (Cell / NumCellsX + 0.5f) * CellSize, Box.GetCenter().Z);
+
+		FNavLocation Projected;
+		if (NavSys == nullptr)
+		{
+			CellWalkable[Cell] = true;
+		}
+		else if (NavSys->ProjectPointToNavigation(Center, Projected, QueryExtent))
+		{
+			CellWalkable[Cell] = true;
+			CellHeights[Cell] = Projected.Location.Z;
+		}
+	}
+
+	// a straight link is walkable if the navmesh raycast between the centers is clear
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		if (!CellWalkable[Cell])
+		{
+			continue;
+		}
+
+		const int32 X = Cell % NumCellsX;
+		const int32 Y = Cell / NumCellsX;
+		for (int32 Direction = 0; Direction < 2; ++Direction)
+		{
+			const int32 NX = X + CrowdTargets::NeighbourX[Direction];
+			const int32 NY = Y + CrowdTargets::NeighbourY[Direction];
+			const int32 Neighbour = NY * NumCellsX + NX;
+			if (NX >= NumCellsX || NY >= NumCellsY || !CellWalkable[Neighbour])
+			{
+				continue;
+			}
+
+			FVector HitLocation;
+			if (NavSys == nullptr || !UNavigationSystemV1::NavigationRaycast(this, GetCellCenter(Cell), GetCellCenter(Neighbour), HitLocation))
+			{
+				CellLinks[Cell] |= 1 << Direction;
+				CellLinks[Neighbour] |= 1 << CrowdTargets::Opposite[Direction];
+			}
+		}
+	}
+
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		for (int32 Direction = 4; Direction < 8; ++Direction)
+		{
+			const int32 SideA = CrowdTargets::DiagonalSides[Direction][0];
+			const int32 SideB = CrowdTargets::DiagonalSides[Direction][1];
+			if ((CellLinks[Cell] & (1 << SideA)) == 0 || (CellLinks[Cell] & (1 << SideB)) == 0)
+			{
+				continue;
+			}
+
+			// both ways around the corner have to be open too
+			const int32 CellA = Cell + CrowdTargets::NeighbourX[SideA] + CrowdTargets::NeighbourY[SideA] * NumCellsX;
+			const int32 CellB = Cell + CrowdTargets::NeighbourX[SideB] + CrowdTargets::NeighbourY[SideB] * NumCellsX;
+			if ((CellLinks[CellA] & (1 << SideB)) != 0 && (CellLinks[CellB] & (1 << SideA)) != 0)
+			{
+				CellLinks[Cell] |= 1 << Direction;
+			}
+		}
+	}
+
+	FlowFields.SetNum(GoalPoints.Num());
+	for (int32 Goal = 0; Goal < GoalPoints.Num(); ++Goal)
+	{
+		BuildFlowField(GetActorTransform().TransformPosition(GoalPoints[Goal]), FlowFields[Goal]);
+	}
+
+	CurrentGoal = 0;
+	GoalSeconds = 0.f;
+
+	UE_LOG(LogCrowdTargets, Log, TEXT("%s: %d x %d cells, %d flow fields"), *GetName(), NumCellsX, NumCellsY, FlowFields.Num());
+}
+
+void ACrowdTargetVolume::BuildFlowField(const FVector& Goal, TArray<FVector2D>& OutDirections) const
+{
+	const int32 NumCells = NumCellsX * NumCellsY;
+	OutDirections.Init(FVector2D::ZeroVector, NumCells);
+
+	const int32 GoalCell = GetCell(FVector(Goal.X, Goal.Y, 0.f));
+	if (GoalCell == INDEX_NONE || !CellWalkable[GoalCell])
+	{
+		UE_LOG(LogCrowdTargets, Warning, TEXT("%s: goal %s isn't on the arena's navmesh"), *GetName(), *Goal.ToString());
+		return;
+	}
+
+	// Dijkstra from the goal, diagonals cost sqrt 2
+	TArray<float> Costs;
+	Costs.Init(MAX_flt, NumCells);
+	Costs[GoalCell] = 0.f;
+
+	TArray<CrowdTargets::FOpenCell> Open;
+	Open.HeapPush(CrowdTargets::FOpenCell{ 0.f, GoalCell });
+	while (Open.Num() > 0)
+	{
+		CrowdTargets::FOpenCell Current;
+		Open.HeapPop(Current, false);
+		if (Current.Cost > Costs[Current.Cell])
+		{
+			continue;
+		}
+
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			if ((CellLinks[Current.Cell] & (1 << Direction)) == 0)
+			{
+				continue;
+			}
+
+			const int32 Neighbour = Current.Cell + CrowdTargets::NeighbourX[Direction] + CrowdTargets::NeighbourY[Direction] * NumCellsX;
+			const float Cost = Current.Cost + (Direction < 4 ? 1.f : UE_SQRT_2);
+			if (Cost < Costs[Neighbour])
+			{
+				Costs[Neighbour] = Cost;
+				Open.HeapPush(CrowdTargets::FOpenCell{ Cost, Neighbour });
+			}
+		}
+	}
+
+	// each cell points at its cheapest neighbour, the goal cell straight at the goal
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		if (Costs[Cell] == MAX_flt)
+		{
+			continue;
+		}
+
+		if (Cell == GoalCell)
+		{
+			OutDirections[Cell] = FVector2D(Goal - GetCellCenter(Cell)).GetSafeNormal();
+			continue;
+		}
+
+		int32 Best = INDEX_NONE;
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			if ((CellLinks[Cell] & (1 << Direction)) == 0)
+			{
+				continue;
+			}
+
+			const int32 Neighbour = Cell + CrowdTargets::NeighbourX[Direction] + CrowdTargets::NeighbourY[Direction] * NumCellsX;
+			if (Best == INDEX_NONE || Costs[Neighbour] < Costs[Best])
+			{
+				Best = Neighbour;
+			}
+		}
+		OutDirections[Cell] = FVector2D(GetCellCenter(Best) - GetCellCenter(Cell)).GetSafeNormal();
+	}
+}
+
+void ACrowdTargetVolume::SetGoalPoints(const TArray<FVector>& NewGoalPoints)
+{
+	GoalPoints = NewGoalPoints;
+	if (HasActorBegunPlay())
+	{
+		BuildFlowFields();
+	}
+}
+
+void ACrowdTargetVolume::SetNumAgents(int32 Count)
+{
+	HOFFMANNMEHAT_LLM_SCOPE(Targets);
+
+	AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode());
+
+	while (Agents.Num() > Count)
+	{
+		AActor* Agent = Agents.Pop(false);
+		Positions.Pop(false);
+		Velocities.Pop(false);
+		if (IsValid(Agent))
+		{
+			if (GameMode != nullptr)
+			{
+				GameMode->UnregisterTarget(Agent);
+			}
+			Agent->Destroy();
+		}
+	}
+
+	// agents start on random walkable cells
+	TArray<int32> WalkableCells;
+	for (int32 Cell = 0; Cell < CellWalkable.Num(); ++Cell)
+	{
+		if (CellWalkable[Cell])
+		{
+			WalkableCells.Add(Cell);
+		}
+	}
+
+	while (Agents.Num() < Count && WalkableCells.Num() > 0 && AgentClass != nullptr)
+	{
+		const FVector Jitter(FMath::FRandRange(-0.5f, 0.5f) * CellSize, FMath::FRandRange(-0.5f, 0.5f) * CellSize, AgentHeight);
+		const FVector Location = GetCellCenter(WalkableCells[FMath::RandHelper(WalkableCells.Num())]) + Jitter;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AActor* Agent = GetWorld()->SpawnActor<AActor>(AgentClass, Location, FRotator::ZeroRotator, SpawnParams);
+		if (Agent == nullptr)
+		{
+			break;
+		}
+
+		// the volume moves it, nothing else needs to tick
+		Agent->SetActorTickEnabled(false);
+		if (GameMode != nullptr)
+		{
+			GameMode->RegisterTarget(Agent);
+		}
+
+		Agents.Add(Agent);
+		Positions.Add(Location);
+		Velocities.Add(FVector2D::ZeroVector);
+	}
+}
+
+void ACrowdTargetVolume::StepAgents(float DeltaTime)
+{
+	const int32 Num = Agents.Num();
+	NewPositions.SetNumUninitialized(Num);
+	NewVelocities.SetNumUninitialized(Num);
+
+	// bin the agents by cell, agents off the grid don't push anyone
+	NextAgent.SetNumUninitialized(Num);
+	for (int32& First : CellFirstAgent)
+	{
+		First = INDEX_NONE;
+	}
+	for (int32 Agent = 0; Agent < Num; ++Agent)
+	{
+		const int32 Cell = GetCell(Positions[Agent]);
+		NextAgent[Agent] = Cell != INDEX_NONE ? CellFirstAgent[Cell] : INDEX_NONE;
+		if (Cell != INDEX_NONE)
+		{
+			CellFirstAgent[Cell] = Agent;
+		}
+	}
+
+	static const TArray<FVector2D> NoField;
+	const TArray<FVector2D>& Field = FlowFields.IsValidIndex(CurrentGoal) ? FlowFields[CurrentGoal] : NoField;
+	const FVector2D Goal = GoalPoints.IsValidIndex(CurrentGoal) ? FVector2D(GetActorTransform().TransformPosition(GoalPoints[CurrentGoal])) : FVector2D::ZeroVector;
+	const float Radius = FMath::Min(SeparationRadius, CellSize);
+	const float Blend = FMath::Min(Responsiveness * DeltaTime, 1.f);
+
+	auto StepAgent = [this, &Field, &Goal, Radius, Blend, DeltaTime](int32 Agent)
+	{
+		const FVector2D Position(Positions[Agent]);
+		const int32 Cell = GetCell(Positions[Agent]);
+
+		// follow the field, slowing down near the goal
+		FVector2D Desired = FVector2D::ZeroVector;
+		if (Cell != INDEX_NONE && Field.Num() > 0)
+		{
+			const float GoalDistance = FVector2D::Distance(Goal, Position);
+			Desired = Field[Cell] * MaxSpeed * FMath::Min(GoalDistance / ArriveRadius, 1.f);
+		}
+
+		// push away from anyone closer than Radius, they're all in the 3x3 cells around this one
+		FVector2D Separation = FVector2D::ZeroVector;
+		if (Cell != INDEX_NONE && Radius > 0.f)
+		{
+			const int32 X = Cell % NumCellsX;
+			const int32 Y = Cell / NumCellsX;
+			for (int32 NY = FMath::Max(Y - 1, 0); NY <= FMath::Min(Y + 1, NumCellsY - 1); ++NY)
+			{
+				for (int32 NX = FMath::Max(X - 1, 0); NX <= FMath::Min(X + 1, NumCellsX - 1); ++NX)
+				{
+					for (int32 Other = CellFirstAgent[NY * NumCellsX + NX]; Other != INDEX_NONE; Other = NextAgent[Other])
+					{
+						const FVector2D Away = Position - FVector2D(Positions[Other]);
+						const float DistanceSquared = Away.SizeSquared();
+						if (Other != Agent && DistanceSquared < Radius * Radius && DistanceSquared > KINDA_SMALL_NUMBER)
+						{
+							const float Distance = FMath::Sqrt(DistanceSquared);
+							Separation += Away / Distance * (1.f - Distance / Radius);
+						}
+					}
+				}
+			}
+		}
+
+		FVector2D Velocity = FMath::Lerp(Velocities[Agent], Desired + Separation * SeparationStrength * MaxSpeed, Blend);
+		Velocity = Velocity.GetClampedToMaxSize(MaxSpeed);
+
+		// stay on walkable cells, sliding along the edge if only one axis leaves them
+		FVector2D Next = Position + Velocity * DeltaTime;
+		int32 NextCell = GetCell(FVector(Next, 0.f));
+		if (NextCell == INDEX_NONE || !CellWalkable[NextCell])
+		{
+			const FVector2D SlideX(Next.X, Position.Y);
+			const FVector2D SlideY(Position.X, Next.Y);
+			const int32 CellX = GetCell(FVector(SlideX, 0.f));
+			const int32 CellY = GetCell(FVector(SlideY, 0.f));
+			if (CellX != INDEX_NONE && CellWalkable[CellX])
+			{
+				Next = SlideX;
+				NextCell = CellX;
+				Velocity.Y = 0.f;
+			}
+			else if (CellY != INDEX_NONE && CellWalkable[CellY])
+			{
+				Next = SlideY;
+				NextCell = CellY;
+				Velocity.X = 0.f;
+			}
+			else
+			{
+				Next = Position;
+				NextCell = Cell;
+				Velocity = FVector2D::ZeroVector;
+			}
+		}
+
+		const float Height = NextCell != INDEX_NONE ? CellHeights[NextCell] + AgentHeight : Positions[Agent].Z;
+		NewPositions[Agent] = FVector(Next, Height);
+		NewVelocities[Agent] = Velocity;
+	};
+
+	ParallelFor(Num, StepAgent, CrowdTargets::CVarParallel.GetValueOnGameThread() == 0);
+}
+
+void ACrowdTargetVolume::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	HOFFMANNMEHAT_SCOPE(CrowdUpdate);
+	HOFFMANNMEHAT_LLM_SCOPE(Targets);
+
+	// agents shot down by something else drop out
+	for (int32 Agent = Agents.Num() - 1; Agent >= 0; --Agent)
+	{
+		if (!IsValid(Agents[Agent]))
+		{
+			Agents.RemoveAtSwap(Agent, 1, false);
+			Positions.RemoveAtSwap(Agent, 1, false);
+			Velocities.RemoveAtSwap(Agent, 1, false);
+		}
+	}
+
+	if (Agents.Num() == 0 || NumCellsX == 0)
+	{
+		return;
+	}
+
+	GoalSeconds += DeltaTime;
+	if (GoalSeconds >= GoalInterval && GoalPoints.Num() > 0)
+	{
+		GoalSeconds = 0.f;
+		CurrentGoal = (CurrentGoal + 1) % GoalPoints.Num();
+	}
+
+	StepAgents(DeltaTime);
+	Swap(Positions, NewPositions);
+	Swap(Velocities, NewVelocities);
+
+	// the only part that touches the actors, on the game thread
+	for (int32 Agent = 0; Agent < Agents.Num(); ++Agent)
+	{
+		const FVector2D& Velocity = Velocities[Agent];
+		const FRotator Rotation = Velocity.IsNearlyZero() ? Agents[Agent]->GetActorRotation() : FRotator(0.f, FMath::RadiansToDegrees(FMath::Atan2(Velocity.Y, Velocity.X)), 0.f);
+		Agents[Agent]->SetActorLocationAndRotation(Positions[Agent], Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+}
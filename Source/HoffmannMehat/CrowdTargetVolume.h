@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CrowdTargetVolume.generated.h"
+
+/**
+ * Moving targets for strafing drills without an AI controller or path query per target. When
+ * play begins, the box is covered with a grid projected onto the navmesh, and a flow field
+ * towards each goal point is built from it. Every frame all agents are steered along the
+ * current goal's field, with separation from their neighbours, in one ParallelFor. Their
+ * transforms are then written back on the game thread in one pass. The goal cycles through
+ * GoalPoints, so the crowd strafes back and forth.
+ */
+UCLASS()
+class HOFFMANNMEHAT_API ACrowdTargetVolume : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACrowdTargetVolume();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+	/** Replaces the goals and rebuilds their flow fields */
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	void SetGoalPoints(const TArray<FVector>& NewGoalPoints);
+
+	/** Spawns agents until there are Count of them, or destroys the extras */
+	UFUNCTION(BlueprintCallable, Category = "Crowd")
+	void SetNumAgents(int32 Count);
+
+	UFUNCTION(BlueprintPure, Category = "Crowd")
+	int32 GetNumAgents() const { return Agents.Num(); }
+
+	FORCEINLINE class UBoxComponent* GetArena() const { return Arena; }
+
+protected:
+	/** Grid and links from the navmesh, then a flow field per goal */
+	void BuildFlowFields();
+
+	/** Distance field from Goal over the links, and the direction downhill in each cell */
+	void BuildFlowField(const FVector& Goal, TArray<FVector2D>& OutDirections) const;
+
+	/** Steers every agent in parallel into NewPositions and NewVelocities */
+	void StepAgents(float DeltaTime);
+
+	/** Cell containing Location, INDEX_NONE outside the grid */
+	int32 GetCell(const FVector& Location) const;
+	FVector GetCellCenter(int32 Cell) const;
+
+	/** Target the agents are made of, registered with the game mode like any other */
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	TSubclassOf<AActor> AgentClass;
+
+	/** Agents spawned when play begins */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0"))
+	int32 NumAgents;
+
+	/** Points the crowd moves between, relative to the volume */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (MakeEditWidget = "true"))
+	TArray<FVector> GoalPoints;
+
+	/** Time spent heading to each goal before switching to the next (s) */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0.1"))
+	float GoalInterval;
+
+	/** Side of a flow field cell (cm) */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "10"))
+	float CellSize;
+
+	/** Agents keep at least this far apart, at most CellSize (cm) */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0"))
+	float SeparationRadius;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0"))
+	float SeparationStrength;
+
+	/** (cm/s) */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0"))
+	float MaxSpeed;
+
+	/** How quickly agents turn onto the field, 1/s */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0"))
+	float Responsiveness;
+
+	/** Agents slow down within this distance of the goal (cm) */
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "1"))
+	float ArriveRadius;
+
+	/** Height of an agent's origin above the navmesh (cm) */
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	float AgentHeight;
+
+private:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Crowd", meta = (AllowPrivateAccess = "true"))
+	class UBoxComponent* Arena;
+
+	/** By agent */
+	UPROPERTY(Transient)
+	TArray<AActor*> Agents;
+
+	TArray<FVector> Positions;
+	TArray<FVector2D> Velocities;
+	TArray<FVector> NewPositions;
+	TArray<FVector2D> NewVelocities;
+
+	/** Grid over the arena, by cell */
+	FVector GridOrigin;
+	int32 NumCellsX;
+	int32 NumCellsY;
+	TArray<float> CellHeights;
+	TArray<bool> CellWalkable;
+
+	/** Bit per direction of CellNeighbours, set where an agent can walk straight to that neighbour */
+	TArray<uint8> CellLinks;
+
+	/** Flow direction in each cell, by goal then cell, zero where the goal can't be reached */
+	TArray<TArray<FVector2D>> FlowFields;
+
+	/** Agents binned by cell for the separation queries, a linked list per cell */
+	TArray<int32> CellFirstAgent;
+	TArray<int32> NextAgent;
+
+	int32 CurrentGoal;
+	float GoalSeconds;
+};
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DamageableTarget.h"
+#include "EffectPool.h"
+#include "FeedbackAudio.h"
+#include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatGameMode.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+
+ADamageableTarget::ADamageableTarget()
+{
+	// Ticks only during a hit reaction
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	MaxHealth = 100.f;
+	ScoreValue = 1;
+	DeathEffect = nullptr;
+	HitReactionScale = 1.15f;
+	HitReactionTime = 0.12f;
+
+	Health = MaxHealth;
+	RestScale = FVector(1.f);
+	HitReactionRemaining = 0.f;
+}
+
+void ADamageableTarget::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// MaxHealth may have been changed in the Blueprint defaults or the level
+	Health = MaxHealth;
+	RestScale = GetMesh()->RelativeScale3D;
+}
+
+float ADamageableTarget::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	const float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (ActualDamage <= 0.f || IsDead())
+	{
+		return 0.f;
+	}
+
+	Health = FMath::Max(Health - ActualDamage, 0.f);
+	if (IsDead())
+	{
+		Die(EventInstigator);
+		return ActualDamage;
+	}
+
+	OnDamaged.Broadcast(Health, MaxHealth);
+
+	if (HitReactionTime > 0.f)
+	{
+		HitReactionRemaining = HitReactionTime;
+		SetActorTickEnabled(true);
+	}
+	return ActualDamage;
+}
+
+void ADamageableTarget::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// the punch eases back to rest
+	HitReactionRemaining = FMath::Max(HitReactionRemaining - DeltaTime, 0.f);
+	const float Alpha = HitReactionTime > 0.f ? HitReactionRemaining / HitReactionTime : 0.f;
+	GetMesh()->SetRelativeScale3D(RestScale * FMath::Lerp(1.f, HitReactionScale, Alpha * Alpha));
+
+	if (HitReactionRemaining <= 0.f)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+void ADamageableTarget::Die(AController* Killer)
+{
+	if (AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		if (AEffectPool* Effects = GameMode->GetEffectPool())
+		{
+			Effects->PlayEffect(DeathEffect, GetActorLocation(), GetActorRotation());
+		}
+		GameMode->AddScore(ScoreValue);
+	}
+
+	const AHoffmannMehatCharacter* Shooter = Killer != nullptr ? Cast<AHoffmannMehatCharacter>(Killer->GetPawn()) : nullptr;
+	if (Shooter != nullptr)
+	{
+		Shooter->GetFeedbackAudio()->Play2D(EFeedbackSound::Kill);
+	}
+
+	OnKilled.Broadcast();
+	Release();
+}
+
+void ADamageableTarget::SetPooledActive(bool bActive)
+{
+	Super::SetPooledActive(bActive);
+
+	Health = MaxHealth;
+	HitReactionRemaining = 0.f;
+	GetMesh()->SetRelativeScale3D(RestScale);
+
+	// ticks only during a hit reaction
+	SetActorTickEnabled(false);
+}
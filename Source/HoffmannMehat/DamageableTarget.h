@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TheFirstActor.h"
+#include "DamageableTarget.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTargetDamaged, float, Health, float, MaxHealth);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTargetKilled);
+
+/**
+ * A target with health. Damage comes in through TakeDamage, from AHoffmannMehatProjectile::ApplyHit
+ * or UGameplayStatics::ApplyPointDamage for hitscan. Each hit punches the mesh's scale, and a kill
+ * plays the death effect from the game mode's effect pool, scores and releases the target.
+ */
+UCLASS()
+class HOFFMANNMEHAT_API ADamageableTarget : public ATheFirstActor
+{
+	GENERATED_BODY()
+
+public:
+	ADamageableTarget();
+
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
+	virtual void Tick(float DeltaTime) override;
+
+	/** Back to full health and rest scale when it comes out of the pool */
+	virtual void SetPooledActive(bool bActive) override;
+
+	UFUNCTION(BlueprintPure, Category = "Health")
+	float GetHealth() const { return Health; }
+
+	UFUNCTION(BlueprintPure, Category = "Health")
+	bool IsDead() const { return Health <= 0.f; }
+
+	/** Fired after every hit that didn't kill */
+	UPROPERTY(BlueprintAssignable, Category = "Health")
+	FOnTargetDamaged OnDamaged;
+
+	/** Fired once per life, just before the target is released */
+	UPROPERTY(BlueprintAssignable, Category = "Health")
+	FOnTargetKilled OnKilled;
+
+protected:
+	virtual void BeginPlay() override;
+
+	/** Effect, sound and score of a kill, then releases the target */
+	virtual void Die(AController* Killer);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health", meta = (ClampMin = "1"))
+	float MaxHealth;
+
+	/** Added to the game mode's score on a kill */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health")
+	int32 ScoreValue;
+
+	/** Played from the effect pool on a kill, the pool's default if unset */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health")
+	class UParticleSystem* DeathEffect;
+
+	/** Relative scale at the peak of a hit reaction */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health", meta = (ClampMin = "0"))
+	float HitReactionScale;
+
+	/** Time a hit reaction takes to settle (s), 0 turns them off */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Health", meta = (ClampMin = "0"))
+	float HitReactionTime;
+
+private:
+	float Health;
+
+	/** Scale the mesh goes back to after a hit */
+	FVector RestScale;
+
+	/** Time left in the current hit reaction (s) */
+	float HitReactionRemaining;
+};
@@ -0,0 +1,435 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DrillDirector.h"
+#include "AimSessionRecorder.h"
+#include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatGameInstance.h"
+#include "HoffmannMehatGameMode.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatStats.h"
+#include "TheFirstActor.h"
+#include "Async/Async.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDrillDirector, Log, All);
+
+ADrillDirector::ADrillDirector()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Drill Origin"));
+
+	Scenario = nullptr;
+	InstantiateBudgetMs = 2.f;
+
+	State = EDrillState::Idle;
+	BuildSerial = 0;
+	Elapsed = 0.f;
+	Duration = 0.f;
+	ExpiryPenalty = 0;
+	StartScore = 0;
+	StartSeconds = 0.0;
+	bGameModeBatchedProjectiles = false;
+	RunningScenario = nullptr;
+}
+
+void ADrillDirector::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (Scenario == nullptr)
+	{
+		if (const UHoffmannMehatGameInstance* GameInstance = Cast<UHoffmannMehatGameInstance>(GetGameInstance()))
+		{
+			Scenario = GameInstance->GetSelectedScenario();
+		}
+	}
+
+	if (Scenario != nullptr)
+	{
+		StartScenario(Scenario);
+	}
+}
+
+void ADrillDirector::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// drops a schedule still being built
+	++BuildSerial;
+
+	// the targets go with the level anyway, unless only the director is going
+	if (EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		for (ATheFirstActor* Target : Targets)
+		{
+			if (Target != nullptr && !Target->IsPendingKill())
+			{
+				Target->OnReleased.Unbind();
+				Target->Destroy();
+			}
+		}
+	}
+	Targets.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ADrillDirector::StartScenario(UDrillScenario* NewScenario)
+{
+	if (NewScenario == nullptr)
+	{
+		return;
+	}
+
+	StopScenario();
+
+	RunningScenario = NewScenario;
+	Volumes = NewScenario->Volumes;
+	Duration = NewScenario->Duration;
+	ExpiryPenalty = NewScenario->ExpiryPenalty;
+	StartSeconds = FPlatformTime::Seconds();
+
+	// top the pools up to what the volumes can have alive at once, every slot is free after the stop
+	TMap<UClass*, int32> Needed;
+	for (const FDrillSpawnVolume& Volume : Volumes)
+	{
+		if (Volume.TargetClass != nullptr)
+		{
+			Needed.FindOrAdd(Volume.TargetClass) += Volume.MaxAlive;
+		}
+	}
+	for (const TPair<UClass*, int32>& Pair : Needed)
+	{
+		const TArray<int32>* Free = FreeSlots.Find(Pair.Key);
+		for (int32 Count = Free != nullptr ? Free->Num() : 0; Count < Pair.Value; ++Count)
+		{
+			PendingSpawns.Add(Pair.Key);
+		}
+	}
+
+	State = EDrillState::Building;
+
+	const int32 Build = ++BuildSerial;
+	const int32 Seed = NewScenario->Seed != 0 ? NewScenario->Seed : FMath::Rand();
+	const TArray<FDrillSpawnVolume> BuildVolumes = Volumes;
+	const float BuildDuration = Duration;
+	TWeakObjectPtr<ADrillDirector> WeakThis(this);
+
+	// the layout and schedule only read plain data, the pools fill on the game thread meanwhile
+	Async<void>(EAsyncExecution::ThreadPool, [WeakThis, Build, BuildVolumes, BuildDuration, Seed]()
+	{
+		TSharedRef<FDrillSchedule, ESPMode::ThreadSafe> Result = MakeShared<FDrillSchedule, ESPMode::ThreadSafe>(FDrillSchedule::Build(BuildVolumes, BuildDuration, Seed));
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Build, Result]()
+		{
+			if (ADrillDirector* Director = WeakThis.Get())
+			{
+				Director->OnScheduleBuilt(Build, Result);
+			}
+		});
+	});
+}
+
+void ADrillDirector::StopScenario()
+{
+	++BuildSerial;
+
+	if (State == EDrillState::Running)
+	{
+		FinishScenario();
+	}
+	else if (State != EDrillState::Finished)
+	{
+		State = EDrillState::Idle;
+	}
+
+	// the next StartScenario tops the pools up, replacements included
+	PendingSpawns.Reset();
+}
+
+float ADrillDirector::GetTimeRemaining() const
+{
+	switch (State)
+	{
+	case EDrillState::Running:
+		return FMath::Max(Duration - Elapsed, 0.f);
+	case EDrillState::Finished:
+		return 0.f;
+	default:
+		return Duration;
+	}
+}
+
+void ADrillDirector::OnScheduleBuilt(int32 Build, TSharedRef<FDrillSchedule, ESPMode::ThreadSafe> NewSchedule)
+{
+	if (Build != BuildSerial || State != EDrillState::Building)
+	{
+		return;
+	}
+
+	Schedule = NewSchedule;
+	State = EDrillState::Instantiating;
+}
+
+void ADrillDirector::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	HOFFMANNMEHAT_LLM_SCOPE(Targets);
+
+	switch (State)
+	{
+	case EDrillState::Building:
+		InstantiatePools();
+		break;
+
+	case EDrillState::Instantiating:
+		InstantiatePools();
+		if (PendingSpawns.Num() == 0)
+		{
+			Elapsed = 0.f;
+			NextEvent.SetNumUninitialized(Volumes.Num());
+			AliveCount.SetNumZeroed(Volumes.Num());
+			for (int32 Volume = 0; Volume < Volumes.Num(); ++Volume)
+			{
+				NextEvent[Volume] = Schedule->VolumeFirstEvent[Volume];
+			}
+
+			AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode());
+			StartScore = GameMode != nullptr ? GameMode->GetScore() : 0;
+			if (GameMode != nullptr)
+			{
+				bGameModeBatchedProjectiles = GameMode->IsBatchingProjectiles();
+				GameMode->SetBatchProjectiles(bGameModeBatchedProjectiles || RunningScenario->bBatchProjectiles);
+			}
+
+			UE_LOG(LogDrillDirector, Log, TEXT("%s ready in %.0f ms, %d spawns, %d pooled targets"), *RunningScenario->GetName(),
+				(FPlatformTime::Seconds() - StartSeconds) * 1000.0, Schedule->Events.Num(), Targets.Num());
+
+			State = EDrillState::Running;
+			OnDrillStarted.Broadcast(RunningScenario);
+		}
+		break;
+
+	case EDrillState::Running:
+		// replacements for targets destroyed in play
+		InstantiatePools();
+		StepDrill(DeltaTime);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void ADrillDirector::InstantiatePools()
+{
+	if (PendingSpawns.Num() == 0)
+	{
+		return;
+	}
+
+	const double Deadline = FPlatformTime::Seconds() + InstantiateBudgetMs / 1000.0;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = this;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	do
+	{
+		UClass* TargetClass = PendingSpawns.Pop(false);
+		ATheFirstActor* Target = GetWorld()->SpawnActor<ATheFirstActor>(TargetClass, GetActorLocation(), GetActorRotation(), SpawnParams);
+		if (Target == nullptr)
+		{
+			continue;
+		}
+
+		int32 Slot;
+		if (DeadSlots.Num() > 0)
+		{
+			Slot = DeadSlots.Pop(false);
+			Targets[Slot] = Target;
+		}
+		else
+		{
+			Slot = Targets.Add(Target);
+			SlotVolume.Add(INDEX_NONE);
+			SlotEvent.Add(INDEX_NONE);
+			SlotSpawnTime.Add(0.f);
+		}
+		FreeSlots.FindOrAdd(TargetClass).Add(Slot);
+
+		Target->OnReleased.BindUObject(this, &ADrillDirector::OnTargetReleased);
+		Target->SetPooledActive(false);
+	}
+	while (PendingSpawns.Num() > 0 && FPlatformTime::Seconds() < Deadline);
+}
+
+void ADrillDirector::StepDrill(float DeltaTime)
+{
+	HOFFMANNMEHAT_SCOPE(DrillUpdate);
+
+	Elapsed += DeltaTime;
+
+	for (int32 Volume = 0; Volume < Volumes.Num(); ++Volume)
+	{
+		const int32 LastEvent = Schedule->VolumeFirstEvent[Volume + 1];
+		if (Volumes[Volume].TargetClass == nullptr)
+		{
+			NextEvent[Volume] = LastEvent;
+			continue;
+		}
+
+		// a spawn that is due while the volume is full waits for one of its targets to go
+		while (NextEvent[Volume] < LastEvent && Schedule->Events[NextEvent[Volume]].Time <= Elapsed && AliveCount[Volume] < Volumes[Volume].MaxAlive)
+		{
+			if (ActivateTarget(Volume, NextEvent[Volume]) == INDEX_NONE)
+			{
+				break;
+			}
+			++NextEvent[Volume];
+		}
+	}
+
+	AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode());
+	const FTransform& Origin = GetActorTransform();
+
+	for (int32 Index = ActiveSlots.Num() - 1; Index >= 0; --Index)
+	{
+		const int32 Slot = ActiveSlots[Index];
+		const FDrillSpawnVolume& Volume = Volumes[SlotVolume[Slot]];
+		const float Age = Elapsed - SlotSpawnTime[Slot];
+
+		if (Targets[Slot] == nullptr || Targets[Slot]->IsPendingKill())
+		{
+			DeactivateTarget(Slot);
+			continue;
+		}
+
+		if (Volume.TargetLifetime > 0.f && Age >= Volume.TargetLifetime)
+		{
+			if (GameMode != nullptr && ExpiryPenalty > 0)
+			{
+				GameMode->AddScore(-ExpiryPenalty);
+			}
+			DeactivateTarget(Slot);
+			continue;
+		}
+
+		if (Volume.Motion != EDrillMotion::Static)
+		{
+			const FVector Location = FDrillSchedule::EvaluateMotion(Volume, Schedule->Events[SlotEvent[Slot]], Age);
+			Targets[Slot]->SetActorLocation(Origin.TransformPosition(Location), false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+
+	int32 Remaining = ActiveSlots.Num();
+	for (int32 Volume = 0; Volume < Volumes.Num(); ++Volume)
+	{
+		Remaining += Schedule->VolumeFirstEvent[Volume + 1] - NextEvent[Volume];
+	}
+	if (GameMode != nullptr)
+	{
+		GameMode->SetTargetsRemaining(Remaining);
+	}
+
+	if (Elapsed >= Duration || Remaining == 0)
+	{
+		FinishScenario();
+	}
+}
+
+int32 ADrillDirector::ActivateTarget(int32 Volume, int32 Event)
+{
+	TArray<int32>* Free = FreeSlots.Find(Volumes[Volume].TargetClass);
+	while (Free != nullptr && Free->Num() > 0)
+	{
+		const int32 Slot = Free->Pop(false);
+		ATheFirstActor* Target = Targets[Slot];
+		if (Target == nullptr || Target->IsPendingKill())
+		{
+			ReplaceDeadTarget(Slot, Volumes[Volume].TargetClass);
+			continue;
+		}
+
+		Target->SetActorLocation(GetActorTransform().TransformPosition(Schedule->Events[Event].Location), false, nullptr, ETeleportType::TeleportPhysics);
+		Target->SetPooledActive(true);
+
+		SlotVolume[Slot] = Volume;
+		SlotEvent[Slot] = Event;
+		SlotSpawnTime[Slot] = Elapsed;
+		ActiveSlots.Add(Slot);
+		++AliveCount[Volume];
+
+		// reaction times are measured from here, as for the hand-placed spawn volumes
+		const AHoffmannMehatCharacter* Player = Cast<AHoffmannMehatCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+		if (Player != nullptr && Player->GetSessionRecorder() != nullptr)
+		{
+			Player->GetSessionRecorder()->RecordTargetSpawn(Target, FPlatformTime::Seconds());
+		}
+		return Slot;
+	}
+	return INDEX_NONE;
+}
+
+void ADrillDirector::DeactivateTarget(int32 Slot)
+{
+	UClass* const TargetClass = Volumes[SlotVolume[Slot]].TargetClass;
+
+	--AliveCount[SlotVolume[Slot]];
+	SlotVolume[Slot] = INDEX_NONE;
+	SlotEvent[Slot] = INDEX_NONE;
+	ActiveSlots.RemoveSingleSwap(Slot);
+
+	ATheFirstActor* Target = Targets[Slot];
+	if (Target != nullptr && !Target->IsPendingKill())
+	{
+		Target->SetPooledActive(false);
+		FreeSlots.FindOrAdd(Target->GetClass()).Add(Slot);
+	}
+	else
+	{
+		ReplaceDeadTarget(Slot, TargetClass);
+	}
+}
+
+void ADrillDirector::ReplaceDeadTarget(int32 Slot, UClass* TargetClass)
+{
+	Targets[Slot] = nullptr;
+	DeadSlots.Add(Slot);
+	if (TargetClass != nullptr)
+	{
+		PendingSpawns.Add(TargetClass);
+	}
+}
+
+void ADrillDirector::OnTargetReleased(ATheFirstActor* Target)
+{
+	const int32 Slot = Targets.Find(Target);
+	if (Slot != INDEX_NONE && SlotVolume[Slot] != INDEX_NONE)
+	{
+		DeactivateTarget(Slot);
+	}
+}
+
+void ADrillDirector::FinishScenario()
+{
+	while (ActiveSlots.Num() > 0)
+	{
+		DeactivateTarget(ActiveSlots.Last());
+	}
+
+	State = EDrillState::Finished;
+
+	AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode());
+	int32 Score = 0;
+	if (GameMode != nullptr)
+	{
+		GameMode->SetTargetsRemaining(0);
+		GameMode->SetBatchProjectiles(bGameModeBatchedProjectiles);
+		Score = GameMode->GetScore() - StartScore;
+	}
+
+	OnDrillFinished.Broadcast(RunningScenario, Score);
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "DrillScenario.h"
+#include "DrillDirector.generated.h"
+
+class ATheFirstActor;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDrillStarted, UDrillScenario*, Scenario);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDrillFinished, UDrillScenario*, Scenario, int32, Score);
+
+UENUM(BlueprintType)
+enum class EDrillState : uint8
+{
+	Idle,
+	/** Schedule is being worked out on a pool thread */
+	Building,
+	/** Target pools are being filled on the game thread */
+	Instantiating,
+	Running,
+	Finished
+};
+
+/**
+ * Plays UDrillScenarios in a generic arena, in place of a hand-built map per drill. Starting a
+ * scenario builds its layout and spawn schedule on a pool thread, meanwhile the targets it
+ * needs are spawned hidden into pools, a few per frame within InstantiateBudgetMs. Once both
+ * are done the drill runs: spawns come out of the pools at their scheduled times, every active
+ * target is moved by its volume's motion pattern, and killed or expired targets go back to the
+ * pools. Pools are kept between scenarios, so switching drills mostly reuses them.
+ */
+UCLASS()
+class HOFFMANNMEHAT_API ADrillDirector : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADrillDirector();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+	/** Stops the current drill and starts building NewScenario, it runs as soon as it's ready */
+	UFUNCTION(BlueprintCallable, Category = "Drill")
+	void StartScenario(UDrillScenario* NewScenario);
+
+	/** Ends the current drill, its targets go back to the pools */
+	UFUNCTION(BlueprintCallable, Category = "Drill")
+	void StopScenario();
+
+	UFUNCTION(BlueprintPure, Category = "Drill")
+	EDrillState GetState() const { return State; }
+
+	/** Time left in the running drill (s), its full length until it starts */
+	UFUNCTION(BlueprintPure, Category = "Drill")
+	float GetTimeRemaining() const;
+
+	/** Fired when the drill's first frame runs */
+	UPROPERTY(BlueprintAssignable, Category = "Drill")
+	FOnDrillStarted OnDrillStarted;
+
+	/** Fired when the drill runs out of time or targets, or is stopped */
+	UPROPERTY(BlueprintAssignable, Category = "Drill")
+	FOnDrillFinished OnDrillFinished;
+
+protected:
+	/** Game thread side of the build, once the schedule has come back */
+	void OnScheduleBuilt(int32 Build, TSharedRef<FDrillSchedule, ESPMode::ThreadSafe> NewSchedule);
+
+	/** Spawns pooled targets until the pools are full or the frame's budget is spent */
+	void InstantiatePools();
+
+	/** Spawns the due events out of the pools, moves and expires the active targets */
+	void StepDrill(float DeltaTime);
+
+	/** Takes a free target of the volume's class out of its pool, INDEX_NONE if there is none */
+	int32 ActivateTarget(int32 Volume, int32 Event);
+
+	/** Returns a target to its pool */
+	void DeactivateTarget(int32 Slot);
+
+	/** Frees the slot of a destroyed target and queues a new TargetClass to take its place */
+	void ReplaceDeadTarget(int32 Slot, UClass* TargetClass);
+
+	/** Bound to each pooled target's OnReleased */
+	void OnTargetReleased(ATheFirstActor* Target);
+
+	void FinishScenario();
+
+	/** Played when play begins. If unset, the game instance's selected scenario is used. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Drill")
+	UDrillScenario* Scenario;
+
+	/** Game thread time spent spawning pooled targets per frame (ms), at least one is spawned */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Drill", meta = (ClampMin = "0"))
+	float InstantiateBudgetMs;
+
+private:
+	EDrillState State;
+
+	/** Bumped by every start and stop, so a schedule that comes back late is dropped */
+	int32 BuildSerial;
+
+	/** Copy of the scenario's volumes the schedule was built from */
+	TArray<FDrillSpawnVolume> Volumes;
+	TSharedPtr<FDrillSchedule, ESPMode::ThreadSafe> Schedule;
+
+	/** Pooled targets of every class, by slot. Targets that destroy themselves on a kill, as the Blueprint targets do, are replaced. */
+	UPROPERTY(Transient)
+	TArray<ATheFirstActor*> Targets;
+
+	/** Volume and event an active slot was spawned for, INDEX_NONE while pooled */
+	TArray<int32> SlotVolume;
+	TArray<int32> SlotEvent;
+
+	/** Drill time an active slot came out of its pool, its motion starts from here (s) */
+	TArray<float> SlotSpawnTime;
+
+	/** Slots currently in play */
+	TArray<int32> ActiveSlots;
+
+	/** Pooled slots of each target class */
+	TMap<UClass*, TArray<int32>> FreeSlots;
+
+	/** Targets still to spawn into the pools, one entry per target */
+	TArray<UClass*> PendingSpawns;
+
+	/** Slots whose target was destroyed, reused by the next pooled spawns */
+	TArray<int32> DeadSlots;
+
+	/** Next event to spawn and targets in play, by volume */
+	TArray<int32> NextEvent;
+	TArray<int32> AliveCount;
+
+	float Elapsed;
+	float Duration;
+	int32 ExpiryPenalty;
+	int32 StartScore;
+
+	/** FPlatformTime::Seconds() of the last StartScenario, for the load time */
+	double StartSeconds;
+
+	/** Game mode's shot batching from before the drill turned it on, put back when it finishes */
+	bool bGameModeBatchedProjectiles;
+
+	UPROPERTY(Transient)
+	UDrillScenario* RunningScenario;
+};
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DrillScenario.h"
+#include "TheFirstActor.h"
+#include "Math/RandomStream.h"
+
+namespace DrillScenario
+{
+	/** Keeps a schedule without a spawn limit from growing without bound (s) */
+	static const float MinSpawnInterval = 0.05f;
+
+	/** Reflects X back into [-Extent, Extent] as if it had bounced off both ends */
+	static float Fold(float X, float Extent)
+	{
+		if (Extent <= 0.f)
+		{
+			return 0.f;
+		}
+
+		const float Width = 2.f * Extent;
+		float Offset = FMath::Fmod(X + Extent, 2.f * Width);
+		if (Offset < 0.f)
+		{
+			Offset += 2.f * Width;
+		}
+		return (Offset > Width ? 2.f * Width - Offset : Offset) - Extent;
+	}
+}
+
+FDrillSpawnVolume::FDrillSpawnVolume()
+{
+	Center = FVector::ZeroVector;
+	Extent = FVector(50.f, 400.f, 200.f);
+	TargetClass = nullptr;
+	MaxAlive = 3;
+	TotalSpawns = 0;
+	StartDelay = 0.f;
+
+	// the hand-built maps' spawn volumes
+	SpawnIntervalMin = 1.0f;
+	SpawnIntervalMax = 4.5f;
+
+	TargetLifetime = 0.f;
+	Motion = EDrillMotion::Static;
+	MotionSpeed = 200.f;
+	MotionAmplitude = 150.f;
+}
+
+UDrillScenario::UDrillScenario()
+{
+	Duration = 60.f;
+	Seed = 0;
+	ExpiryPenalty = 0;
+	bBatchProjectiles = false;
+}
+
+FDrillSchedule FDrillSchedule::Build(const TArray<FDrillSpawnVolume>& Volumes, float Duration, int32 Seed)
+{
+	FDrillSchedule Schedule;
+	Schedule.VolumeFirstEvent.Reserve(Volumes.Num() + 1);
+
+	for (int32 VolumeIndex = 0; VolumeIndex < Volumes.Num(); ++VolumeIndex)
+	{
+		const FDrillSpawnVolume& Volume = Volumes[VolumeIndex];
+		Schedule.VolumeFirstEvent.Add(Schedule.Events.Num());
+
+		// a stream per volume, so editing one volume doesn't reshuffle the others
+		FRandomStream Stream(HashCombine(GetTypeHash(Seed), GetTypeHash(VolumeIndex)));
+		const float IntervalMin = FMath::Max(Volume.SpawnIntervalMin, DrillScenario::MinSpawnInterval);
+		const float IntervalMax = FMath::Max(Volume.SpawnIntervalMax, IntervalMin);
+
+		float Time = Volume.StartDelay;
+		for (int32 Count = 0; Time < Duration && (Volume.TotalSpawns == 0 || Count < Volume.TotalSpawns); ++Count)
+		{
+			FDrillSpawnEvent& Event = Schedule.Events.AddDefaulted_GetRef();
+			Event.Time = Time;
+			Event.Location = Volume.Center + FVector(
+				Stream.FRandRange(-Volume.Extent.X, Volume.Extent.X),
+				Stream.FRandRange(-Volume.Extent.Y, Volume.Extent.Y),
+				Stream.FRandRange(-Volume.Extent.Z, Volume.Extent.Z));
+			Event.Phase = Stream.FRandRange(0.f, 2.f * PI);
+			Event.Direction = Stream.GetUnitVector();
+
+			Time += Stream.FRandRange(IntervalMin, IntervalMax);
+		}
+	}
+
+	Schedule.VolumeFirstEvent.Add(Schedule.Events.Num());
+	return Schedule;
+}
+
+FVector FDrillSchedule::EvaluateMotion(const FDrillSpawnVolume& Volume, const FDrillSpawnEvent& Event, float Age)
+{
+	switch (Volume.Motion)
+	{
+	case EDrillMotion::Strafe:
+	{
+		// starts at the spawn point, moving at MotionSpeed through the middle of the swing
+		const float Amplitude = FMath::Max(Volume.MotionAmplitude, KINDA_SMALL_NUMBER);
+		const float Angle = Event.Phase + Age * Volume.MotionSpeed / Amplitude;
+		return Event.Location + FVector(0.f, Volume.MotionAmplitude * (FMath::Sin(Angle) - FMath::Sin(Event.Phase)), 0.f);
+	}
+	case EDrillMotion::Orbit:
+	{
+		// MotionSpeed along the circle
+		const float Amplitude = FMath::Max(Volume.MotionAmplitude, KINDA_SMALL_NUMBER);
+		const float Angle = Event.Phase + Age * Volume.MotionSpeed / Amplitude;
+		return Event.Location + Volume.MotionAmplitude * FVector(0.f, FMath::Cos(Angle) - FMath::Cos(Event.Phase), FMath::Sin(Angle) - FMath::Sin(Event.Phase));
+	}
+	case EDrillMotion::Bounce:
+	{
+		const FVector Unfolded = Event.Location - Volume.Center + Event.Direction * Volume.MotionSpeed * Age;
+		return Volume.Center + FVector(
+			DrillScenario::Fold(Unfolded.X, Volume.Extent.X),
+			DrillScenario::Fold(Unfolded.Y, Volume.Extent.Y),
+			DrillScenario::Fold(Unfolded.Z, Volume.Extent.Z));
+	}
+	default:
+		return Event.Location;
+	}
+}
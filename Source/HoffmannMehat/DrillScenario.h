@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "DrillScenario.generated.h"
+
+class ATheFirstActor;
+
+/** How a target moves once it has spawned, around the point it spawned at */
+UENUM(BlueprintType)
+enum class EDrillMotion : uint8
+{
+	Static,
+	/** Side to side along the volume's Y axis */
+	Strafe,
+	/** Circles in the volume's YZ plane */
+	Orbit,
+	/** Straight lines in a random direction, reflecting off the volume's walls */
+	Bounce
+};
+
+/** One box of a drill's arena and the targets it spawns */
+USTRUCT(BlueprintType)
+struct HOFFMANNMEHAT_API FDrillSpawnVolume
+{
+	GENERATED_BODY()
+
+	FDrillSpawnVolume();
+
+	/** Center of the box, relative to the drill director (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	FVector Center;
+
+	/** Half size of the box (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	FVector Extent;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	TSubclassOf<ATheFirstActor> TargetClass;
+
+	/** Targets of this volume in play at once, also the number pooled for it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning", meta = (ClampMin = "1"))
+	int32 MaxAlive;
+
+	/** Targets spawned over the whole drill, 0 to keep spawning until time runs out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning", meta = (ClampMin = "0"))
+	int32 TotalSpawns;
+
+	/** Time from the start of the drill to the first spawn (s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Timing", meta = (ClampMin = "0"))
+	float StartDelay;
+
+	/** Time between spawns is picked from this range (s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Timing", meta = (ClampMin = "0"))
+	float SpawnIntervalMin;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Timing", meta = (ClampMin = "0"))
+	float SpawnIntervalMax;
+
+	/** A target not killed within this time leaves play (s), 0 keeps it until it's killed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Timing", meta = (ClampMin = "0"))
+	float TargetLifetime;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Motion")
+	EDrillMotion Motion;
+
+	/** Speed along the strafe, orbit or bounce path (cm/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Motion", meta = (ClampMin = "0"))
+	float MotionSpeed;
+
+	/** Half the strafe distance and the orbit radius (cm). Bounce stays inside the box. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Motion", meta = (ClampMin = "0"))
+	float MotionAmplitude;
+};
+
+/**
+ * A drill as data: the boxes targets spawn in, what spawns there, how the targets move, the
+ * spawn timing and the scoring. ADrillDirector plays one in a generic arena, so a new drill is
+ * a new asset rather than a new map.
+ */
+UCLASS(BlueprintType)
+class HOFFMANNMEHAT_API UDrillScenario : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UDrillScenario();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Drill")
+	FText DisplayName;
+
+	/** Length of the drill (s) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Drill", meta = (ClampMin = "1"))
+	float Duration;
+
+	/** Seeds the layout and schedule so every run of the drill is the same, 0 for a new one each run */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Drill")
+	int32 Seed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Drill")
+	TArray<FDrillSpawnVolume> Volumes;
+
+	/** Taken off the score when a target's lifetime runs out before it's killed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scoring", meta = (ClampMin = "0"))
+	int32 ExpiryPenalty;
+
+	/**
+	 * Simulate shots in the projectile manager while the drill runs. Only for drills of
+	 * ADamageableTargets, see AHoffmannMehatGameMode::SetBatchProjectiles.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Drill")
+	bool bBatchProjectiles;
+};
+
+/** A precomputed spawn, in the director's space */
+struct FDrillSpawnEvent
+{
+	/** Time since the start of the drill (s) */
+	float Time;
+
+	FVector Location;
+
+	/** Where the motion pattern starts: orbit angle (rad) or bounce direction (unit) */
+	float Phase;
+	FVector Direction;
+};
+
+/**
+ * Every spawn of a drill, worked out up front. Only reads plain data, so it is built on a pool
+ * thread while the game thread fills the target pools.
+ */
+struct HOFFMANNMEHAT_API FDrillSchedule
+{
+	/** Sorted by time within each volume */
+	TArray<FDrillSpawnEvent> Events;
+
+	/** Volume v's events are [VolumeFirstEvent[v], VolumeFirstEvent[v + 1]) */
+	TArray<int32> VolumeFirstEvent;
+
+	static FDrillSchedule Build(const TArray<FDrillSpawnVolume>& Volumes, float Duration, int32 Seed);
+
+	/** Location of a target Age seconds after its spawn, in the director's space */
+	static FVector EvaluateMotion(const FDrillSpawnVolume& Volume, const FDrillSpawnEvent& Event, float Age);
+};
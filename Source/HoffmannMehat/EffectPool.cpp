@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "EffectPool.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatGameInstance.h"
+#include "Components/SceneComponent.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+AEffectPool::AEffectPool()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	DefaultEffect = TSoftObjectPtr<UParticleSystem>(FSoftObjectPath(TEXT("/Game/StarterContent/Particles/P_Explosion.P_Explosion")));
+	EffectsPerTemplate = 8;
+	LoadedDefaultEffect = nullptr;
+}
+
+void AEffectPool::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UHoffmannMehatGameInstance* GameInstance = Cast<UHoffmannMehatGameInstance>(GetGameInstance());
+	if (GameInstance == nullptr)
+	{
+		DefaultEffect.LoadSynchronous();
+		OnDefaultEffectLoaded();
+		return;
+	}
+
+	// the level starts without waiting for it, kills before it arrives play no effect
+	TWeakObjectPtr<AEffectPool> WeakThis(this);
+	GameInstance->GetStreamableManager().RequestAsyncLoad(DefaultEffect.ToSoftObjectPath(), [WeakThis]()
+	{
+		if (AEffectPool* Pool = WeakThis.Get())
+		{
+			Pool->OnDefaultEffectLoaded();
+		}
+	});
+}
+
+void AEffectPool::OnDefaultEffectLoaded()
+{
+	HOFFMANNMEHAT_LLM_SCOPE(Targets);
+
+	// the first kill shouldn't load or build anything
+	LoadedDefaultEffect = DefaultEffect.Get();
+	if (LoadedDefaultEffect != nullptr)
+	{
+		FindOrBuildSet(LoadedDefaultEffect);
+	}
+}
+
+FPooledEffectSet& AEffectPool::FindOrBuildSet(UParticleSystem* Template)
+{
+	for (FPooledEffectSet& Set : Sets)
+	{
+		if (Set.Template == Template)
+		{
+			return Set;
+		}
+	}
+
+	FPooledEffectSet& Set = Sets[Sets.AddDefaulted()];
+	Set.Template = Template;
+	Set.Components.Reserve(EffectsPerTemplate);
+	for (int32 Index = 0; Index < EffectsPerTemplate; ++Index)
+	{
+		// not attached, each play puts the component where the effect happens
+		UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(this);
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->SetTemplate(Template);
+		Component->RegisterComponent();
+		Set.Components.Add(Component);
+	}
+	return Set;
+}
+
+void AEffectPool::PlayEffect(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, const FVector& Scale)
+{
+	HOFFMANNMEHAT_LLM_SCOPE(Targets);
+
+	if (Template == nullptr)
+	{
+		Template = LoadedDefaultEffect;
+	}
+	if (Template == nullptr)
+	{
+		return;
+	}
+
+	FPooledEffectSet& Set = FindOrBuildSet(Template);
+	if (Set.Components.Num() == 0)
+	{
+		return;
+	}
+
+	// the cursor component started longest ago, if it's still playing every other one is too
+	UParticleSystemComponent* Component = Set.Components[Set.Cursor];
+	Set.Cursor = (Set.Cursor + 1) % Set.Components.Num();
+
+	Component->SetWorldTransform(FTransform(Rotation, Location, Scale));
+	Component->Activate(true);
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EffectPool.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/** The components preallocated for one particle template */
+USTRUCT()
+struct FPooledEffectSet
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	UParticleSystem* Template = nullptr;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> Components;
+
+	/** Next component to play, also the one that started longest ago */
+	int32 Cursor = 0;
+};
+
+/**
+ * Plays one-shot particle effects, e.g. target deaths, through particle components built ahead
+ * of time instead of spawning a new one each time. Each template gets EffectsPerTemplate
+ * components, used round-robin, and when all of them are still playing the oldest one is
+ * restarted. The default template is built as soon as it has loaded, others on their first use.
+ */
+UCLASS()
+class HOFFMANNMEHAT_API AEffectPool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AEffectPool();
+
+	virtual void BeginPlay() override;
+
+	/** Plays Template at a transform, nullptr plays DefaultEffect */
+	void PlayEffect(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator, const FVector& Scale = FVector(1.f));
+
+	/** Loaded in the background when play begins and built once it arrives, played for targets without an effect of their own */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	TSoftObjectPtr<UParticleSystem> DefaultEffect;
+
+	/** Components built for each template, the most of it that can play at once */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (ClampMin = "1"))
+	int32 EffectsPerTemplate;
+
+protected:
+	/** Set for Template, built if it's new */
+	FPooledEffectSet& FindOrBuildSet(UParticleSystem* Template);
+
+	/** Builds DefaultEffect's set ahead of the first kill */
+	void OnDefaultEffectLoaded();
+
+private:
+	UPROPERTY(Transient)
+	TArray<FPooledEffectSet> Sets;
+
+	UPROPERTY(Transient)
+	UParticleSystem* LoadedDefaultEffect;
+};
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FeedbackAudio.h"
+#include "HoffmannMehatStats.h"
+#include "Components/AudioComponent.h"
+#include "GameFramework/Actor.h"
+#include "Sound/SoundBase.h"
+
+UFeedbackAudioComponent::UFeedbackAudioComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	HitSound = nullptr;
+	KillSound = nullptr;
+	VoicesPerSound = 4;
+
+	VoiceSets.SetNum((int32)EFeedbackSound::Count);
+}
+
+void UFeedbackAudioComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// the fire sound comes from the owner through SetSound
+	VoiceSets[(int32)EFeedbackSound::Hit].Sound = HitSound;
+	VoiceSets[(int32)EFeedbackSound::Kill].Sound = KillSound;
+
+	for (int32 Kind = 0; Kind < VoiceSets.Num(); ++Kind)
+	{
+		BuildVoices((EFeedbackSound)Kind);
+	}
+}
+
+void UFeedbackAudioComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (FFeedbackVoiceSet& Set : VoiceSets)
+	{
+		for (UAudioComponent* Voice : Set.Voices)
+		{
+			if (Voice != nullptr)
+			{
+				Voice->DestroyComponent();
+			}
+		}
+		Set.Voices.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UFeedbackAudioComponent::SetSound(EFeedbackSound Kind, USoundBase* Sound)
+{
+	FFeedbackVoiceSet& Set = VoiceSets[(int32)Kind];
+	if (Set.Sound == Sound)
+	{
+		return;
+	}
+
+	Set.Sound = Sound;
+	if (HasBegunPlay())
+	{
+		BuildVoices(Kind);
+	}
+}
+
+void UFeedbackAudioComponent::BuildVoices(EFeedbackSound Kind)
+{
+	FFeedbackVoiceSet& Set = VoiceSets[(int32)Kind];
+	for (UAudioComponent* Voice : Set.Voices)
+	{
+		if (Voice != nullptr)
+		{
+			Voice->DestroyComponent();
+		}
+	}
+	Set.Voices.Reset();
+	Set.Cursor = 0;
+
+	AActor* Owner = GetOwner();
+	if (Set.Sound == nullptr || Owner == nullptr)
+	{
+		return;
+	}
+
+	Set.Voices.Reserve(VoicesPerSound);
+	for (int32 Index = 0; Index < VoicesPerSound; ++Index)
+	{
+		// not attached, PlayAtLocation puts the voice where the sound happens
+		UAudioComponent* Voice = NewObject<UAudioComponent>(Owner);
+		Voice->bAutoActivate = false;
+		Voice->bAutoDestroy = false;
+		Voice->bStopWhenOwnerDestroyed = true;
+		Voice->SetSound(Set.Sound);
+		Voice->RegisterComponent();
+		Set.Voices.Add(Voice);
+	}
+}
+
+UAudioComponent* UFeedbackAudioComponent::NextVoice(EFeedbackSound Kind)
+{
+	FFeedbackVoiceSet& Set = VoiceSets[(int32)Kind];
+	if (Set.Voices.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// the cursor voice started longest ago, if it's still playing every other one is too
+	UAudioComponent* Voice = Set.Voices[Set.Cursor];
+	Set.Cursor = (Set.Cursor + 1) % Set.Voices.Num();
+	return Voice;
+}
+
+void UFeedbackAudioComponent::Play2D(EFeedbackSound Kind)
+{
+	HOFFMANNMEHAT_SCOPE(FeedbackAudio);
+
+	if (UAudioComponent* Voice = NextVoice(Kind))
+	{
+		Voice->bAllowSpatialization = false;
+		Voice->Play();
+	}
+}
+
+void UFeedbackAudioComponent::PlayAtLocation(EFeedbackSound Kind, const FVector& Location)
+{
+	HOFFMANNMEHAT_SCOPE(FeedbackAudio);
+
+	if (UAudioComponent* Voice = NextVoice(Kind))
+	{
+		Voice->bAllowSpatialization = true;
+		Voice->SetWorldLocation(Location);
+		Voice->Play();
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "FeedbackAudio.generated.h"
+
+class UAudioComponent;
+class USoundBase;
+
+UENUM(BlueprintType)
+enum class EFeedbackSound : uint8
+{
+	Fire,
+	Hit,
+	Kill,
+
+	Count UMETA(Hidden)
+};
+
+/** The voices preallocated for one feedback sound */
+USTRUCT()
+struct FFeedbackVoiceSet
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	USoundBase* Sound = nullptr;
+
+	UPROPERTY(Transient)
+	TArray<UAudioComponent*> Voices;
+
+	/** Next voice to play, also the one that started longest ago */
+	int32 Cursor = 0;
+};
+
+/**
+ * Plays the fire, hit and kill sounds through audio components built once in BeginPlay instead
+ * of a new sound per shot. Each sound has a fixed number of voices used round-robin, and when
+ * all of them are still playing the oldest one is cut off, so rapid fire costs the same no
+ * matter how fast the shots come.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class HOFFMANNMEHAT_API UFeedbackAudioComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UFeedbackAudioComponent();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Changes the sound a kind plays, the voices are rebuilt if they already exist */
+	UFUNCTION(BlueprintCallable, Category = "Audio")
+	void SetSound(EFeedbackSound Kind, USoundBase* Sound);
+
+	/** Plays without spatialization, for the local player's own gun and hit confirmations */
+	UFUNCTION(BlueprintCallable, Category = "Audio")
+	void Play2D(EFeedbackSound Kind);
+
+	/** Plays spatialized at Location */
+	UFUNCTION(BlueprintCallable, Category = "Audio")
+	void PlayAtLocation(EFeedbackSound Kind, const FVector& Location);
+
+	/** Played when a shot hits a target */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Audio")
+	USoundBase* HitSound;
+
+	/** Played when a shot destroys a target */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Audio")
+	USoundBase* KillSound;
+
+	/** Voices built for each sound, the most of it that can play at once */
+	UPROPERTY(EditDefaultsOnly, Category = "Audio", meta = (ClampMin = "1"))
+	int32 VoicesPerSound;
+
+protected:
+	/** Creates and registers the voices of a kind for its current sound */
+	void BuildVoices(EFeedbackSound Kind);
+
+	/** Voice to play Kind with next, nullptr if it has no sound */
+	UAudioComponent* NextVoice(EFeedbackSound Kind);
+
+private:
+	/** By EFeedbackSound */
+	UPROPERTY(Transient)
+	TArray<FFeedbackVoiceSet> VoiceSets;
+};
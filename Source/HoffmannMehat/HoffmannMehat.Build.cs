@@ -1,5 +1,6 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class HoffmannMehat : ModuleRules
@@ -8,6 +9,16 @@ public class HoffmannMehat : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "UMG" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore", "RenderCore", "Json", "NavigationSystem" });
+
+		// on Linux gamepads are read straight from evdev, with the kernel timestamps
+		bool bWithEvdevGamepad = Target.Platform == UnrealTargetPlatform.Linux && Directory.Exists(Path.Combine(ModuleDirectory, "../../Plugins/EvdevGamepad"));
+		if (bWithEvdevGamepad)
+		{
+			PrivateDependencyModuleNames.Add("EvdevGamepad");
+		}
+		PublicDefinitions.Add("WITH_EVDEV_GAMEPAD=" + (bWithEvdevGamepad ? "1" : "0"));
 	}
 }
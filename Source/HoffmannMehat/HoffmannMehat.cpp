@@ -1,7 +1,25 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "HoffmannMehat.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatStats.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, HoffmannMehat, "HoffmannMehat" );
- 
\ No newline at end of file
+class FHoffmannMehatModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		FHoffmannMehatLLM::RegisterTags();
+
+		// before any of our code has run, so the proxy never swaps in under a running game
+		if (FParse::Param(FCommandLine::Get(), TEXT("CountAllocs")))
+		{
+			FHoffmannMehatAllocCounter::Install();
+		}
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FHoffmannMehatModule, HoffmannMehat, "HoffmannMehat" );
@@ -0,0 +1,713 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HoffmannMehatBenchmark.h"
+#include "AimResponseCurve.h"
+#include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatHUD.h"
+#include "HoffmannMehatStats.h"
+#include "HoffmannMehatProjectile.h"
+#include "SpawnVolume.h"
+#include "TheFirstActor.h"
+#include "CanvasTypes.h"
+#include "Containers/Ticker.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderCore.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogHoffmannMehatBenchmark, Log, All);
+
+namespace HoffmannMehatBenchmark
+{
+	static const int32 CurveIterations = 1000000;
+	static const int32 LookIterations = 100000;
+	static const int32 SpawnIterations = 200;
+	static const int32 HUDIterations = 1000;
+
+	/** Canvas the HUD is drawn into by its micro benchmark, a 1080p viewport */
+	static const FIntPoint HUDCanvasSize(1920, 1080);
+
+	static TAutoConsoleVariable<float> CVarTolerance(
+		TEXT("HoffmannMehat.BenchTolerance"),
+		0.25f,
+		TEXT("How much slower than the baseline a benchmark result may be before it fails, as a fraction of the baseline's"));
+
+	/** Results the benchmarks are compared against, a copy of an earlier run */
+	static FString GetBaselinePath()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("HoffmannMehat-Baseline.json");
+	}
+
+	/** Keeps the optimizer from dropping benchmark loops whose results are unused */
+	static volatile float Sink = 0.f;
+
+	static TSharedRef<FJsonObject> MakeTiming(double Seconds, int32 Iterations)
+	{
+		TSharedRef<FJsonObject> Timing = MakeShared<FJsonObject>();
+		Timing->SetNumberField(TEXT("iterations"), Iterations);
+		Timing->SetNumberField(TEXT("total_ms"), Seconds * 1000.0);
+		Timing->SetNumberField(TEXT("ns_per_op"), Seconds * 1e9 / FMath::Max(Iterations, 1));
+		return Timing;
+	}
+
+	static TSharedRef<FJsonObject> MakeSkipped(const TCHAR* Reason)
+	{
+		TSharedRef<FJsonObject> Skipped = MakeShared<FJsonObject>();
+		Skipped->SetStringField(TEXT("skipped"), Reason);
+		return Skipped;
+	}
+
+	/** Collects every actor spawned in World while it is alive */
+	struct FScopedSpawnCapture
+	{
+		FScopedSpawnCapture(UWorld* InWorld, TArray<TWeakObjectPtr<AActor>>& InSpawned)
+			: World(InWorld)
+			, Spawned(InSpawned)
+		{
+			Handle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateLambda([this](AActor* Actor) { Spawned.Add(Actor); }));
+		}
+
+		~FScopedSpawnCapture()
+		{
+			World->RemoveOnActorSpawnedHandler(Handle);
+		}
+
+		UWorld* World;
+		TArray<TWeakObjectPtr<AActor>>& Spawned;
+		FDelegateHandle Handle;
+	};
+
+	static void DestroyAll(TArray<TWeakObjectPtr<AActor>>& Actors)
+	{
+		for (const TWeakObjectPtr<AActor>& Actor : Actors)
+		{
+			if (Actor.IsValid())
+			{
+				Actor->Destroy();
+			}
+		}
+		Actors.Reset();
+	}
+
+	static AHoffmannMehatCharacter* FindCharacter(UWorld* World)
+	{
+		APlayerController* Controller = World ? World->GetFirstPlayerController() : nullptr;
+		return Controller ? Cast<AHoffmannMehatCharacter>(Controller->GetPawn()) : nullptr;
+	}
+
+	static TSharedRef<FJsonObject> MakeMeta(UWorld* World)
+	{
+		TSharedRef<FJsonObject> Meta = MakeShared<FJsonObject>();
+		Meta->SetStringField(TEXT("build"), EBuildConfigurations::ToString(FApp::GetBuildConfiguration()));
+		Meta->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+		Meta->SetStringField(TEXT("map"), World ? World->GetMapName() : FString());
+		Meta->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+		return Meta;
+	}
+
+	/** The command's run, only kept alive by the ticker until it finishes */
+	static TWeakPtr<FHoffmannMehatBenchmark> CommandBenchmark;
+
+	static void RunBenchmarkCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		if (CommandBenchmark.IsValid())
+		{
+			UE_LOG(LogHoffmannMehatBenchmark, Warning, TEXT("A benchmark is already running"));
+			return;
+		}
+
+		const FString Params = FString::Join(Args, TEXT(" "));
+		int32 NumTargets = 50;
+		int32 NumFrames = 600;
+		int32 AllocBudget = 0;
+		FParse::Value(*Params, TEXT("Targets="), NumTargets);
+		FParse::Value(*Params, TEXT("Frames="), NumFrames);
+		FParse::Value(*Params, TEXT("AllocBudget="), AllocBudget);
+		const bool bFire = !Args.Contains(TEXT("NoFire"));
+		const bool bQuit = Args.Contains(TEXT("Quit"));
+
+		TSharedPtr<FHoffmannMehatBenchmark> Benchmark = MakeShared<FHoffmannMehatBenchmark>(World, NumTargets, NumFrames, AllocBudget, bFire, bQuit);
+		Benchmark->AddResults(TEXT("micro"), FHoffmannMehatBenchmark::RunMicroBenchmarks(World));
+		CommandBenchmark = Benchmark;
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Benchmark](float)
+		{
+			return !Benchmark->IsFinished();
+		}));
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("HoffmannMehat.Bench"),
+		TEXT("Benchmarks the gameplay hot paths and writes JSON to Saved/Benchmarks. Quit exits with status 1 on a regression or a failed allocation check. Usage: HoffmannMehat.Bench [Targets=N] [Frames=N] [AllocBudget=N] [NoFire] [Quit]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmarkCommand));
+}
+
+FHoffmannMehatBenchmark::FHoffmannMehatBenchmark(UWorld* InWorld, int32 InNumTargets, int32 InNumFrames, int32 InAllocBudget, bool bInFire, bool bInQuitWhenDone)
+	: World(InWorld)
+	, NumTargets(InNumTargets)
+	, NumFrames(InNumFrames)
+	, AllocBudget(InAllocBudget)
+	, Frame(0)
+	, bFire(bInFire)
+	, bQuitWhenDone(bInQuitWhenDone)
+	, bFinished(false)
+	, bSessionComplete(false)
+	, Results(MakeShared<FJsonObject>())
+	, FramesOverBudget(0)
+{
+	Results->SetObjectField(TEXT("meta"), HoffmannMehatBenchmark::MakeMeta(InWorld));
+}
+
+TStatId FHoffmannMehatBenchmark::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FHoffmannMehatBenchmark, STATGROUP_Tickables);
+}
+
+TSharedRef<FJsonObject> FHoffmannMehatBenchmark::MakeDistribution(TArray<float> Samples)
+{
+	TSharedRef<FJsonObject> Distribution = MakeShared<FJsonObject>();
+	if (Samples.Num() == 0)
+	{
+		return Distribution;
+	}
+
+	Samples.Sort();
+	double Sum = 0.0;
+	for (float Sample : Samples)
+	{
+		Sum += Sample;
+	}
+
+	auto Percentile = [&Samples](float Fraction) { return Samples[FMath::Min(Samples.Num() - 1, FMath::FloorToInt(Fraction * Samples.Num()))]; };
+	Distribution->SetNumberField(TEXT("mean"), Sum / Samples.Num());
+	Distribution->SetNumberField(TEXT("p50"), Percentile(0.5f));
+	Distribution->SetNumberField(TEXT("p95"), Percentile(0.95f));
+	Distribution->SetNumberField(TEXT("p99"), Percentile(0.99f));
+	Distribution->SetNumberField(TEXT("max"), Samples.Last());
+	return Distribution;
+}
+
+FString FHoffmannMehatBenchmark::WriteResults(const TSharedRef<FJsonObject>& Results)
+{
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Results, Writer);
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("HoffmannMehat-%s.json"), *FDateTime::Now().ToString());
+	if (!FFileHelper::SaveStringToFile(Json, *Path))
+	{
+		UE_LOG(LogHoffmannMehatBenchmark, Error, TEXT("Failed to write %s"), *Path);
+	}
+	return Path;
+}
+
+bool FHoffmannMehatBenchmark::CompareToBaseline(const TSharedRef<FJsonObject>& Results, TArray<FString>& OutErrors)
+{
+	FString Json;
+	TSharedPtr<FJsonObject> Baseline;
+	if (!FFileHelper::LoadFileToString(Json, *HoffmannMehatBenchmark::GetBaselinePath()) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Baseline) || !Baseline.IsValid())
+	{
+		return false;
+	}
+
+	const double Tolerance = HoffmannMehatBenchmark::CVarTolerance.GetValueOnGameThread();
+	auto Check = [Tolerance, &OutErrors](const FString& Name, double Value, double BaselineValue)
+	{
+		if (BaselineValue > 0.0 && Value > BaselineValue * (1.0 + Tolerance))
+		{
+			OutErrors.Add(FString::Printf(TEXT("%s regressed: %.4f against %.4f in the baseline"), *Name, Value, BaselineValue));
+		}
+	};
+
+	// micro benchmarks by time per operation, skipped ones have none
+	const TSharedPtr<FJsonObject>* Micro;
+	const TSharedPtr<FJsonObject>* BaselineMicro;
+	if (Results->TryGetObjectField(TEXT("micro"), Micro) && Baseline->TryGetObjectField(TEXT("micro"), BaselineMicro))
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*Micro)->Values)
+		{
+			const TSharedPtr<FJsonObject>* Timing;
+			const TSharedPtr<FJsonObject>* BaselineTiming;
+			double NsPerOp, BaselineNsPerOp;
+			if (Pair.Value->TryGetObject(Timing) && (*BaselineMicro)->TryGetObjectField(Pair.Key, BaselineTiming)
+				&& (*Timing)->TryGetNumberField(TEXT("ns_per_op"), NsPerOp) && (*BaselineTiming)->TryGetNumberField(TEXT("ns_per_op"), BaselineNsPerOp))
+			{
+				Check(Pair.Key + TEXT(" ns_per_op"), NsPerOp, BaselineNsPerOp);
+			}
+		}
+	}
+
+	// sessions by their 95th percentiles, only against a baseline with as many targets and shots
+	const TSharedPtr<FJsonObject>* Session;
+	const TSharedPtr<FJsonObject>* BaselineSession;
+	bool bShots = true;
+	bool bBaselineShots = true;
+	if (Results->TryGetObjectField(TEXT("Session"), Session) && Baseline->TryGetObjectField(TEXT("Session"), BaselineSession)
+		&& (*Session)->GetIntegerField(TEXT("targets")) == (*BaselineSession)->GetIntegerField(TEXT("targets"))
+		&& (*Session)->TryGetBoolField(TEXT("shots"), bShots) == (*BaselineSession)->TryGetBoolField(TEXT("shots"), bBaselineShots)
+		&& bShots == bBaselineShots)
+	{
+		static const TCHAR* Distributions[] = { TEXT("frame_ms"), TEXT("game_thread_ms"), TEXT("HUD.DrawHUD_ms") };
+		for (const TCHAR* Name : Distributions)
+		{
+			const TSharedPtr<FJsonObject>* Distribution;
+			const TSharedPtr<FJsonObject>* BaselineDistribution;
+			double P95, BaselineP95;
+			if ((*Session)->TryGetObjectField(Name, Distribution) && (*BaselineSession)->TryGetObjectField(Name, BaselineDistribution)
+				&& (*Distribution)->TryGetNumberField(TEXT("p95"), P95) && (*BaselineDistribution)->TryGetNumberField(TEXT("p95"), BaselineP95))
+			{
+				Check(FString::Printf(TEXT("Session %s p95"), Name), P95, BaselineP95);
+			}
+		}
+	}
+
+	return true;
+}
+
+TSharedRef<FJsonObject> FHoffmannMehatBenchmark::RunMicroBenchmarks(UWorld* World)
+{
+	using namespace HoffmannMehatBenchmark;
+
+	TSharedRef<FJsonObject> Micro = MakeShared<FJsonObject>();
+
+	// Response curve, sweeping the full input domain
+	{
+		double Start = FPlatformTime::Seconds();
+		float Sum = 0.f;
+		for (int32 Index = 0; Index < CurveIterations; ++Index)
+		{
+			Sum += CalcXInputRate((Index % 10001) * 0.01f);
+		}
+		Micro->SetObjectField(TEXT("Curve.CalcXInputRate"), MakeTiming(FPlatformTime::Seconds() - Start, CurveIterations));
+
+		Start = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < CurveIterations; ++Index)
+		{
+			Sum += CalcYInputRate((Index % 10001) * 0.01f);
+		}
+		Micro->SetObjectField(TEXT("Curve.CalcYInputRate"), MakeTiming(FPlatformTime::Seconds() - Start, CurveIterations));
+		Sink = Sum;
+	}
+
+	AHoffmannMehatCharacter* Character = FindCharacter(World);
+	if (Character == nullptr)
+	{
+		Micro->SetObjectField(TEXT("Character.TurnAtRate"), MakeSkipped(TEXT("no AHoffmannMehatCharacter possessed")));
+		Micro->SetObjectField(TEXT("Character.LookUpAtRate"), MakeSkipped(TEXT("no AHoffmannMehatCharacter possessed")));
+		Micro->SetObjectField(TEXT("Character.OnFire"), MakeSkipped(TEXT("no AHoffmannMehatCharacter possessed")));
+	}
+	else
+	{
+		APlayerController* Controller = World->GetFirstPlayerController();
+
+		// Full look handlers, dead zone and curve included. The aim simulation only advances once
+		// per frame, so it's reset to make every call a frame's worth of substeps.
+		double Start = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < LookIterations; ++Index)
+		{
+			Character->ResetAimSimulation();
+			Character->TurnAtRate(FMath::Sin(Index * 0.001f));
+		}
+		Micro->SetObjectField(TEXT("Character.TurnAtRate"), MakeTiming(FPlatformTime::Seconds() - Start, LookIterations));
+
+		Start = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < LookIterations; ++Index)
+		{
+			Character->ResetAimSimulation();
+			Character->LookUpAtRate(FMath::Sin(Index * 0.001f));
+		}
+		Micro->SetObjectField(TEXT("Character.LookUpAtRate"), MakeTiming(FPlatformTime::Seconds() - Start, LookIterations));
+
+		// Don't apply a hundred thousand frames of look input on the next tick
+		Controller->RotationInput = FRotator::ZeroRotator;
+		Character->ResetAimSimulation();
+
+		// Projectile fire, spawn, sound and animation included
+		TArray<TWeakObjectPtr<AActor>> Spawned;
+		const int32 ShotsBefore = Character->NumFire;
+		{
+			FScopedSpawnCapture Capture(World, Spawned);
+			Start = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < SpawnIterations; ++Index)
+			{
+				Character->OnFire();
+			}
+			Micro->SetObjectField(TEXT("Character.OnFire"), MakeTiming(FPlatformTime::Seconds() - Start, SpawnIterations));
+		}
+		DestroyAll(Spawned);
+		Character->NumFire = ShotsBefore;
+	}
+
+	const APlayerController* Controller = World ? World->GetFirstPlayerController() : nullptr;
+	AHoffmannMehatHUD* HUD = Controller ? Cast<AHoffmannMehatHUD>(Controller->GetHUD()) : nullptr;
+	if (HUD == nullptr)
+	{
+		Micro->SetObjectField(TEXT("HUD.DrawHUD"), MakeSkipped(TEXT("no AHoffmannMehatHUD")));
+	}
+	else if (!FApp::CanEverRender())
+	{
+		Micro->SetObjectField(TEXT("HUD.DrawHUD"), MakeSkipped(TEXT("needs a renderer")));
+	}
+	else
+	{
+		// Game thread side of the HUD, drawn into an offscreen canvas
+		UTextureRenderTarget2D* RenderTarget = NewObject<UTextureRenderTarget2D>();
+		RenderTarget->InitAutoFormat(HUDCanvasSize.X, HUDCanvasSize.Y);
+		RenderTarget->UpdateResourceImmediate(true);
+
+		FCanvas RenderCanvas(RenderTarget->GameThread_GetRenderTargetResource(), nullptr, World, World->FeatureLevel);
+		UCanvas* Canvas = World->GetCanvasForDrawMaterialToRenderTarget();
+		Canvas->Init(HUDCanvasSize.X, HUDCanvasSize.Y, nullptr, &RenderCanvas);
+		Canvas->Update();
+
+		UCanvas* const ViewportCanvas = HUD->Canvas;
+		HUD->Canvas = Canvas;
+
+		// the first draw rebuilds the crosshair for the canvas size
+		HUD->DrawHUD();
+		RenderCanvas.Flush_GameThread();
+
+		uint32 Cycles = 0;
+		for (int32 Index = 0; Index < HUDIterations; ++Index)
+		{
+			const uint32 StartCycles = FPlatformTime::Cycles();
+			HUD->DrawHUD();
+			Cycles += FPlatformTime::Cycles() - StartCycles;
+
+			// outside the timing, so the batched draws don't pile up
+			RenderCanvas.Flush_GameThread();
+		}
+		Micro->SetObjectField(TEXT("HUD.DrawHUD"), MakeTiming(FPlatformTime::ToSeconds(Cycles), HUDIterations));
+
+		HUD->Canvas = ViewportCanvas;
+		Canvas->Canvas = nullptr;
+		FlushRenderingCommands();
+	}
+
+	TActorIterator<ASpawnVolume> SpawnVolumeIt(World);
+	if (!SpawnVolumeIt)
+	{
+		Micro->SetObjectField(TEXT("SpawnVolume.SpawnPickup"), MakeSkipped(TEXT("no ASpawnVolume in the map")));
+	}
+	else
+	{
+		TArray<TWeakObjectPtr<AActor>> Spawned;
+		{
+			FScopedSpawnCapture Capture(World, Spawned);
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < SpawnIterations; ++Index)
+			{
+				SpawnVolumeIt->SpawnPickup();
+			}
+			Micro->SetObjectField(TEXT("SpawnVolume.SpawnPickup"), MakeTiming(FPlatformTime::Seconds() - Start, SpawnIterations));
+		}
+		DestroyAll(Spawned);
+	}
+
+	return Micro;
+}
+
+void FHoffmannMehatBenchmark::BeginSession()
+{
+	UWorld* SessionWorld = World.Get();
+	AHoffmannMehatCharacter* Character = HoffmannMehatBenchmark::FindCharacter(SessionWorld);
+
+	HoffmannMehatBenchmark::FScopedSpawnCapture Capture(SessionWorld, SpawnedActors);
+
+	// Use the map's spawn volume when there is one, so the session spawns the drill's real targets
+	TActorIterator<ASpawnVolume> SpawnVolumeIt(SessionWorld);
+	for (int32 Index = 0; Index < NumTargets; ++Index)
+	{
+		if (SpawnVolumeIt)
+		{
+			SpawnVolumeIt->SpawnPickup();
+		}
+		else if (Character != nullptr)
+		{
+			const FVector Location = Character->GetActorLocation() + Character->GetActorForwardVector() * 2000.f + FMath::VRand() * 500.f;
+			SessionWorld->SpawnActor<ATheFirstActor>(ATheFirstActor::StaticClass(), Location, FRotator::ZeroRotator);
+		}
+	}
+
+	FrameTimes.Reserve(NumFrames);
+	GameThreadTimes.Reserve(NumFrames);
+	DrawHUDTimes.Reserve(NumFrames);
+	FrameAllocs.Reserve(NumFrames);
+	ScopeAllocs.Init(0, (int32)EHoffmannMehatScope::Num);
+
+	FHoffmannMehatAllocCounter::Start();
+}
+
+void FHoffmannMehatBenchmark::DriveInput(int32 InFrame)
+{
+	AHoffmannMehatCharacter* Character = HoffmannMehatBenchmark::FindCharacter(World.Get());
+	if (Character == nullptr)
+	{
+		return;
+	}
+
+	// Deterministic sweeps on both axes with a shot every tenth frame. The override goes through
+	// the input component's own calls, so the aim simulation still advances once per frame.
+	Character->SetLookInputOverride(FVector2D(FMath::Sin(InFrame * 0.05f), 0.5f * FMath::Sin(InFrame * 0.031f)));
+	if (bFire && InFrame % 10 == 0)
+	{
+		Character->OnFire();
+	}
+}
+
+void FHoffmannMehatBenchmark::Tick(float DeltaTime)
+{
+	UWorld* SessionWorld = World.Get();
+	if (SessionWorld == nullptr)
+	{
+		if (Frame > 0)
+		{
+			FHoffmannMehatAllocCounter::Stop();
+		}
+		bFinished = true;
+		return;
+	}
+
+	if (Frame == 0)
+	{
+		BeginSession();
+	}
+	else
+	{
+		FrameTimes.Add(DeltaTime * 1000.f);
+		GameThreadTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+		const APlayerController* Controller = SessionWorld->GetFirstPlayerController();
+		const AHoffmannMehatHUD* HUD = Controller ? Cast<AHoffmannMehatHUD>(Controller->GetHUD()) : nullptr;
+		if (HUD != nullptr)
+		{
+			DrawHUDTimes.Add(HUD->GetLastDrawHUDMilliseconds());
+		}
+
+		// The first quarter warms up pools and arrays, after that a frame's
+		// allocations are what every frame of a drill costs
+		if (Frame > NumFrames / 4)
+		{
+			const uint32 Allocs = FHoffmannMehatAllocCounter::GetLastFrameTotal();
+			FrameAllocs.Add(Allocs);
+			FramesOverBudget += (int32)Allocs > AllocBudget ? 1 : 0;
+			for (int32 Scope = 0; Scope < ScopeAllocs.Num(); ++Scope)
+			{
+				ScopeAllocs[Scope] += FHoffmannMehatAllocCounter::GetLastFrameAllocs((EHoffmannMehatScope)Scope);
+			}
+		}
+	}
+
+	DriveInput(Frame);
+
+	if (++Frame > NumFrames)
+	{
+		EndSession();
+	}
+}
+
+TSharedRef<FJsonObject> FHoffmannMehatBenchmark::CheckAllocations()
+{
+	if (!FHoffmannMehatAllocCounter::IsAvailable())
+	{
+		return HoffmannMehatBenchmark::MakeSkipped(TEXT("allocations are only counted with -CountAllocs"));
+	}
+	if (bFire)
+	{
+		return HoffmannMehatBenchmark::MakeSkipped(TEXT("shots spawn projectiles and grow the recording, run with NoFire"));
+	}
+
+	TSharedRef<FJsonObject> Check = MakeShared<FJsonObject>();
+	Check->SetNumberField(TEXT("budget"), AllocBudget);
+	Check->SetNumberField(TEXT("frames_checked"), FrameAllocs.Num());
+	Check->SetNumberField(TEXT("frames_over_budget"), FramesOverBudget);
+	Check->SetBoolField(TEXT("passed"), FramesOverBudget == 0);
+
+	TSharedRef<FJsonObject> ByScope = MakeShared<FJsonObject>();
+	for (int32 Scope = 0; Scope < ScopeAllocs.Num(); ++Scope)
+	{
+		ByScope->SetNumberField(FHoffmannMehatAllocCounter::GetScopeName((EHoffmannMehatScope)Scope), ScopeAllocs[Scope]);
+	}
+	Check->SetObjectField(TEXT("steady_state_allocs"), ByScope);
+
+	if (FramesOverBudget > 0)
+	{
+		AllocationErrors.Add(FString::Printf(TEXT("%d of %d steady state frames allocated more than %d times"), FramesOverBudget, FrameAllocs.Num(), AllocBudget));
+		for (int32 Scope = 0; Scope < ScopeAllocs.Num(); ++Scope)
+		{
+			if (ScopeAllocs[Scope] > 0)
+			{
+				AllocationErrors.Add(FString::Printf(TEXT("%s: %u allocations"), FHoffmannMehatAllocCounter::GetScopeName((EHoffmannMehatScope)Scope), ScopeAllocs[Scope]));
+			}
+		}
+	}
+
+	for (const FString& Error : AllocationErrors)
+	{
+		UE_LOG(LogHoffmannMehatBenchmark, Error, TEXT("Allocation check failed: %s"), *Error);
+	}
+	return Check;
+}
+
+void FHoffmannMehatBenchmark::EndSession()
+{
+	using namespace HoffmannMehatBenchmark;
+
+	TSharedRef<FJsonObject> Session = MakeShared<FJsonObject>();
+	Session->SetNumberField(TEXT("targets"), NumTargets);
+	Session->SetBoolField(TEXT("shots"), bFire);
+	Session->SetNumberField(TEXT("frames"), FrameTimes.Num());
+	Session->SetObjectField(TEXT("frame_ms"), MakeDistribution(FrameTimes));
+	Session->SetObjectField(TEXT("game_thread_ms"), MakeDistribution(GameThreadTimes));
+	Session->SetObjectField(TEXT("HUD.DrawHUD_ms"), MakeDistribution(DrawHUDTimes));
+	Session->SetObjectField(TEXT("allocs_per_frame"), MakeDistribution(FrameAllocs));
+	Session->SetObjectField(TEXT("alloc_check"), CheckAllocations());
+	Results->SetObjectField(TEXT("Session"), Session);
+
+	FHoffmannMehatAllocCounter::Stop();
+
+	const FString Path = WriteResults(Results);
+	UE_LOG(LogHoffmannMehatBenchmark, Display, TEXT("Benchmark results written to %s"), *Path);
+
+	if (!CompareToBaseline(Results, RegressionErrors))
+	{
+		UE_LOG(LogHoffmannMehatBenchmark, Display, TEXT("No baseline at %s, nothing to compare against"), *GetBaselinePath());
+	}
+	for (const FString& Error : RegressionErrors)
+	{
+		UE_LOG(LogHoffmannMehatBenchmark, Error, TEXT("%s"), *Error);
+	}
+
+	DestroyAll(SpawnedActors);
+	bSessionComplete = true;
+	bFinished = true;
+
+	if (AHoffmannMehatCharacter* Character = FindCharacter(World.Get()))
+	{
+		Character->ClearLookInputOverride();
+	}
+
+	if (bQuitWhenDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, AllocationErrors.Num() == 0 && RegressionErrors.Num() == 0 ? 0 : 1);
+	}
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace HoffmannMehatBenchmark
+{
+	/** The world a game or PIE session is playing in */
+	static UWorld* FindGameWorld()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World() != nullptr)
+			{
+				return Context.World();
+			}
+		}
+		return nullptr;
+	}
+}
+
+/** Waits for a session to end, then fails Test with its allocation or its regression errors */
+DEFINE_LATENT_AUTOMATION_COMMAND_THREE_PARAMETER(FWaitForBenchmarkSession, TSharedPtr<FHoffmannMehatBenchmark>, Benchmark, FAutomationTestBase*, Test, bool, bCheckAllocations);
+
+bool FWaitForBenchmarkSession::Update()
+{
+	if (!Benchmark->IsFinished())
+	{
+		return false;
+	}
+
+	if (!Benchmark->IsSessionComplete())
+	{
+		Test->AddError(TEXT("The world went away before the session finished"));
+	}
+	for (const FString& Error : bCheckAllocations ? Benchmark->GetAllocationErrors() : Benchmark->GetRegressionErrors())
+	{
+		Test->AddError(Error);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoffmannMehatMicroBenchTest, "HoffmannMehat.Bench.Micro", EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FHoffmannMehatMicroBenchTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = HoffmannMehatBenchmark::FindGameWorld();
+	if (World == nullptr)
+	{
+		AddError(TEXT("Needs a game world"));
+		return false;
+	}
+
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+	Results->SetObjectField(TEXT("meta"), HoffmannMehatBenchmark::MakeMeta(World));
+	Results->SetObjectField(TEXT("micro"), FHoffmannMehatBenchmark::RunMicroBenchmarks(World));
+	AddInfo(FString::Printf(TEXT("Results written to %s"), *FHoffmannMehatBenchmark::WriteResults(Results)));
+
+	TArray<FString> Errors;
+	if (!FHoffmannMehatBenchmark::CompareToBaseline(Results, Errors))
+	{
+		AddInfo(FString::Printf(TEXT("No baseline at %s, nothing to compare against"), *HoffmannMehatBenchmark::GetBaselinePath()));
+	}
+	for (const FString& Error : Errors)
+	{
+		AddError(Error);
+	}
+	return Errors.Num() == 0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoffmannMehatSessionBenchTest, "HoffmannMehat.Bench.Session", EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FHoffmannMehatSessionBenchTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = HoffmannMehatBenchmark::FindGameWorld();
+	if (HoffmannMehatBenchmark::FindCharacter(World) == nullptr)
+	{
+		AddError(TEXT("Needs a map with an AHoffmannMehatCharacter possessed"));
+		return false;
+	}
+
+	TSharedPtr<FHoffmannMehatBenchmark> Benchmark = MakeShared<FHoffmannMehatBenchmark>(World, 50, 600, 0, true, false);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForBenchmarkSession(Benchmark, this, false));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoffmannMehatSteadyStateAllocsTest, "HoffmannMehat.Bench.SteadyStateAllocs", EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FHoffmannMehatSteadyStateAllocsTest::RunTest(const FString& Parameters)
+{
+	if (!FHoffmannMehatAllocCounter::IsAvailable())
+	{
+		AddError(TEXT("Allocations are only counted with -CountAllocs on the command line"));
+		return false;
+	}
+
+	UWorld* World = HoffmannMehatBenchmark::FindGameWorld();
+	if (HoffmannMehatBenchmark::FindCharacter(World) == nullptr)
+	{
+		AddError(TEXT("Needs a map with an AHoffmannMehatCharacter possessed"));
+		return false;
+	}
+
+	// no shots, see CheckAllocations
+	TSharedPtr<FHoffmannMehatBenchmark> Benchmark = MakeShared<FHoffmannMehatBenchmark>(World, 50, 600, 0, false, false);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForBenchmarkSession(Benchmark, this, true));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Dom/JsonObject.h"
+
+class AActor;
+class UWorld;
+
+/**
+ * Benchmarks for the gameplay hot paths, run as automation tests in a game world with the
+ * character possessed:
+ *
+ *	HoffmannMehat.Bench.Micro - tight loops over the curves, look handlers, OnFire, SpawnPickup and DrawHUD
+ *	HoffmannMehat.Bench.Session - frames of a scripted session with targets, look input and shots
+ *	HoffmannMehat.Bench.SteadyStateAllocs - the session without shots, checking allocations, needs -CountAllocs
+ *
+ * Every run is written to Saved/Benchmarks as JSON, with stable result names so runs can be
+ * diffed. A result more than HoffmannMehat.BenchTolerance slower than the same result in
+ * Saved/Benchmarks/HoffmannMehat-Baseline.json fails its test; copy a run there to make it the
+ * baseline. For a run that exits with status 1 on a regression or a failed allocation check,
+ * headless with -nullrhi:
+ *
+ *	-nullrhi -CountAllocs -ExecCmds="HoffmannMehat.Bench Targets=100 NoFire Quit"
+ *
+ * After the first quarter of the session, a frame that allocates more than AllocBudget times
+ * inside our scopes (default 0) fails the allocation check. Only sessions without shots are
+ * checked: a shot spawns a projectile actor, unless the drill batches them, and adds to the
+ * session recording.
+ */
+class FHoffmannMehatBenchmark : public FTickableGameObject
+{
+public:
+	FHoffmannMehatBenchmark(UWorld* InWorld, int32 InNumTargets, int32 InNumFrames, int32 InAllocBudget, bool bInFire, bool bInQuitWhenDone);
+
+	/** Runs the micro benchmarks and returns them keyed by name */
+	static TSharedRef<FJsonObject> RunMicroBenchmarks(UWorld* World);
+
+	/**
+	 * Adds an error to OutErrors for every result in Results more than HoffmannMehat.BenchTolerance
+	 * slower than the baseline's. Returns false if there is no baseline to compare against.
+	 */
+	static bool CompareToBaseline(const TSharedRef<FJsonObject>& Results, TArray<FString>& OutErrors);
+
+	/** Writes Results to Saved/Benchmarks, returning the file's path */
+	static FString WriteResults(const TSharedRef<FJsonObject>& Results);
+
+	/** Adds a section, e.g. the micro benchmarks, to the results written at the end of the session */
+	void AddResults(const FString& Name, const TSharedRef<FJsonObject>& Section) { Results->SetObjectField(Name, Section); }
+
+	/** Mean, p50, p95, p99 and max of a set of samples */
+	static TSharedRef<FJsonObject> MakeDistribution(TArray<float> Samples);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !bFinished; }
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	bool IsFinished() const { return bFinished; }
+
+	/** Whether the session ran to the end, rather than its world going away */
+	bool IsSessionComplete() const { return bSessionComplete; }
+
+	/** What failed the allocation check, empty if it passed or allocations weren't counted */
+	const TArray<FString>& GetAllocationErrors() const { return AllocationErrors; }
+
+	/** Results slower than the baseline's, empty if there were none or there is no baseline */
+	const TArray<FString>& GetRegressionErrors() const { return RegressionErrors; }
+
+private:
+	/** Spawns the session's targets and records the frame the session started */
+	void BeginSession();
+
+	/** Writes the results and destroys everything the session spawned */
+	void EndSession();
+
+	/** Drives the character like a player would for one frame */
+	void DriveInput(int32 Frame);
+
+	/** Steady state allocations against AllocBudget, fills AllocationErrors */
+	TSharedRef<FJsonObject> CheckAllocations();
+
+	TWeakObjectPtr<UWorld> World;
+	int32 NumTargets;
+	int32 NumFrames;
+	int32 AllocBudget;
+	int32 Frame;
+
+	/** Fire every tenth frame, turns the allocation check off */
+	bool bFire;
+
+	bool bQuitWhenDone;
+	bool bFinished;
+	bool bSessionComplete;
+
+	TSharedRef<FJsonObject> Results;
+	TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+
+	/** Per frame samples, in milliseconds */
+	TArray<float> FrameTimes;
+	TArray<float> GameThreadTimes;
+	TArray<float> DrawHUDTimes;
+
+	/** Allocations inside our scopes per steady state frame, and their totals by scope */
+	TArray<float> FrameAllocs;
+	TArray<uint32> ScopeAllocs;
+
+	/** Steady state frames with more allocations than AllocBudget */
+	int32 FramesOverBudget;
+
+	TArray<FString> AllocationErrors;
+	TArray<FString> RegressionErrors;
+};
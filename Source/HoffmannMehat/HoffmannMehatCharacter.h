@@ -4,15 +4,41 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "AimSimulation.h"
 #include "HoffmannMehatCharacter.generated.h"
 
 class UInputComponent;
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnShotsFiredChanged, int32, ShotsFired);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnHealthChanged, float, Health, float, MaxHealth);
+
+/** Latest look input and what the response curve made of it, read by the HUD's performance overlay */
+struct FLookInputTelemetry
+{
+	/** Stick values as they came in from the input component */
+	float RawX = 0.f;
+	float RawY = 0.f;
+
+	/** Normalized rates after the dead zone and response curve */
+	float CurveX = 0.f;
+	float CurveY = 0.f;
+
+	/** FPlatformTime::Seconds() of the last look sample */
+	double SampleSeconds = 0.0;
+
+	/** Number of times a look axis changed value, never reset */
+	uint32 NumInputEvents = 0;
+};
+
 UCLASS(config=Game)
 class AHoffmannMehatCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	/** Drive the protected input handlers directly */
+	friend class FHoffmannMehatBenchmark;
+	friend class FAimBotDriver;
+
 	/** Pawn mesh: 1st person view (arms; seen only by self) */
 	UPROPERTY(VisibleDefaultsOnly, Category=Mesh)
 	class USkeletalMeshComponent* Mesh1P;
@@ -37,14 +63,34 @@ class AHoffmannMehatCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FirstPersonCameraComponent;
 
-	/** Motion controller (right hand) */
+	/** Motion controller (right hand), only registered with bUsingMotionControllers */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	class UMotionControllerComponent* R_MotionController;
 
-	/** Motion controller (left hand) */
+	/** Motion controller (left hand), only registered with bUsingMotionControllers */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	class UMotionControllerComponent* L_MotionController;
 
+	/** Records the shot and camera stream for the post-session review */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Statistics, meta = (AllowPrivateAccess = "true"))
+	class UAimSessionRecorder* SessionRecorder;
+
+	/** Scores time on target in tracking drills */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Statistics, meta = (AllowPrivateAccess = "true"))
+	class UTrackingScoreComponent* TrackingScore;
+
+	/** Preallocated voices for the fire, hit and kill sounds */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Audio, meta = (AllowPrivateAccess = "true"))
+	class UFeedbackAudioComponent* FeedbackAudio;
+
+	/** Procedural recoil of the first person arms and gun */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Gameplay, meta = (AllowPrivateAccess = "true"))
+	class UWeaponKickComponent* WeaponKick;
+
+	/** Runs alternative response curves next to the live one without moving the camera */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Statistics, meta = (AllowPrivateAccess = "true"))
+	class UAimShadowComponent* AimShadow;
+
 public:
 	AHoffmannMehatCharacter();
 
@@ -67,6 +113,49 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = Gameplay)
 	float DeadZone;
 
+	/** Integrate look input in fixed substeps instead of once per frame, making aim frame rate independent */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera)
+	bool bFixedStepAim;
+
+	/** Rate of the fixed step aim simulation (Hz) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera, meta = (ClampMin = "30"))
+	float AimStepRate;
+
+	/** Most substeps simulated in one frame, time beyond that is dropped after a hitch. 125 at 500 Hz is a 250 ms frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera, meta = (ClampMin = "1"))
+	int32 MaxAimSubsteps;
+
+	/** Drops time and rotation the fixed step simulation has accumulated, e.g. after a teleport or pause */
+	UFUNCTION(BlueprintCallable, Category = Camera)
+	void ResetAimSimulation();
+
+	/**
+	 * Apply look input at the end of the frame from the freshest stick sample, rather than when
+	 * the input component runs. Needs AHoffmannMehatPlayerCameraManager, without it look input
+	 * is applied as usual.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera)
+	bool bLateLatchAim;
+
+	/** True if look input is being left to the camera manager this frame */
+	bool IsLateLatchingAim() const;
+
+	/** Stick values the input component delivered this frame while late latching */
+	void GetPendingLookInput(float& OutXRate, float& OutYRate, double& OutSampleSeconds) const;
+
+	/**
+	 * Runs the look pipeline for the late latched stick values
+	 * @param SampleSeconds	FPlatformTime::Seconds() the stick values are current as of
+	 * @param OutYawInput	Yaw to apply, in the units of AddControllerYawInput
+	 * @param OutPitchInput	Pitch to apply, in the units of AddControllerPitchInput
+	 */
+	void LatchLookInput(float xRate, float yRate, double SampleSeconds, float& OutYawInput, float& OutPitchInput);
+
+	/** Replaces the look stick with a scripted value until cleared, e.g. for the aim bot */
+	void SetLookInputOverride(const FVector2D& Stick) { LookInputOverride = Stick; }
+	void ClearLookInputOverride() { LookInputOverride.Reset(); }
+	bool HasLookInputOverride() const { return LookInputOverride.IsSet(); }
+
 
 	/** Projectile class to spawn */
 	UPROPERTY(EditDefaultsOnly, Category=Projectile)
@@ -76,22 +165,53 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	class USoundBase* FireSound;
 
-	/** AnimMontage to play each time we fire */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-	class UAnimMontage* FireAnimation;
+	/** Kept so the Blueprints that set it still load, firing uses WeaponKick now */
+	UPROPERTY(BlueprintReadWrite, Category = Gameplay, meta = (DeprecatedProperty, DeprecationMessage = "Firing no longer plays a montage, the WeaponKick component kicks the arms and gun."))
+	class UAnimMontage* FireAnimation_DEPRECATED;
 
-	/** Whether to use motion controller location for aiming. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	/** Whether to use motion controller location for aiming. Set it through SetUsingMotionControllers once play has begun. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetUsingMotionControllers, Category = Gameplay)
 	uint32 bUsingMotionControllers : 1;
 
+	/** Switches between the first person and motion controller guns, registering only the set in use */
+	UFUNCTION(BlueprintSetter)
+	void SetUsingMotionControllers(bool bUsing);
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Statistics)
 		int NumFire;
 
+	/** Fired whenever OnFire counts a shot */
+	UPROPERTY(BlueprintAssignable, Category = Statistics)
+	FOnShotsFiredChanged OnShotsFiredChanged;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Health)
+	float MaxHealth;
+
+	/** Sets health, clamped to [0, MaxHealth], and notifies the HUD */
+	UFUNCTION(BlueprintCallable, Category = Health)
+	void SetHealth(float NewHealth);
+
+	UFUNCTION(BlueprintPure, Category = Health)
+	float GetHealth() const { return Health; }
+
+	/** Fired when SetHealth changes health */
+	UPROPERTY(BlueprintAssignable, Category = Health)
+	FOnHealthChanged OnHealthChanged;
+
 protected:
 	
 	/** Fires a projectile. */
 	void OnFire();
 
+	/** Hands a ProjectileClass shot to the projectile manager if the drill batches shots, otherwise spawns the actor */
+	void FireProjectile(const FVector& SpawnLocation, const FRotator& SpawnRotation);
+
+	/** Registers the gun components bUsingMotionControllers needs and unregisters the other set */
+	void UpdateGunComponents();
+
+	/** Registers and activates Component, or deactivates and unregisters it */
+	static void SetGunComponentInUse(class USceneComponent* Component, bool bInUse);
+
 	/** Resets HMD orientation and position in VR. */
 	void OnResetVR();
 
@@ -101,6 +221,12 @@ protected:
 	/** Handles stafing movement, left and right */
 	void MoveRight(float Val);
 
+	/** Mouse turn, applied as is. The shadow curves follow it like the view. */
+	void Turn(float Val);
+
+	/** Mouse look up/down, applied as is */
+	void LookUp(float Val);
+
 	/**
 	 * Called via input to turn at a given rate.
 	 * @param Rate	This is a normalized rate, i.e. 1.0 means 100% of desired turn rate
@@ -113,6 +239,15 @@ protected:
 	 */
 	void LookUpAtRate(float Rate);
 
+	/** Dead zone, response curve and integration of a turn rate, returns the yaw input for this frame */
+	float CalcTurnInput(float xRate);
+
+	/** Same as CalcTurnInput for look up/down */
+	float CalcLookUpInput(float yRate);
+
+	/** Tells the session recorder when the stick leaves the dead zone, the start of a reaction */
+	void UpdateLookActivity();
+
 	struct TouchData
 	{
 		TouchData() { bIsPressed = false;Location=FVector::ZeroVector;}
@@ -125,6 +260,27 @@ protected:
 	void EndTouch(const ETouchIndex::Type FingerIndex, const FVector Location);
 	void TouchUpdate(const ETouchIndex::Type FingerIndex, const FVector Location);
 	TouchData	TouchItem;
+
+	FLookInputTelemetry LookTelemetry;
+
+	/** Both look axes were inside the dead zone at the last sample */
+	bool bLookAtRest;
+
+	/** Fixed step simulation of each look axis */
+	FFixedStepAimAxis TurnAxis;
+	FFixedStepAimAxis LookUpAxis;
+
+	/** Stick value used instead of the player's, if set */
+	TOptional<FVector2D> LookInputOverride;
+
+	/** Latest look stick values while late latching */
+	FVector2D PendingLookInput;
+	double PendingLookSampleSeconds;
+
+	/** FPlatformTime::Seconds() the look stick this frame is current as of */
+	double GetLookSampleSeconds() const;
+
+	float Health;
 	
 protected:
 	// APawn interface
@@ -144,6 +300,18 @@ public:
 	FORCEINLINE class USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
 	/** Returns FirstPersonCameraComponent subobject **/
 	FORCEINLINE class UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
+	/** Returns the latest look input sample **/
+	FORCEINLINE const FLookInputTelemetry& GetLookTelemetry() const { return LookTelemetry; }
+	/** Returns SessionRecorder subobject **/
+	FORCEINLINE class UAimSessionRecorder* GetSessionRecorder() const { return SessionRecorder; }
+	/** Returns TrackingScore subobject **/
+	FORCEINLINE class UTrackingScoreComponent* GetTrackingScore() const { return TrackingScore; }
+	/** Returns FeedbackAudio subobject **/
+	FORCEINLINE class UFeedbackAudioComponent* GetFeedbackAudio() const { return FeedbackAudio; }
+	/** Returns WeaponKick subobject **/
+	FORCEINLINE class UWeaponKickComponent* GetWeaponKick() const { return WeaponKick; }
+	/** Returns AimShadow subobject **/
+	FORCEINLINE class UAimShadowComponent* GetAimShadow() const { return AimShadow; }
 
 };
 
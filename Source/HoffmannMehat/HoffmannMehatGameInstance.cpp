@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HoffmannMehatGameInstance.h"
+#include "ProfileSaveService.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "UObject/UObjectGlobals.h"
+
+void UHoffmannMehatGameInstance::Init()
+{
+	Super::Init();
+
+	SaveService = NewObject<UProfileSaveService>(this);
+
+	SelectedScenario = nullptr;
+	PreloadProgress = 0.f;
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UHoffmannMehatGameInstance::OnPostLoadMap);
+}
+
+void UHoffmannMehatGameInstance::Shutdown()
+{
+	// Don't lose a game over save that is still on its way to the disk
+	if (SaveService != nullptr)
+	{
+		SaveService->Flush();
+	}
+
+	CancelPreload();
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	Super::Shutdown();
+}
+
+void UHoffmannMehatGameInstance::PreloadMap(TSoftObjectPtr<UWorld> Map)
+{
+	if (Map.IsNull() || Map == PreloadingMap)
+	{
+		return;
+	}
+
+	CancelPreload();
+
+	PreloadingMap = Map;
+	PreloadProgress = 0.f;
+	PreloadTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UHoffmannMehatGameInstance::TickPreload));
+
+	// The world's hard references come in with its package
+	PreloadHandle = StreamableManager.RequestAsyncLoad(Map.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &UHoffmannMehatGameInstance::OnPreloadComplete), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UHoffmannMehatGameInstance::CancelPreload()
+{
+	if (PreloadHandle.IsValid())
+	{
+		PreloadHandle->CancelHandle();
+		PreloadHandle.Reset();
+	}
+
+	if (PreloadTickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(PreloadTickerHandle);
+		PreloadTickerHandle.Reset();
+	}
+
+	PreloadingMap.Reset();
+	PendingOpenMap.Reset();
+	PreloadProgress = 0.f;
+}
+
+void UHoffmannMehatGameInstance::OpenMap(TSoftObjectPtr<UWorld> Map)
+{
+	if (Map.IsNull())
+	{
+		return;
+	}
+
+	if (Map == PreloadingMap && PreloadHandle.IsValid() && !PreloadHandle->HasLoadCompleted())
+	{
+		PendingOpenMap = Map;
+		return;
+	}
+
+	TravelTo(Map);
+}
+
+bool UHoffmannMehatGameInstance::TickPreload(float DeltaTime)
+{
+	if (!PreloadHandle.IsValid())
+	{
+		PreloadTickerHandle.Reset();
+		return false;
+	}
+
+	float NewProgress = 1.f;
+	if (!PreloadHandle->HasLoadCompleted())
+	{
+		// -1 until the package has been queued
+		const FName PackageName(*PreloadingMap.GetLongPackageName());
+		NewProgress = FMath::Clamp(GetAsyncLoadPercentage(PackageName) / 100.f, 0.f, 0.99f);
+	}
+
+	if (NewProgress != PreloadProgress)
+	{
+		PreloadProgress = NewProgress;
+		OnMapPreloadProgress.Broadcast(PreloadingMap, PreloadProgress);
+	}
+
+	if (PreloadHandle->HasLoadCompleted())
+	{
+		PreloadTickerHandle.Reset();
+		return false;
+	}
+	return true;
+}
+
+void UHoffmannMehatGameInstance::OnPreloadComplete()
+{
+	if (PreloadProgress < 1.f)
+	{
+		PreloadProgress = 1.f;
+		OnMapPreloadProgress.Broadcast(PreloadingMap, PreloadProgress);
+	}
+
+	OnMapPreloaded.Broadcast(PreloadingMap);
+
+	if (!PendingOpenMap.IsNull() && PendingOpenMap == PreloadingMap)
+	{
+		PendingOpenMap.Reset();
+		TravelTo(PreloadingMap);
+	}
+}
+
+void UHoffmannMehatGameInstance::TravelTo(const TSoftObjectPtr<UWorld>& Map)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->IsPlayInEditor())
+	{
+		// PIE can't travel seamlessly, LoadMap still finds the package already in memory
+		UGameplayStatics::OpenLevel(this, FName(*Map.GetLongPackageName()));
+		return;
+	}
+
+	// Seamless travel keeps the current world up while the transition world loads, then loads
+	// the map asynchronously, which finds the preloaded package and its references in memory.
+	// With no TransitionMap set in DefaultEngine.ini the engine travels through an empty world.
+	World->SeamlessTravel(Map.GetLongPackageName(), true);
+}
+
+void UHoffmannMehatGameInstance::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (LoadedWorld != nullptr && !PreloadingMap.IsNull() && LoadedWorld->GetOutermost()->GetFName() == FName(*PreloadingMap.GetLongPackageName()))
+	{
+		// the running world keeps its package alive from here on
+		CancelPreload();
+	}
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Containers/Ticker.h"
+#include "HoffmannMehatGameInstance.generated.h"
+
+class UDrillScenario;
+class UProfileSaveService;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMapPreloadProgress, TSoftObjectPtr<UWorld>, Map, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMapPreloaded, TSoftObjectPtr<UWorld>, Map);
+
+/**
+ * Game instance that owns the services which have to outlive a single map
+ */
+UCLASS()
+class HOFFMANNMEHAT_API UHoffmannMehatGameInstance : public UGameInstance
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Init() override;
+	virtual void Shutdown() override;
+
+	/** Returns the background save service for the player profile and stats */
+	UFUNCTION(BlueprintPure, Category = "SaveGame")
+	UProfileSaveService* GetSaveService() const { return SaveService; }
+
+	/** Async loads shared by everything that outlives a map, e.g. the HUD's textures */
+	FStreamableManager& GetStreamableManager() { return StreamableManager; }
+
+	/**
+	 * Starts streaming a map's package and everything it references in the background, e.g. as
+	 * soon as the menu highlights a mode. Replaces any other preload that is still running.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Maps")
+	void PreloadMap(TSoftObjectPtr<UWorld> Map);
+
+	/** Drops the current preload, letting its package be collected */
+	UFUNCTION(BlueprintCallable, Category = "Maps")
+	void CancelPreload();
+
+	/**
+	 * Travels seamlessly to a map. If the map is still preloading, travel happens as soon as
+	 * it's done, and if it was never preloaded the seamless travel loads it. In PIE, which can't
+	 * travel seamlessly, it's a normal open of the level.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Maps")
+	void OpenMap(TSoftObjectPtr<UWorld> Map);
+
+	/** Progress of the current preload [0, 1], 0 if there is none */
+	UFUNCTION(BlueprintPure, Category = "Maps")
+	float GetPreloadProgress() const { return PreloadProgress; }
+
+	/** Picks the drill the arena plays, e.g. from the menu before opening the arena map */
+	UFUNCTION(BlueprintCallable, Category = "Drills")
+	void SetSelectedScenario(UDrillScenario* Scenario) { SelectedScenario = Scenario; }
+
+	/** Drill the arena's director starts with when it has none of its own */
+	UFUNCTION(BlueprintPure, Category = "Drills")
+	UDrillScenario* GetSelectedScenario() const { return SelectedScenario; }
+
+	/** Fired every frame the preload progresses, e.g. to fill a loading bar on the mode's button */
+	UPROPERTY(BlueprintAssignable, Category = "Maps")
+	FOnMapPreloadProgress OnMapPreloadProgress;
+
+	/** Fired once the preloaded map can be opened without a blocking load */
+	UPROPERTY(BlueprintAssignable, Category = "Maps")
+	FOnMapPreloaded OnMapPreloaded;
+
+private:
+	/** Reports preload progress, returns false to unregister once it's done */
+	bool TickPreload(float DeltaTime);
+
+	void OnPreloadComplete();
+
+	/** Releases the preloaded package once the map it became is running */
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	void TravelTo(const TSoftObjectPtr<UWorld>& Map);
+
+	UPROPERTY()
+	UProfileSaveService* SaveService;
+
+	UPROPERTY()
+	UDrillScenario* SelectedScenario;
+
+	FStreamableManager StreamableManager;
+
+	/** Keeps the preloaded package alive until the map has been opened */
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+
+	TSoftObjectPtr<UWorld> PreloadingMap;
+
+	/** Map OpenMap was asked for while it was still preloading */
+	TSoftObjectPtr<UWorld> PendingOpenMap;
+
+	float PreloadProgress;
+
+	FDelegateHandle PreloadTickerHandle;
+	FDelegateHandle PostLoadMapHandle;
+};
@@ -3,6 +3,11 @@
 #include "HoffmannMehatGameMode.h"
 #include "HoffmannMehatHUD.h"
 #include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatStats.h"
+#include "ProjectileManager.h"
+#include "EffectPool.h"
+#include "TestPlayerController.h"
+#include "Engine/World.h"
 #include "UObject/ConstructorHelpers.h"
 
 AHoffmannMehatGameMode::AHoffmannMehatGameMode()
@@ -15,5 +20,81 @@ AHoffmannMehatGameMode::AHoffmannMehatGameMode()
 	// use our custom HUD class
 	HUDClass = AHoffmannMehatHUD::StaticClass();
 
+	// its camera manager can late latch look input
+	PlayerControllerClass = ATestPlayerController::StaticClass();
+
 	numTargetsRemaining = 0;
+	Score = 0;
+	bBatchProjectiles = false;
+	ProjectileManager = nullptr;
+	EffectPool = nullptr;
+}
+
+void AHoffmannMehatGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// the proxy mesh and death effects load now rather than on the first shot
+	if (bBatchProjectiles)
+	{
+		GetProjectileManager();
+	}
+	GetEffectPool();
+}
+
+AProjectileManager* AHoffmannMehatGameMode::GetProjectileManager()
+{
+	if (ProjectileManager == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		ProjectileManager = GetWorld()->SpawnActor<AProjectileManager>(SpawnParams);
+	}
+	return ProjectileManager;
+}
+
+AEffectPool* AHoffmannMehatGameMode::GetEffectPool()
+{
+	if (EffectPool == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		EffectPool = GetWorld()->SpawnActor<AEffectPool>(SpawnParams);
+	}
+	return EffectPool;
+}
+
+void AHoffmannMehatGameMode::SetTargetsRemaining(int32 NewTargetsRemaining)
+{
+	if (numTargetsRemaining != NewTargetsRemaining)
+	{
+		numTargetsRemaining = NewTargetsRemaining;
+		OnTargetsRemainingChanged.Broadcast(numTargetsRemaining);
+	}
+}
+
+void AHoffmannMehatGameMode::SetScore(int32 NewScore)
+{
+	if (Score != NewScore)
+	{
+		Score = NewScore;
+		OnScoreChanged.Broadcast(Score);
+	}
+}
+
+void AHoffmannMehatGameMode::RegisterTarget(AActor* Target)
+{
+	if (Target != nullptr && !LiveTargets.Contains(Target))
+	{
+		LiveTargets.Add(Target);
+		FHoffmannMehatFrameCapture::AddLiveTargets(1);
+	}
+}
+
+void AHoffmannMehatGameMode::UnregisterTarget(AActor* Target)
+{
+	if (LiveTargets.RemoveSwap(Target) > 0)
+	{
+		FHoffmannMehatFrameCapture::AddLiveTargets(-1);
+	}
 }
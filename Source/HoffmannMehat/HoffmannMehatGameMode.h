@@ -6,6 +6,11 @@
 #include "GameFramework/GameModeBase.h"
 #include "HoffmannMehatGameMode.generated.h"
 
+class AEffectPool;
+class AProjectileManager;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGameStatChanged, int32, NewValue);
+
 UCLASS(minimalapi)
 class AHoffmannMehatGameMode : public AGameModeBase
 {
@@ -14,7 +19,77 @@ class AHoffmannMehatGameMode : public AGameModeBase
 public:
 	AHoffmannMehatGameMode();
 	int numTargetsRemaining;
-};
 
+	virtual void BeginPlay() override;
+
+	/** Sets the number of targets left in the drill and notifies the HUD */
+	UFUNCTION(BlueprintCallable, Category = "Score")
+	void SetTargetsRemaining(int32 NewTargetsRemaining);
+
+	UFUNCTION(BlueprintPure, Category = "Score")
+	int32 GetTargetsRemaining() const { return numTargetsRemaining; }
+
+	/** Sets the score and notifies the HUD */
+	UFUNCTION(BlueprintCallable, Category = "Score")
+	void SetScore(int32 NewScore);
+
+	UFUNCTION(BlueprintCallable, Category = "Score")
+	void AddScore(int32 Points) { SetScore(Score + Points); }
+
+	UFUNCTION(BlueprintPure, Category = "Score")
+	int32 GetScore() const { return Score; }
+
+	/** Fired when SetScore changes the score */
+	UPROPERTY(BlueprintAssignable, Category = "Score")
+	FOnGameStatChanged OnScoreChanged;
+
+	/** Fired when SetTargetsRemaining changes the count */
+	UPROPERTY(BlueprintAssignable, Category = "Score")
+	FOnGameStatChanged OnTargetsRemainingChanged;
+
+	/** Adds a target to the set the aim systems measure against. ATheFirstActor registers itself. */
+	UFUNCTION(BlueprintCallable, Category = "Targets")
+	void RegisterTarget(AActor* Target);
 
+	/** Removes a target added with RegisterTarget */
+	UFUNCTION(BlueprintCallable, Category = "Targets")
+	void UnregisterTarget(AActor* Target);
 
+	/** Returns the targets currently alive in the drill */
+	FORCEINLINE const TArray<AActor*>& GetLiveTargets() const { return LiveTargets; }
+
+	/**
+	 * Simulate shots in the projectile manager instead of spawning a projectile actor per shot.
+	 * Only for drills whose targets are ADamageableTargets: a batched shot is a sweep, not an
+	 * actor, so Blueprint targets that look for FirstPersonProjectile_C in their hit or overlap
+	 * events never see it.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Projectile")
+	void SetBatchProjectiles(bool bBatch) { bBatchProjectiles = bBatch; }
+
+	UFUNCTION(BlueprintPure, Category = "Projectile")
+	bool IsBatchingProjectiles() const { return bBatchProjectiles; }
+
+	/** Simulates every batched shot fired in this world, spawned on first use */
+	AProjectileManager* GetProjectileManager();
+
+	/** Plays pooled one-shot effects such as target deaths, spawned on first use */
+	AEffectPool* GetEffectPool();
+
+protected:
+	/** See SetBatchProjectiles, off unless a drill turns it on */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	bool bBatchProjectiles;
+
+private:
+	UPROPERTY(Transient)
+	TArray<AActor*> LiveTargets;
+
+	UPROPERTY(Transient)
+	AProjectileManager* ProjectileManager;
+
+	UPROPERTY(Transient)
+	AEffectPool* EffectPool;
+
+	int32 Score;
+};
@@ -1,34 +1,415 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "HoffmannMehatHUD.h"
+#include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatGameMode.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatStats.h"
 #include "Engine/Canvas.h"
+#include "Engine/Engine.h"
 #include "Engine/Texture2D.h"
+#include "RenderUtils.h"
 #include "TextureResource.h"
 #include "CanvasItem.h"
-#include "UObject/ConstructorHelpers.h"
+#include "BatchedElements.h"
+#include "RenderCore.h"
+#include "Misc/App.h"
+#include "HoffmannMehatGameInstance.h"
+
+#define LOCTEXT_NAMESPACE "HoffmannMehatHUD"
 
 AHoffmannMehatHUD::AHoffmannMehatHUD()
 {
-	// Set the crosshair texture
-	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshairTexObj(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair"));
-	CrosshairTex = CrosshairTexObj.Object;
+	// The crosshair texture is streamed in at BeginPlay
+	CrosshairTexture = TSoftObjectPtr<UTexture2D>(FSoftObjectPath(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair.FirstPersonCrosshair")));
+	CrosshairTex = nullptr;
+
+	CrosshairStyle = ECrosshairStyle::Texture;
+	CrosshairSize = 10.f;
+	CrosshairThickness = 2.f;
+	CrosshairGap = 4.f;
+	CrosshairColor = FLinearColor::White;
+
+	bShowBuiltInCounters = false;
+	CounterPosition = FVector2D(32.f, 32.f);
+
+	bShowPerfOverlay = false;
+	LastInputEventCount = 0;
+	LastDrawHUDCycles = 0;
+
+	CachedCanvasSize = FIntPoint::ZeroValue;
+	bCrosshairDirty = true;
+	bCounterTextDirty = true;
 }
 
 
+void AHoffmannMehatHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (CrosshairTexture.IsNull())
+	{
+		return;
+	}
+
+	UHoffmannMehatGameInstance* GameInstance = Cast<UHoffmannMehatGameInstance>(GetGameInstance());
+	if (GameInstance == nullptr)
+	{
+		CrosshairTex = CrosshairTexture.LoadSynchronous();
+		return;
+	}
+
+	// Nothing is drawn for the texture style until it arrives, usually a frame or two
+	TWeakObjectPtr<AHoffmannMehatHUD> WeakThis(this);
+	GameInstance->GetStreamableManager().RequestAsyncLoad(CrosshairTexture.ToSoftObjectPath(), [WeakThis]()
+	{
+		if (AHoffmannMehatHUD* HUD = WeakThis.Get())
+		{
+			HUD->CrosshairTex = HUD->CrosshairTexture.Get();
+		}
+	});
+}
+
 void AHoffmannMehatHUD::DrawHUD()
 {
+	HOFFMANNMEHAT_SCOPE(DrawHUD);
+	HOFFMANNMEHAT_LLM_SCOPE(Gameplay);
+
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
 	Super::DrawHUD();
 
-	// Draw very simple crosshair
+	const FIntPoint CanvasSize(Canvas->SizeX, Canvas->SizeY);
+	if (bCrosshairDirty || CanvasSize != CachedCanvasSize)
+	{
+		CachedCanvasSize = CanvasSize;
+		RebuildCrosshair();
+	}
+
+	if (CrosshairStyle == ECrosshairStyle::Texture)
+	{
+		// Draw very simple crosshair
+
+		// find center of the Canvas
+		const FVector2D Center(Canvas->ClipX * 0.5f, Canvas->ClipY * 0.5f);
+
+		// offset by half the texture's dimensions so that the center of the texture aligns with the center of the Canvas
+		const FVector2D CrosshairDrawPosition( (Center.X), (Center.Y + 20.0f));
+
+		// draw the crosshair
+		if (CrosshairTex != nullptr)
+		{
+			FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
+			TileItem.BlendMode = SE_BLEND_Translucent;
+			Canvas->DrawItem( TileItem );
+		}
+	}
+	else if (CrosshairTriangles.Num() > 0)
+	{
+		// all the crosshair geometry goes out as a single batch
+		FCanvasTriangleItem TriangleItem(CrosshairTriangles, GWhiteTexture);
+		TriangleItem.BlendMode = SE_BLEND_Translucent;
+		Canvas->DrawItem(TriangleItem);
+	}
+
+	if (bShowBuiltInCounters)
+	{
+		UpdateBuiltInCounters();
+	}
+
+	if (bCounterTextDirty)
+	{
+		RebuildCounterText();
+	}
+
+	if (!CounterText.IsEmpty())
+	{
+		// one text item no matter how many counters there are
+		FCanvasTextItem TextItem(CounterPosition, CounterText, GEngine->GetMediumFont(), FLinearColor::White);
+		TextItem.EnableShadow(FLinearColor::Black);
+		Canvas->DrawItem(TextItem);
+	}
+
+	if (bShowPerfOverlay)
+	{
+		SamplePerfOverlay();
+		DrawPerfOverlay();
+	}
+
+	LastDrawHUDCycles = FPlatformTime::Cycles() - StartCycles;
+}
+
+void AHoffmannMehatHUD::SetCounter(FName Name, const FText& Label, int32 Value)
+{
+	FHUDCounter* Counter = Counters.FindByPredicate([Name](const FHUDCounter& Item) { return Item.Name == Name; });
+	if (Counter == nullptr)
+	{
+		Counter = &Counters[Counters.AddDefaulted()];
+		Counter->Name = Name;
+		Counter->Label = Label;
+		Counter->Value = Value;
+		bCounterTextDirty = true;
+	}
+	else if (Counter->Value != Value || !Counter->Label.EqualTo(Label))
+	{
+		Counter->Label = Label;
+		Counter->Value = Value;
+		bCounterTextDirty = true;
+	}
+}
+
+void AHoffmannMehatHUD::RemoveCounter(FName Name)
+{
+	if (Counters.RemoveAll([Name](const FHUDCounter& Item) { return Item.Name == Name; }) > 0)
+	{
+		bCounterTextDirty = true;
+	}
+}
+
+void AHoffmannMehatHUD::SetCrosshairStyle(ECrosshairStyle NewStyle)
+{
+	if (CrosshairStyle != NewStyle)
+	{
+		CrosshairStyle = NewStyle;
+		bCrosshairDirty = true;
+	}
+}
+
+void AHoffmannMehatHUD::UpdateBuiltInCounters()
+{
+	static const FName TargetsRemainingName(TEXT("TargetsRemaining"));
+	static const FName ShotsFiredName(TEXT("ShotsFired"));
+
+	if (const AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		SetCounter(TargetsRemainingName, LOCTEXT("TargetsRemaining", "Targets"), GameMode->numTargetsRemaining);
+	}
+
+	if (const AHoffmannMehatCharacter* Character = Cast<AHoffmannMehatCharacter>(GetOwningPawn()))
+	{
+		SetCounter(ShotsFiredName, LOCTEXT("ShotsFired", "Shots"), Character->NumFire);
+	}
+}
+
+void AHoffmannMehatHUD::RebuildCounterText()
+{
+	FString Text;
+	for (const FHUDCounter& Counter : Counters)
+	{
+		if (!Text.IsEmpty())
+		{
+			Text += TEXT("\n");
+		}
+		Text += FString::Printf(TEXT("%s: %d"), *Counter.Label.ToString(), Counter.Value);
+	}
+	CounterText = FText::FromString(MoveTemp(Text));
+
+	bCounterTextDirty = false;
+}
+
+void AHoffmannMehatHUD::RebuildCrosshair()
+{
+	CrosshairTriangles.Reset();
+	bCrosshairDirty = false;
+
+	const FVector2D Center(CachedCanvasSize.X * 0.5f, CachedCanvasSize.Y * 0.5f);
+	const float HalfThickness = CrosshairThickness * 0.5f;
+	const float Inner = CrosshairGap;
+	const float Outer = CrosshairGap + CrosshairSize;
+
+	switch (CrosshairStyle)
+	{
+	case ECrosshairStyle::Cross:
+	case ECrosshairStyle::CrossWithDot:
+		AddCrosshairQuad(Center + FVector2D(-Outer, -HalfThickness), Center + FVector2D(-Inner, HalfThickness));
+		AddCrosshairQuad(Center + FVector2D(Inner, -HalfThickness), Center + FVector2D(Outer, HalfThickness));
+		AddCrosshairQuad(Center + FVector2D(-HalfThickness, -Outer), Center + FVector2D(HalfThickness, -Inner));
+		AddCrosshairQuad(Center + FVector2D(-HalfThickness, Inner), Center + FVector2D(HalfThickness, Outer));
+		if (CrosshairStyle == ECrosshairStyle::CrossWithDot)
+		{
+			AddCrosshairQuad(Center - FVector2D(HalfThickness, HalfThickness), Center + FVector2D(HalfThickness, HalfThickness));
+		}
+		break;
+
+	case ECrosshairStyle::Dot:
+		AddCrosshairQuad(Center - FVector2D(HalfThickness, HalfThickness), Center + FVector2D(HalfThickness, HalfThickness));
+		break;
+
+	case ECrosshairStyle::Circle:
+		AddCrosshairRing(Center, CrosshairSize, CrosshairThickness, 32);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void AHoffmannMehatHUD::AddCrosshairQuad(const FVector2D& Min, const FVector2D& Max)
+{
+	FCanvasUVTri Tri;
+	Tri.V0_Color = Tri.V1_Color = Tri.V2_Color = CrosshairColor;
+	Tri.V0_UV = Tri.V1_UV = Tri.V2_UV = FVector2D::ZeroVector;
+
+	Tri.V0_Pos = Min;
+	Tri.V1_Pos = FVector2D(Max.X, Min.Y);
+	Tri.V2_Pos = Max;
+	CrosshairTriangles.Add(Tri);
+
+	Tri.V1_Pos = Max;
+	Tri.V2_Pos = FVector2D(Min.X, Max.Y);
+	CrosshairTriangles.Add(Tri);
+}
+
+void AHoffmannMehatHUD::AddCrosshairRing(const FVector2D& Center, float Radius, float Thickness, int32 NumSegments)
+{
+	FCanvasUVTri Tri;
+	Tri.V0_Color = Tri.V1_Color = Tri.V2_Color = CrosshairColor;
+	Tri.V0_UV = Tri.V1_UV = Tri.V2_UV = FVector2D::ZeroVector;
+
+	const float InnerRadius = FMath::Max(0.f, Radius - Thickness * 0.5f);
+	const float OuterRadius = Radius + Thickness * 0.5f;
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		const float Angle0 = 2.f * PI * Segment / NumSegments;
+		const float Angle1 = 2.f * PI * (Segment + 1) / NumSegments;
+		const FVector2D Dir0(FMath::Cos(Angle0), FMath::Sin(Angle0));
+		const FVector2D Dir1(FMath::Cos(Angle1), FMath::Sin(Angle1));
 
-	// find center of the Canvas
-	const FVector2D Center(Canvas->ClipX * 0.5f, Canvas->ClipY * 0.5f);
+		Tri.V0_Pos = Center + Dir0 * InnerRadius;
+		Tri.V1_Pos = Center + Dir0 * OuterRadius;
+		Tri.V2_Pos = Center + Dir1 * OuterRadius;
+		CrosshairTriangles.Add(Tri);
 
-	// offset by half the texture's dimensions so that the center of the texture aligns with the center of the Canvas
-	const FVector2D CrosshairDrawPosition( (Center.X), (Center.Y + 20.0f));
+		Tri.V1_Pos = Center + Dir1 * OuterRadius;
+		Tri.V2_Pos = Center + Dir1 * InnerRadius;
+		CrosshairTriangles.Add(Tri);
+	}
+}
+
+void AHoffmannMehatHUD::TogglePerfOverlay()
+{
+	bShowPerfOverlay = !bShowPerfOverlay;
 
-	// draw the crosshair
-	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
-	TileItem.BlendMode = SE_BLEND_Translucent;
-	Canvas->DrawItem( TileItem );
+	// start the graphs fresh instead of stretching a line across the hidden period
+	FrameTimeMs.Reset();
+	GameThreadMs.Reset();
+	InputEventRate.Reset();
+	RawLookX.Reset();
+	CurveLookX.Reset();
+	RawLookY.Reset();
+	CurveLookY.Reset();
+	InputLatencyMs.Reset();
 }
+
+void AHoffmannMehatHUD::SamplePerfOverlay()
+{
+	const float DeltaSeconds = FApp::GetDeltaTime();
+	FrameTimeMs.Push(DeltaSeconds * 1000.f);
+	GameThreadMs.Push(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+	if (const AHoffmannMehatCharacter* Character = Cast<AHoffmannMehatCharacter>(GetOwningPawn()))
+	{
+		const FLookInputTelemetry& Telemetry = Character->GetLookTelemetry();
+
+		const uint32 NewEvents = Telemetry.NumInputEvents - LastInputEventCount;
+		LastInputEventCount = Telemetry.NumInputEvents;
+		InputEventRate.Push(DeltaSeconds > 0.f ? NewEvents / DeltaSeconds : 0.f);
+
+		RawLookX.Push(Telemetry.RawX);
+		CurveLookX.Push(Telemetry.CurveX);
+		RawLookY.Push(Telemetry.RawY);
+		CurveLookY.Push(Telemetry.CurveY);
+
+		// the HUD draws at the end of the game thread frame, right before the view goes to the renderer
+		InputLatencyMs.Push((float)((FPlatformTime::Seconds() - Telemetry.SampleSeconds) * 1000.0));
+	}
+}
+
+namespace PerfOverlay
+{
+	static const FVector2D GraphSize(256.f, 64.f);
+	static const float GraphSpacing = 20.f;
+
+	static void AddLine(FBatchedElements* Lines, const FVector2D& Start, const FVector2D& End, const FLinearColor& Color)
+	{
+		Lines->AddLine(FVector(Start, 0.f), FVector(End, 0.f), Color, FHitProxyId());
+	}
+
+	/** Frame and reference line for a graph whose vertical axis spans [Min, Max] */
+	static void AddFrame(FBatchedElements* Lines, const FVector2D& Origin, float Min, float Max, float Reference)
+	{
+		const FLinearColor FrameColor(0.3f, 0.3f, 0.3f, 1.f);
+		const FVector2D BottomRight = Origin + PerfOverlay::GraphSize;
+		AddLine(Lines, Origin, FVector2D(BottomRight.X, Origin.Y), FrameColor);
+		AddLine(Lines, FVector2D(BottomRight.X, Origin.Y), BottomRight, FrameColor);
+		AddLine(Lines, BottomRight, FVector2D(Origin.X, BottomRight.Y), FrameColor);
+		AddLine(Lines, FVector2D(Origin.X, BottomRight.Y), Origin, FrameColor);
+
+		const float Y = Origin.Y + GraphSize.Y * (1.f - FMath::Clamp((Reference - Min) / (Max - Min), 0.f, 1.f));
+		AddLine(Lines, FVector2D(Origin.X, Y), FVector2D(BottomRight.X, Y), FLinearColor(0.2f, 0.5f, 0.2f, 1.f));
+	}
+
+	static void AddSeries(FBatchedElements* Lines, const FVector2D& Origin, const FPerfGraphSeries& Series, float Min, float Max, const FLinearColor& Color)
+	{
+		const float StepX = GraphSize.X / (FPerfGraphSeries::GetCapacity() - 1);
+		const float ScaleY = GraphSize.Y / (Max - Min);
+
+		FVector2D Previous;
+		for (int32 Index = 0; Index < Series.Num(); ++Index)
+		{
+			const FVector2D Point(Origin.X + Index * StepX, Origin.Y + GraphSize.Y - FMath::Clamp(Series[Index] - Min, 0.f, Max - Min) * ScaleY);
+			if (Index > 0)
+			{
+				AddLine(Lines, Previous, Point, Color);
+			}
+			Previous = Point;
+		}
+	}
+}
+
+void AHoffmannMehatHUD::DrawPerfOverlay()
+{
+	const FLinearColor Yellow(1.f, 0.8f, 0.f);
+	const FLinearColor Cyan(0.f, 0.8f, 1.f);
+
+	// every graph goes into the same line batch, which the canvas renders in one draw
+	FBatchedElements* Lines = Canvas->Canvas->GetBatchedElements(FCanvas::ET_Line);
+
+	FVector2D Origin(32.f, Canvas->ClipY - 5.f * (PerfOverlay::GraphSize.Y + PerfOverlay::GraphSpacing));
+	const FVector2D Step(0.f, PerfOverlay::GraphSize.Y + PerfOverlay::GraphSpacing);
+
+	// frame (yellow) and game thread (cyan) time, green line at 60 fps
+	PerfOverlay::AddFrame(Lines, Origin, 0.f, 50.f, 1000.f / 60.f);
+	PerfOverlay::AddSeries(Lines, Origin, FrameTimeMs, 0.f, 50.f, Yellow);
+	PerfOverlay::AddSeries(Lines, Origin, GameThreadMs, 0.f, 50.f, Cyan);
+	Canvas->DrawText(GEngine->GetSmallFont(), FString::Printf(TEXT("Frame %.2f ms  Game %.2f ms"), FrameTimeMs.Num() ? FrameTimeMs.Last() : 0.f, GameThreadMs.Num() ? GameThreadMs.Last() : 0.f), Origin.X, Origin.Y - 14.f);
+	Origin += Step;
+
+	// look axis changes per second, green line at 1 per frame at 60 fps
+	PerfOverlay::AddFrame(Lines, Origin, 0.f, 240.f, 60.f);
+	PerfOverlay::AddSeries(Lines, Origin, InputEventRate, 0.f, 240.f, Yellow);
+	Canvas->DrawText(GEngine->GetSmallFont(), FString::Printf(TEXT("Input events %.0f /s"), InputEventRate.Num() ? InputEventRate.Last() : 0.f), Origin.X, Origin.Y - 14.f);
+	Origin += Step;
+
+	// look sample to end of game thread frame, green line at one 60 fps frame
+	PerfOverlay::AddFrame(Lines, Origin, 0.f, 50.f, 1000.f / 60.f);
+	PerfOverlay::AddSeries(Lines, Origin, InputLatencyMs, 0.f, 50.f, Yellow);
+	const AHoffmannMehatCharacter* Character = Cast<AHoffmannMehatCharacter>(GetOwningPawn());
+	const TCHAR* LatchLabel = (Character != nullptr && Character->IsLateLatchingAim()) ? TEXT(" (late latched)") : TEXT("");
+	Canvas->DrawText(GEngine->GetSmallFont(), FString::Printf(TEXT("Input latency %.2f ms%s"), InputLatencyMs.Num() ? InputLatencyMs.Last() : 0.f, LatchLabel), Origin.X, Origin.Y - 14.f);
+	Origin += Step;
+
+	// raw stick (yellow) against curve output (cyan)
+	PerfOverlay::AddFrame(Lines, Origin, -1.f, 1.f, 0.f);
+	PerfOverlay::AddSeries(Lines, Origin, RawLookX, -1.f, 1.f, Yellow);
+	PerfOverlay::AddSeries(Lines, Origin, CurveLookX, -1.f, 1.f, Cyan);
+	Canvas->DrawText(GEngine->GetSmallFont(), TEXT("TurnAtRate raw / curve"), Origin.X, Origin.Y - 14.f);
+	Origin += Step;
+
+	PerfOverlay::AddFrame(Lines, Origin, -1.f, 1.f, 0.f);
+	PerfOverlay::AddSeries(Lines, Origin, RawLookY, -1.f, 1.f, Yellow);
+	PerfOverlay::AddSeries(Lines, Origin, CurveLookY, -1.f, 1.f, Cyan);
+	Canvas->DrawText(GEngine->GetSmallFont(), TEXT("LookUpAtRate raw / curve"), Origin.X, Origin.Y - 14.f);
+}
+
+#undef LOCTEXT_NAMESPACE
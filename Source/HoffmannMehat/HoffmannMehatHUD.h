@@ -1,11 +1,47 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
-#pragma once 
+#pragma once
 
 #include "CoreMinimal.h"
 #include "GameFramework/HUD.h"
+#include "CanvasTypes.h"
+#include "PerfRingBuffer.h"
 #include "HoffmannMehatHUD.generated.h"
 
+class UTexture2D;
+
+/** How the crosshair is drawn. Everything except Texture is generated geometry. */
+UENUM(BlueprintType)
+enum class ECrosshairStyle : uint8
+{
+	Texture,
+	Cross,
+	Dot,
+	Circle,
+	CrossWithDot
+};
+
+/** A labelled number drawn by the HUD */
+USTRUCT()
+struct FHUDCounter
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FName Name;
+
+	UPROPERTY()
+	FText Label;
+
+	UPROPERTY()
+	int32 Value;
+
+	FHUDCounter() : Value(0) {}
+};
+
+/** One line of the performance overlay, a sample per frame */
+typedef TPerfRingBuffer<float, 256> FPerfGraphSeries;
+
 UCLASS()
 class AHoffmannMehatHUD : public AHUD
 {
@@ -17,9 +53,113 @@ public:
 	/** Primary draw call for the HUD */
 	virtual void DrawHUD() override;
 
+	virtual void BeginPlay() override;
+
+	/** Adds or updates a counter. The HUD text is only rebuilt when something actually changed. */
+	UFUNCTION(BlueprintCallable, Category = HUD)
+	void SetCounter(FName Name, const FText& Label, int32 Value);
+
+	/** Removes a counter added with SetCounter */
+	UFUNCTION(BlueprintCallable, Category = HUD)
+	void RemoveCounter(FName Name);
+
+	/** Switches crosshair style, rebuilding the geometry on the next draw */
+	UFUNCTION(BlueprintCallable, Category = Crosshair)
+	void SetCrosshairStyle(ECrosshairStyle NewStyle);
+
+	/** Crosshair style */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Crosshair)
+	ECrosshairStyle CrosshairStyle;
+
+	/** Texture for the Texture style, loaded in the background */
+	UPROPERTY(EditDefaultsOnly, Category = Crosshair)
+	TSoftObjectPtr<UTexture2D> CrosshairTexture;
+
+	/** Length of each arm of a cross, or radius of a circle (px) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Crosshair)
+	float CrosshairSize;
+
+	/** Line thickness, also the dot's diameter (px) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Crosshair)
+	float CrosshairThickness;
+
+	/** Empty space between the center and the arms of a cross (px) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Crosshair)
+	float CrosshairGap;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Crosshair)
+	FLinearColor CrosshairColor;
+
+	/** Draw targets remaining and shots fired from the game mode and character */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = HUD)
+	bool bShowBuiltInCounters;
+
+	/** Top left of the counter block (px) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = HUD)
+	FVector2D CounterPosition;
+
+	/** Time the last DrawHUD call took */
+	float GetLastDrawHUDMilliseconds() const { return FPlatformTime::ToMilliseconds(LastDrawHUDCycles); }
+
+	/** Shows or hides the frame time / input graphs */
+	UFUNCTION(Exec, BlueprintCallable, Category = HUD)
+	void TogglePerfOverlay();
+
+	/** Draw the frame time / input graphs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = HUD)
+	bool bShowPerfOverlay;
+
+protected:
+	/** Regenerates the procedural crosshair for the current canvas size and style */
+	void RebuildCrosshair();
+
+	/** Regenerates the counter text */
+	void RebuildCounterText();
+
+	/** Pushes the built-in counters, which only dirties the text when a value moved */
+	void UpdateBuiltInCounters();
+
+	/** Pushes this frame's timings and look input into the overlay graphs */
+	void SamplePerfOverlay();
+
+	/** Draws every overlay graph into the canvas' batched line list */
+	void DrawPerfOverlay();
+
+	void AddCrosshairQuad(const FVector2D& Min, const FVector2D& Max);
+	void AddCrosshairRing(const FVector2D& Center, float Radius, float Thickness, int32 NumSegments);
+
 private:
-	/** Crosshair asset pointer */
+	/** Crosshair asset pointer, set once CrosshairTexture has loaded */
+	UPROPERTY(Transient)
 	class UTexture2D* CrosshairTex;
 
-};
+	UPROPERTY(Transient)
+	TArray<FHUDCounter> Counters;
+
+	/** Cached crosshair geometry, drawn as one triangle batch */
+	TArray<FCanvasUVTri> CrosshairTriangles;
+
+	/** Cached "Label: Value" lines for all counters, drawn as one text item */
+	FText CounterText;
 
+	/** Canvas size the crosshair was built for */
+	FIntPoint CachedCanvasSize;
+
+	bool bCrosshairDirty;
+	bool bCounterTextDirty;
+
+	/** Overlay graphs */
+	FPerfGraphSeries FrameTimeMs;
+	FPerfGraphSeries GameThreadMs;
+	FPerfGraphSeries InputEventRate;
+	FPerfGraphSeries RawLookX;
+	FPerfGraphSeries CurveLookX;
+	FPerfGraphSeries RawLookY;
+	FPerfGraphSeries CurveLookY;
+	FPerfGraphSeries InputLatencyMs;
+
+	/** Character's input event count at the previous sample */
+	uint32 LastInputEventCount;
+
+	uint32 LastDrawHUDCycles;
+};
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HoffmannMehatMemory.h"
+#include "Stats/Stats.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("HoffmannMehat Gameplay"), STAT_HoffmannMehatLLM_Gameplay, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("HoffmannMehat Projectiles"), STAT_HoffmannMehatLLM_Projectiles, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("HoffmannMehat Targets"), STAT_HoffmannMehatLLM_Targets, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("HoffmannMehat Analytics"), STAT_HoffmannMehatLLM_Analytics, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("HoffmannMehat"), STAT_HoffmannMehatLLM_Summary, STATGROUP_LLM);
+#endif
+
+void FHoffmannMehatLLM::RegisterTags()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+	const FName Summary = GET_STATFNAME(STAT_HoffmannMehatLLM_Summary);
+	Tracker.RegisterProjectTag((int32)EHoffmannMehatLLMTag::Gameplay, TEXT("HoffmannMehatGameplay"), GET_STATFNAME(STAT_HoffmannMehatLLM_Gameplay), Summary);
+	Tracker.RegisterProjectTag((int32)EHoffmannMehatLLMTag::Projectiles, TEXT("HoffmannMehatProjectiles"), GET_STATFNAME(STAT_HoffmannMehatLLM_Projectiles), Summary);
+	Tracker.RegisterProjectTag((int32)EHoffmannMehatLLMTag::Targets, TEXT("HoffmannMehatTargets"), GET_STATFNAME(STAT_HoffmannMehatLLM_Targets), Summary);
+	Tracker.RegisterProjectTag((int32)EHoffmannMehatLLMTag::Analytics, TEXT("HoffmannMehatAnalytics"), GET_STATFNAME(STAT_HoffmannMehatLLM_Analytics), Summary);
+#endif
+}
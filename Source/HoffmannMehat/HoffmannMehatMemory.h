@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+
+/** Our tags in the low level memory tracker, shown under `stat LLMFULL` and summed under `stat LLM` */
+enum class EHoffmannMehatLLMTag : LLM_TAG_TYPE
+{
+	/** Characters, HUD and the rest of the gameplay loop */
+	Gameplay = (LLM_TAG_TYPE)ELLMTag::ProjectTagStart,
+	/** Shots and their proxies */
+	Projectiles,
+	/** Targets, their spawners, pools and death effects */
+	Targets,
+	/** Session recordings, heatmaps and scoring */
+	Analytics,
+};
+
+/** Charges the enclosing scope's allocations to one of our LLM tags, e.g. HOFFMANNMEHAT_LLM_SCOPE(Targets) */
+#define HOFFMANNMEHAT_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)EHoffmannMehatLLMTag::Tag)
+
+#else
+
+#define HOFFMANNMEHAT_LLM_SCOPE(Tag)
+
+#endif
+
+struct HOFFMANNMEHAT_API FHoffmannMehatLLM
+{
+	/** Names our tags in the tracker, from module startup before anything allocates under them */
+	static void RegisterTags();
+};
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HoffmannMehatPlayerCameraManager.h"
+#include "HoffmannMehatCharacter.h"
+#include "Framework/Application/IInputProcessor.h"
+#include "Framework/Application/SlateApplication.h"
+#include "GameFramework/InputSettings.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerInput.h"
+#if WITH_EVDEV_GAMEPAD
+#include "IEvdevGamepadModule.h"
+#endif
+
+/** Remembers the last value and arrival time of every analog key, without consuming anything */
+class FLatestAnalogInput : public IInputProcessor
+{
+public:
+	struct FSample
+	{
+		float Value;
+		double Seconds;
+	};
+
+	virtual void Tick(const float DeltaTime, FSlateApplication& SlateApp, TSharedRef<ICursor> Cursor) override
+	{
+	}
+
+	virtual bool HandleAnalogInputEvent(FSlateApplication& SlateApp, const FAnalogInputEvent& InAnalogInputEvent) override
+	{
+		FSample& Sample = Samples.FindOrAdd(InAnalogInputEvent.GetKey());
+		Sample.Value = InAnalogInputEvent.GetAnalogValue();
+		Sample.Seconds = FPlatformTime::Seconds();
+		return false;
+	}
+
+	const FSample* Find(const FKey& Key) const
+	{
+		return Samples.Find(Key);
+	}
+
+private:
+	TMap<FKey, FSample> Samples;
+};
+
+AHoffmannMehatPlayerCameraManager::AHoffmannMehatPlayerCameraManager()
+{
+	bPollDevicesOnLatch = true;
+}
+
+void AHoffmannMehatPlayerCameraManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (FSlateApplication::IsInitialized())
+	{
+		AnalogInput = MakeShared<FLatestAnalogInput>();
+		FSlateApplication::Get().RegisterInputPreProcessor(AnalogInput);
+	}
+}
+
+void AHoffmannMehatPlayerCameraManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (AnalogInput.IsValid() && FSlateApplication::IsInitialized())
+	{
+		FSlateApplication::Get().UnregisterInputPreProcessor(AnalogInput);
+	}
+	AnalogInput.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AHoffmannMehatPlayerCameraManager::UpdateCamera(float DeltaTime)
+{
+	// Every actor has ticked by now, this is the last chance to move the view before it's drawn
+	AHoffmannMehatCharacter* Character = PCOwner ? Cast<AHoffmannMehatCharacter>(PCOwner->GetPawn()) : nullptr;
+	if (Character != nullptr && Character->IsLateLatchingAim())
+	{
+		LatchLookInput(DeltaTime);
+	}
+
+	Super::UpdateCamera(DeltaTime);
+}
+
+void AHoffmannMehatPlayerCameraManager::LatchLookInput(float DeltaTime)
+{
+	AHoffmannMehatCharacter* Character = CastChecked<AHoffmannMehatCharacter>(PCOwner->GetPawn());
+
+	// start from what the input component handed the character this frame
+	float xRate, yRate;
+	double SampleSeconds;
+	Character->GetPendingLookInput(xRate, yRate, SampleSeconds);
+
+	// a scripted stick wins over the device
+	const bool bUseDevice = !Character->HasLookInputOverride();
+
+	if (bUseDevice && bPollDevicesOnLatch && AnalogInput.IsValid())
+	{
+		// only reaches our preprocessor now, the game sees these events next frame as usual
+		FSlateApplication::Get().PollGameDeviceState();
+
+		// sticks only send events when they move, so after a poll every value is current
+		SampleSeconds = GetStickSampleSeconds();
+	}
+
+	float LatestValue;
+	if (bUseDevice && GetLatestAxisValue(TEXT("TurnRate"), LatestValue))
+	{
+		xRate = LatestValue;
+	}
+	if (bUseDevice && GetLatestAxisValue(TEXT("LookUpRate"), LatestValue))
+	{
+		yRate = LatestValue;
+	}
+
+	float YawInput, PitchInput;
+	Character->LatchLookInput(xRate, yRate, SampleSeconds, YawInput, PitchInput);
+
+	// AddYawInput/AddPitchInput would scale like this before UpdateRotation consumed them
+	FRotator DeltaRot(PitchInput * PCOwner->InputPitchScale, YawInput * PCOwner->InputYawScale, 0.f);
+	FRotator ViewRotation = PCOwner->GetControlRotation();
+	ProcessViewRotation(DeltaTime, ViewRotation, DeltaRot);
+	PCOwner->SetControlRotation(ViewRotation);
+	Character->FaceRotation(ViewRotation, DeltaTime);
+}
+
+double AHoffmannMehatPlayerCameraManager::GetStickSampleSeconds()
+{
+#if WITH_EVDEV_GAMEPAD
+	// a held stick sends no reports, its last one only dates the frame it arrived in
+	static double LastReportSeconds = 0.0;
+	static uint64 LastReportFrame = 0;
+
+	FEvdevStickState Stick;
+	if (IEvdevGamepadModule::IsAvailable() && IEvdevGamepadModule::Get().GetRightStick(Stick))
+	{
+		if (Stick.Seconds != LastReportSeconds)
+		{
+			LastReportSeconds = Stick.Seconds;
+			LastReportFrame = GFrameCounter;
+		}
+		if (LastReportFrame == GFrameCounter)
+		{
+			return Stick.Seconds;
+		}
+	}
+#endif
+	return FPlatformTime::Seconds();
+}
+
+bool AHoffmannMehatPlayerCameraManager::GetLatestAxisValue(FName AxisName, float& OutValue) const
+{
+	if (!AnalogInput.IsValid() || PCOwner->PlayerInput == nullptr)
+	{
+		return false;
+	}
+
+	bool bFound = false;
+	OutValue = 0.f;
+	for (const FInputAxisKeyMapping& Mapping : UInputSettings::GetInputSettings()->AxisMappings)
+	{
+		if (Mapping.AxisName == AxisName)
+		{
+			if (const FLatestAnalogInput::FSample* Sample = AnalogInput->Find(Mapping.Key))
+			{
+				// same dead zone, sensitivity and inversion the input component applies
+				OutValue += PCOwner->PlayerInput->MassageAxisInput(Mapping.Key, Sample->Value) * Mapping.Scale;
+				bFound = true;
+			}
+		}
+	}
+	return bFound;
+}
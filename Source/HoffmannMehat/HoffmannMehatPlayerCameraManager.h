@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HoffmannMehatPlayerCameraManager.generated.h"
+
+class FLatestAnalogInput;
+
+/**
+ * Camera manager that can late latch look input. With the character's bLateLatchAim on, the
+ * look handlers only record the stick, and UpdateCamera, which runs after every actor has
+ * ticked, polls the gamepad once more and turns the freshest stick sample into the frame's
+ * rotation right before the view is built.
+ */
+UCLASS()
+class AHoffmannMehatPlayerCameraManager : public APlayerCameraManager
+{
+	GENERATED_BODY()
+
+public:
+	AHoffmannMehatPlayerCameraManager();
+
+	virtual void UpdateCamera(float DeltaTime) override;
+
+	/**
+	 * Time the gamepad's stick values are current as of. With the evdev backend that's the kernel
+	 * timestamp of the pad's latest report in the frame the report arrived, otherwise it's now.
+	 * Game thread only.
+	 */
+	static double GetStickSampleSeconds();
+
+	/** Poll the gamepads again before latching instead of only using the frame's input */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = LateLatch)
+	bool bPollDevicesOnLatch;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Applies the late latched look input to the control rotation the same way APlayerController::UpdateRotation would */
+	void LatchLookInput(float DeltaTime);
+
+	/**
+	 * Freshest value of an input axis, from the analog events seen by AnalogInput
+	 * @returns false if none of the axis' keys has sent an event yet
+	 */
+	bool GetLatestAxisValue(FName AxisName, float& OutValue) const;
+
+private:
+	/** Sees every analog event before the game does */
+	TSharedPtr<FLatestAnalogInput> AnalogInput;
+};
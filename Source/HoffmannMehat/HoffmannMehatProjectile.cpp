@@ -1,6 +1,14 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "HoffmannMehatProjectile.h"
+#include "HoffmannMehatStats.h"
+#include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatGameMode.h"
+#include "FeedbackAudio.h"
+#include "DamageableTarget.h"
+#include "Engine/EngineTypes.h"
+#include "GameFramework/DamageType.h"
+#include "Engine/World.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
 
@@ -29,15 +37,89 @@ AHoffmannMehatProjectile::AHoffmannMehatProjectile()
 
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
+
+	Damage = 25.f;
+	bHitConfirmed = false;
 }
 
-void AHoffmannMehatProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+void AHoffmannMehatProjectile::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FHoffmannMehatFrameCapture::AddLiveProjectiles(1);
+}
+
+void AHoffmannMehatProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FHoffmannMehatFrameCapture::AddLiveProjectiles(-1);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AHoffmannMehatProjectile::NotifyActorBeginOverlap(AActor* OtherActor)
 {
-	// Only add impulse and destroy projectile if we hit a physics
-	if ((OtherActor != NULL) && (OtherActor != this) && (OtherComp != NULL) && OtherComp->IsSimulatingPhysics())
+	Super::NotifyActorBeginOverlap(OtherActor);
+
+	// targets that only overlap shots never get an OnHit
+	if (!bHitConfirmed)
+	{
+		bHitConfirmed = PlayHitConfirmation(Instigator, OtherActor);
+	}
+}
+
+bool AHoffmannMehatProjectile::PlayHitConfirmation(APawn* Shooter, AActor* OtherActor)
+{
+	// hit confirmation for whoever fired, only on drill targets
+	const AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(OtherActor->GetWorld()->GetAuthGameMode());
+	const AHoffmannMehatCharacter* ShootingCharacter = Cast<AHoffmannMehatCharacter>(Shooter);
+	if (GameMode != nullptr && ShootingCharacter != nullptr && GameMode->GetLiveTargets().Contains(OtherActor))
 	{
-		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
+		ShootingCharacter->GetFeedbackAudio()->Play2D(EFeedbackSound::Hit);
+		return true;
+	}
+	return false;
+}
 
+void AHoffmannMehatProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	if ((OtherActor != this) && ApplyHit(Instigator, Damage, GetActorLocation(), GetVelocity(), OtherActor, OtherComp, Hit, bHitConfirmed))
+	{
 		Destroy();
 	}
-}
\ No newline at end of file
+}
+
+bool AHoffmannMehatProjectile::ApplyHit(APawn* Shooter, float Damage, const FVector& ShotLocation, const FVector& ShotVelocity, AActor* OtherActor, UPrimitiveComponent* OtherComp, const FHitResult& Hit, bool& bHitConfirmed)
+{
+	HOFFMANNMEHAT_SCOPE(ProjectileHit);
+
+	if (OtherActor == NULL)
+	{
+		return false;
+	}
+
+	// before a kill unregisters the target, a bounce or an earlier overlap may have played it already
+	if (!bHitConfirmed)
+	{
+		bHitConfirmed = PlayHitConfirmation(Shooter, OtherActor);
+	}
+
+	// Only add impulse and destroy projectile if we hit a physics, or a target that takes damage
+	const bool bPhysics = (OtherComp != NULL) && OtherComp->IsSimulatingPhysics();
+	ADamageableTarget* const Target = Cast<ADamageableTarget>(OtherActor);
+	if (!bPhysics && Target == nullptr)
+	{
+		return false;
+	}
+
+	if (bPhysics)
+	{
+		OtherComp->AddImpulseAtLocation(ShotVelocity * 100.0f, ShotLocation);
+	}
+
+	if (Target != nullptr)
+	{
+		const FPointDamageEvent DamageEvent(Damage, Hit, ShotVelocity.GetSafeNormal(), UDamageType::StaticClass());
+		Target->TakeDamage(Damage, DamageEvent, Shooter != nullptr ? Shooter->GetController() : nullptr, Shooter);
+	}
+	return true;
+}
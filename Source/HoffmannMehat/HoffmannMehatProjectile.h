@@ -22,10 +22,33 @@ class AHoffmannMehatProjectile : public AActor
 public:
 	AHoffmannMehatProjectile();
 
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
+
 	/** called when projectile hits something */
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/**
+	 * What a shot at ShotLocation moving at ShotVelocity does to what it hit, for this actor and
+	 * the shots AProjectileManager simulates. Returns true if the shot is used up.
+	 * @param bHitConfirmed		Whether the shot has played its hit confirmation, set once it has so it plays once per shot
+	 */
+	static bool ApplyHit(APawn* Shooter, float Damage, const FVector& ShotLocation, const FVector& ShotVelocity, AActor* OtherActor, UPrimitiveComponent* OtherComp, const FHitResult& Hit, bool& bHitConfirmed);
+
+	/** Plays the hit sound for Shooter if OtherActor is one of the drill's live targets, returns whether it did */
+	static bool PlayHitConfirmation(APawn* Shooter, AActor* OtherActor);
+
+	/** Point damage dealt to what the shot hits */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Projectile)
+	float Damage;
+
+private:
+	/** Set once this shot has played its hit confirmation, on a hit or an overlap */
+	bool bHitConfirmed;
+
+public:
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HoffmannMehatStatWidget.h"
+#include "HoffmannMehatCharacter.h"
+#include "HoffmannMehatGameMode.h"
+#include "Components/ProgressBar.h"
+#include "Components/TextBlock.h"
+#include "Engine/World.h"
+
+void UHoffmannMehatStatWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	// nothing shown yet, so the first notification always lands
+	ShownScore = ShownTargetsRemaining = ShownShotsFired = ShownHealth = MIN_int32;
+
+	BoundGameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode());
+	if (BoundGameMode != nullptr)
+	{
+		BoundGameMode->OnScoreChanged.AddUniqueDynamic(this, &UHoffmannMehatStatWidget::HandleScoreChanged);
+		BoundGameMode->OnTargetsRemainingChanged.AddUniqueDynamic(this, &UHoffmannMehatStatWidget::HandleTargetsRemainingChanged);
+		HandleScoreChanged(BoundGameMode->GetScore());
+		HandleTargetsRemainingChanged(BoundGameMode->GetTargetsRemaining());
+	}
+
+	BoundCharacter = Cast<AHoffmannMehatCharacter>(GetOwningPlayerPawn());
+	if (BoundCharacter != nullptr)
+	{
+		BoundCharacter->OnShotsFiredChanged.AddUniqueDynamic(this, &UHoffmannMehatStatWidget::HandleShotsFiredChanged);
+		BoundCharacter->OnHealthChanged.AddUniqueDynamic(this, &UHoffmannMehatStatWidget::HandleHealthChanged);
+		HandleShotsFiredChanged(BoundCharacter->NumFire);
+		HandleHealthChanged(BoundCharacter->GetHealth(), BoundCharacter->MaxHealth);
+	}
+}
+
+void UHoffmannMehatStatWidget::NativeDestruct()
+{
+	if (BoundGameMode != nullptr)
+	{
+		BoundGameMode->OnScoreChanged.RemoveDynamic(this, &UHoffmannMehatStatWidget::HandleScoreChanged);
+		BoundGameMode->OnTargetsRemainingChanged.RemoveDynamic(this, &UHoffmannMehatStatWidget::HandleTargetsRemainingChanged);
+		BoundGameMode = nullptr;
+	}
+
+	if (BoundCharacter != nullptr)
+	{
+		BoundCharacter->OnShotsFiredChanged.RemoveDynamic(this, &UHoffmannMehatStatWidget::HandleShotsFiredChanged);
+		BoundCharacter->OnHealthChanged.RemoveDynamic(this, &UHoffmannMehatStatWidget::HandleHealthChanged);
+		BoundCharacter = nullptr;
+	}
+
+	Super::NativeDestruct();
+}
+
+void UHoffmannMehatStatWidget::SetNumberText(UTextBlock* TextBlock, int32 Value, int32& CachedValue)
+{
+	if (Value == CachedValue)
+	{
+		return;
+	}
+
+	CachedValue = Value;
+	if (TextBlock != nullptr)
+	{
+		// SetText invalidates the text block's layout, which is why we only do it on change
+		TextBlock->SetText(FText::AsNumber(Value));
+	}
+}
+
+void UHoffmannMehatStatWidget::HandleScoreChanged(int32 Score)
+{
+	if (Score != ShownScore)
+	{
+		SetNumberText(ScoreText, Score, ShownScore);
+		OnScoreChanged(Score);
+	}
+}
+
+void UHoffmannMehatStatWidget::HandleTargetsRemainingChanged(int32 TargetsRemaining)
+{
+	if (TargetsRemaining != ShownTargetsRemaining)
+	{
+		SetNumberText(TargetsRemainingText, TargetsRemaining, ShownTargetsRemaining);
+		OnTargetsRemainingChanged(TargetsRemaining);
+	}
+}
+
+void UHoffmannMehatStatWidget::HandleShotsFiredChanged(int32 ShotsFired)
+{
+	if (ShotsFired != ShownShotsFired)
+	{
+		SetNumberText(ShotsFiredText, ShotsFired, ShownShotsFired);
+		OnShotsFiredChanged(ShotsFired);
+	}
+}
+
+void UHoffmannMehatStatWidget::HandleHealthChanged(float Health, float MaxHealth)
+{
+	// the bar and text only show whole points, smaller changes aren't worth a repaint
+	const int32 HealthPoints = FMath::CeilToInt(Health);
+	if (HealthPoints == ShownHealth)
+	{
+		return;
+	}
+
+	SetNumberText(HealthText, HealthPoints, ShownHealth);
+	if (HealthBar != nullptr)
+	{
+		HealthBar->SetPercent(MaxHealth > 0.f ? Health / MaxHealth : 0.f);
+	}
+	OnHealthChanged(Health, MaxHealth);
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "HoffmannMehatStatWidget.generated.h"
+
+class AHoffmannMehatCharacter;
+class AHoffmannMehatGameMode;
+class UProgressBar;
+class UTextBlock;
+
+/**
+ * Base class for the in-game stat widgets (TargetScoreHUD, HealthBarHUD, FreePlayHUD, FPS_HUD).
+ *
+ * Listens to the game mode and character instead of using per-frame property bindings, and
+ * only touches its child widgets when a value actually changed. Subclasses bind whichever of
+ * the optional widgets they have and can react to the On*Changed events.
+ */
+UCLASS(Abstract)
+class HOFFMANNMEHAT_API UHoffmannMehatStatWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Score")
+	void OnScoreChanged(int32 Score);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Score")
+	void OnTargetsRemainingChanged(int32 TargetsRemaining);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Statistics")
+	void OnShotsFiredChanged(int32 ShotsFired);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Health")
+	void OnHealthChanged(float Health, float MaxHealth);
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* ScoreText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* TargetsRemainingText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* ShotsFiredText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* HealthText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UProgressBar* HealthBar;
+
+private:
+	UFUNCTION()
+	void HandleScoreChanged(int32 Score);
+
+	UFUNCTION()
+	void HandleTargetsRemainingChanged(int32 TargetsRemaining);
+
+	UFUNCTION()
+	void HandleShotsFiredChanged(int32 ShotsFired);
+
+	UFUNCTION()
+	void HandleHealthChanged(float Health, float MaxHealth);
+
+	/** Sets a text block only if the number differs from what it shows */
+	static void SetNumberText(UTextBlock* TextBlock, int32 Value, int32& CachedValue);
+
+	UPROPERTY(Transient)
+	AHoffmannMehatGameMode* BoundGameMode;
+
+	UPROPERTY(Transient)
+	AHoffmannMehatCharacter* BoundCharacter;
+
+	int32 ShownScore;
+	int32 ShownTargetsRemaining;
+	int32 ShownShotsFired;
+	int32 ShownHealth;
+};
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HoffmannMehatStats.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderCore.h"
+
+DEFINE_STAT(STAT_HoffmannMehat_TurnAtRate);
+DEFINE_STAT(STAT_HoffmannMehat_LookUpAtRate);
+DEFINE_STAT(STAT_HoffmannMehat_OnFire);
+DEFINE_STAT(STAT_HoffmannMehat_SpawnPickup);
+DEFINE_STAT(STAT_HoffmannMehat_DrawHUD);
+DEFINE_STAT(STAT_HoffmannMehat_ProjectileHit);
+DEFINE_STAT(STAT_HoffmannMehat_TargetUpdate);
+DEFINE_STAT(STAT_HoffmannMehat_TrackingScore);
+DEFINE_STAT(STAT_HoffmannMehat_FeedbackAudio);
+DEFINE_STAT(STAT_HoffmannMehat_ProjectileUpdate);
+DEFINE_STAT(STAT_HoffmannMehat_CrowdUpdate);
+DEFINE_STAT(STAT_HoffmannMehat_AimShadow);
+DEFINE_STAT(STAT_HoffmannMehat_DrillUpdate);
+DEFINE_STAT(STAT_HoffmannMehat_LiveProjectiles);
+DEFINE_STAT(STAT_HoffmannMehat_LiveTargets);
+
+DEFINE_LOG_CATEGORY_STATIC(LogHoffmannMehatStats, Log, All);
+
+bool FHoffmannMehatFrameCapture::bCapturing = false;
+double FHoffmannMehatFrameCapture::StartSeconds = 0.0;
+uint32 FHoffmannMehatFrameCapture::FrameCycles[(int32)EHoffmannMehatScope::Num] = {};
+int32 FHoffmannMehatFrameCapture::LiveProjectiles = 0;
+int32 FHoffmannMehatFrameCapture::LiveTargets = 0;
+TArray<FHoffmannMehatFrameCapture::FFrameRow> FHoffmannMehatFrameCapture::Rows;
+FDelegateHandle FHoffmannMehatFrameCapture::EndFrameHandle;
+
+bool FHoffmannMehatAllocCounter::bInstalled = false;
+int32 FHoffmannMehatAllocCounter::StartCount = 0;
+int32 FHoffmannMehatAllocCounter::CurrentScope = INDEX_NONE;
+uint32 FHoffmannMehatAllocCounter::FrameAllocs[(int32)EHoffmannMehatScope::Num] = {};
+uint32 FHoffmannMehatAllocCounter::LastFrameAllocs[(int32)EHoffmannMehatScope::Num] = {};
+FDelegateHandle FHoffmannMehatAllocCounter::BeginFrameHandle;
+
+namespace HoffmannMehatStats
+{
+	static const TCHAR* ScopeNames[(int32)EHoffmannMehatScope::Num] =
+	{
+		TEXT("TurnAtRate"),
+		TEXT("LookUpAtRate"),
+		TEXT("OnFire"),
+		TEXT("SpawnPickup"),
+		TEXT("DrawHUD"),
+		TEXT("ProjectileHit"),
+		TEXT("TargetUpdate"),
+		TEXT("TrackingScore"),
+		TEXT("FeedbackAudio"),
+		TEXT("ProjectileUpdate"),
+		TEXT("CrowdUpdate"),
+		TEXT("AimShadow"),
+		TEXT("DrillUpdate"),
+	};
+
+	/** Forwards everything to the allocator it was put in front of, counting the allocations */
+	class FCountingMalloc : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			FHoffmannMehatAllocCounter::CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			// a shrink or a free through Realloc doesn't count
+			SIZE_T OriginalSize = 0;
+			if (Original == nullptr || (Count > 0 && (!Inner->GetAllocationSize(Original, OriginalSize) || Count > OriginalSize)))
+			{
+				FHoffmannMehatAllocCounter::CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim() override { Inner->Trim(); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override { return Inner->Exec(InWorld, Cmd, Ar); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		FMalloc* Inner;
+	};
+
+	static void RunFrameCsvCommand(const TArray<FString>& Args)
+	{
+		const bool bStart = Args.Num() > 0 ? Args[0] == TEXT("Start") : !FHoffmannMehatFrameCapture::IsCapturing();
+		if (bStart)
+		{
+			FHoffmannMehatFrameCapture::Start();
+		}
+		else
+		{
+			FHoffmannMehatFrameCapture::Stop();
+		}
+	}
+
+	static FAutoConsoleCommand FrameCsvCommand(
+		TEXT("HoffmannMehat.FrameCsv"),
+		TEXT("Captures per frame timings of the HoffmannMehat scopes and writes them to Saved/Profiling as CSV. Usage: HoffmannMehat.FrameCsv [Start|Stop]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunFrameCsvCommand));
+}
+
+void FHoffmannMehatAllocCounter::Install()
+{
+	check(IsInGameThread());
+
+	if (bInstalled)
+	{
+		return;
+	}
+
+	// The proxy stays for the rest of the run and only forwards, so a block from either allocator
+	// can be freed through the other, and threads still holding the old GMalloc are fine
+	FMalloc* const CountingMalloc = new HoffmannMehatStats::FCountingMalloc(GMalloc);
+	FPlatformMisc::MemoryBarrier();
+	GMalloc = CountingMalloc;
+	bInstalled = true;
+
+	UE_LOG(LogHoffmannMehatStats, Display, TEXT("Counting allocations in the HoffmannMehat scopes"));
+}
+
+void FHoffmannMehatAllocCounter::Start()
+{
+	check(IsInGameThread());
+
+	if (StartCount++ == 0)
+	{
+		FMemory::Memzero(FrameAllocs);
+		FMemory::Memzero(LastFrameAllocs);
+		CurrentScope = INDEX_NONE;
+		BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddStatic(&FHoffmannMehatAllocCounter::OnBeginFrame);
+	}
+}
+
+void FHoffmannMehatAllocCounter::Stop()
+{
+	check(IsInGameThread());
+
+	if (StartCount > 0 && --StartCount == 0)
+	{
+		FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+		CurrentScope = INDEX_NONE;
+	}
+}
+
+const TCHAR* FHoffmannMehatAllocCounter::GetScopeName(EHoffmannMehatScope Scope)
+{
+	return HoffmannMehatStats::ScopeNames[(int32)Scope];
+}
+
+uint32 FHoffmannMehatAllocCounter::GetLastFrameTotal()
+{
+	uint32 Total = 0;
+	for (uint32 Allocs : LastFrameAllocs)
+	{
+		Total += Allocs;
+	}
+	return Total;
+}
+
+void FHoffmannMehatAllocCounter::OnBeginFrame()
+{
+	FMemory::Memcpy(LastFrameAllocs, FrameAllocs, sizeof(FrameAllocs));
+	FMemory::Memzero(FrameAllocs);
+}
+
+void FHoffmannMehatFrameCapture::Start()
+{
+	if (bCapturing)
+	{
+		UE_LOG(LogHoffmannMehatStats, Warning, TEXT("A frame capture is already running"));
+		return;
+	}
+
+	Rows.Reset();
+	FMemory::Memzero(FrameCycles);
+	StartSeconds = FPlatformTime::Seconds();
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FHoffmannMehatFrameCapture::OnEndFrame);
+	FHoffmannMehatAllocCounter::Start();
+	bCapturing = true;
+
+	UE_LOG(LogHoffmannMehatStats, Display, TEXT("Frame capture started"));
+}
+
+FString FHoffmannMehatFrameCapture::Stop()
+{
+	if (!bCapturing)
+	{
+		UE_LOG(LogHoffmannMehatStats, Warning, TEXT("No frame capture is running"));
+		return FString();
+	}
+
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FHoffmannMehatAllocCounter::Stop();
+	bCapturing = false;
+
+	FString Csv = TEXT("frame,seconds,frame_ms,game_thread_ms");
+	for (const TCHAR* Name : HoffmannMehatStats::ScopeNames)
+	{
+		Csv += FString::Printf(TEXT(",%s_ms"), Name);
+	}
+	for (const TCHAR* Name : HoffmannMehatStats::ScopeNames)
+	{
+		Csv += FString::Printf(TEXT(",%s_allocs"), Name);
+	}
+	Csv += TEXT(",live_projectiles,live_targets\n");
+
+	for (const FFrameRow& Row : Rows)
+	{
+		Csv += FString::Printf(TEXT("%llu,%.4f,%.3f,%.3f"), Row.FrameNumber, Row.Seconds, Row.FrameMs, Row.GameThreadMs);
+		for (float Ms : Row.ScopeMs)
+		{
+			Csv += FString::Printf(TEXT(",%.4f"), Ms);
+		}
+		for (uint32 Allocs : Row.ScopeAllocs)
+		{
+			Csv += FString::Printf(TEXT(",%u"), Allocs);
+		}
+		Csv += FString::Printf(TEXT(",%d,%d\n"), Row.LiveProjectiles, Row.LiveTargets);
+	}
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("Profiling") / FString::Printf(TEXT("HoffmannMehat-%s.csv"), *FDateTime::Now().ToString());
+	const int32 NumFrames = Rows.Num();
+	Rows.Empty();
+
+	if (!FFileHelper::SaveStringToFile(Csv, *Path))
+	{
+		UE_LOG(LogHoffmannMehatStats, Error, TEXT("Failed to write %s"), *Path);
+		return FString();
+	}
+
+	UE_LOG(LogHoffmannMehatStats, Display, TEXT("Wrote %d frames to %s"), NumFrames, *Path);
+	return Path;
+}
+
+void FHoffmannMehatFrameCapture::AddScopeCycles(EHoffmannMehatScope Scope, uint32 Cycles)
+{
+	FrameCycles[(int32)Scope] += Cycles;
+}
+
+void FHoffmannMehatFrameCapture::AddLiveProjectiles(int32 Delta)
+{
+	LiveProjectiles += Delta;
+	SET_DWORD_STAT(STAT_HoffmannMehat_LiveProjectiles, LiveProjectiles);
+}
+
+void FHoffmannMehatFrameCapture::AddLiveTargets(int32 Delta)
+{
+	LiveTargets += Delta;
+	SET_DWORD_STAT(STAT_HoffmannMehat_LiveTargets, LiveTargets);
+}
+
+void FHoffmannMehatFrameCapture::OnEndFrame()
+{
+	FFrameRow& Row = Rows[Rows.AddUninitialized()];
+	Row.FrameNumber = GFrameCounter;
+	Row.Seconds = FPlatformTime::Seconds() - StartSeconds;
+	Row.FrameMs = FApp::GetDeltaTime() * 1000.f;
+	// GGameThreadTime is the previous frame's, as everywhere else it's displayed
+	Row.GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	for (int32 Index = 0; Index < (int32)EHoffmannMehatScope::Num; ++Index)
+	{
+		Row.ScopeMs[Index] = FPlatformTime::ToMilliseconds(FrameCycles[Index]);
+		Row.ScopeAllocs[Index] = FHoffmannMehatAllocCounter::GetFrameAllocs((EHoffmannMehatScope)Index);
+	}
+	Row.LiveProjectiles = LiveProjectiles;
+	Row.LiveTargets = LiveTargets;
+
+	FMemory::Memzero(FrameCycles);
+}
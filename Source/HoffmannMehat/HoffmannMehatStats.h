@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("HoffmannMehat"), STATGROUP_HoffmannMehat, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TurnAtRate"), STAT_HoffmannMehat_TurnAtRate, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LookUpAtRate"), STAT_HoffmannMehat_LookUpAtRate, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("OnFire"), STAT_HoffmannMehat_OnFire, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SpawnPickup"), STAT_HoffmannMehat_SpawnPickup, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DrawHUD"), STAT_HoffmannMehat_DrawHUD, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile OnHit"), STAT_HoffmannMehat_ProjectileHit, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Target Update"), STAT_HoffmannMehat_TargetUpdate, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tracking Score"), STAT_HoffmannMehat_TrackingScore, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Feedback Audio"), STAT_HoffmannMehat_FeedbackAudio, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile Update"), STAT_HoffmannMehat_ProjectileUpdate, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crowd Update"), STAT_HoffmannMehat_CrowdUpdate, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Aim Shadow"), STAT_HoffmannMehat_AimShadow, STATGROUP_HoffmannMehat, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Drill Update"), STAT_HoffmannMehat_DrillUpdate, STATGROUP_HoffmannMehat, );
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Projectiles"), STAT_HoffmannMehat_LiveProjectiles, STATGROUP_HoffmannMehat, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Targets"), STAT_HoffmannMehat_LiveTargets, STATGROUP_HoffmannMehat, );
+
+/** Every scope timed by HOFFMANNMEHAT_SCOPE, one CSV column each */
+enum class EHoffmannMehatScope : uint8
+{
+	TurnAtRate,
+	LookUpAtRate,
+	OnFire,
+	SpawnPickup,
+	DrawHUD,
+	ProjectileHit,
+	TargetUpdate,
+	TrackingScore,
+	FeedbackAudio,
+	ProjectileUpdate,
+	CrowdUpdate,
+	AimShadow,
+	DrillUpdate,
+
+	Num
+};
+
+/**
+ * Per frame timings and allocation counts of our own code, game thread only. Unlike the stat
+ * system this also works in Test builds, so it can be turned on on player machines:
+ *
+ *	HoffmannMehat.FrameCsv [Start|Stop]
+ *
+ * Stop writes one row per captured frame to Saved/Profiling. The allocation columns are only
+ * filled in when the game runs with -CountAllocs.
+ */
+class FHoffmannMehatFrameCapture
+{
+public:
+	static void Start();
+
+	/** Stops capturing and writes the CSV, returning its path or an empty string on failure */
+	static FString Stop();
+
+	static bool IsCapturing() { return bCapturing; }
+
+	/** Adds time spent in a scope to the frame being captured */
+	static void AddScopeCycles(EHoffmannMehatScope Scope, uint32 Cycles);
+
+	static void AddLiveProjectiles(int32 Delta);
+	static void AddLiveTargets(int32 Delta);
+
+private:
+	struct FFrameRow
+	{
+		uint64 FrameNumber;
+		double Seconds;
+		float FrameMs;
+		float GameThreadMs;
+		float ScopeMs[(int32)EHoffmannMehatScope::Num];
+		uint32 ScopeAllocs[(int32)EHoffmannMehatScope::Num];
+		int32 LiveProjectiles;
+		int32 LiveTargets;
+	};
+
+	static void OnEndFrame();
+
+	static bool bCapturing;
+	static double StartSeconds;
+	static uint32 FrameCycles[(int32)EHoffmannMehatScope::Num];
+	static int32 LiveProjectiles;
+	static int32 LiveTargets;
+	static TArray<FFrameRow> Rows;
+	static FDelegateHandle EndFrameHandle;
+};
+
+/**
+ * Counts heap allocations made on the game thread inside each HOFFMANNMEHAT_SCOPE, charged to
+ * the innermost scope. Counting needs a proxy in front of GMalloc, which the module puts there
+ * at startup when the game runs with -CountAllocs; without it Start and Stop still nest but
+ * nothing is counted. Counts are per frame: the last finished frame's are kept from the start
+ * of the next one.
+ */
+class FHoffmannMehatAllocCounter
+{
+public:
+	/** Puts the counting proxy in front of GMalloc, once, before gameplay has allocated anything through it */
+	static void Install();
+
+	/** Whether the proxy is installed, so counts mean something */
+	static bool IsAvailable() { return bInstalled; }
+
+	/** Starts counting, nested with Stop so the frame capture and the benchmark can both use it */
+	static void Start();
+	static void Stop();
+
+	static bool IsCounting() { return StartCount > 0; }
+
+	/** Allocations inside Scope during the last finished frame */
+	static uint32 GetLastFrameAllocs(EHoffmannMehatScope Scope) { return LastFrameAllocs[(int32)Scope]; }
+
+	/** Allocations inside any scope during the last finished frame */
+	static uint32 GetLastFrameTotal();
+
+	/** Allocations inside Scope so far this frame */
+	static uint32 GetFrameAllocs(EHoffmannMehatScope Scope) { return FrameAllocs[(int32)Scope]; }
+
+	/** Scope's name as it appears in the capture's columns */
+	static const TCHAR* GetScopeName(EHoffmannMehatScope Scope);
+
+	/** Makes Scope the one allocations are charged to, returns what LeaveScope needs to restore */
+	static FORCEINLINE int32 EnterScope(EHoffmannMehatScope Scope)
+	{
+		if (StartCount == 0 || !IsInGameThread())
+		{
+			return NotEntered;
+		}
+		const int32 Outer = CurrentScope;
+		CurrentScope = (int32)Scope;
+		return Outer;
+	}
+
+	static FORCEINLINE void LeaveScope(int32 Outer)
+	{
+		if (Outer != NotEntered)
+		{
+			CurrentScope = Outer;
+		}
+	}
+
+	/** Called by the proxy for every allocation on any thread */
+	static FORCEINLINE void CountAllocation()
+	{
+		if (StartCount > 0 && IsInGameThread() && CurrentScope != INDEX_NONE)
+		{
+			++FrameAllocs[CurrentScope];
+		}
+	}
+
+private:
+	enum { NotEntered = -2 };
+
+	static void OnBeginFrame();
+
+	static bool bInstalled;
+	static int32 StartCount;
+	static int32 CurrentScope;
+	static uint32 FrameAllocs[(int32)EHoffmannMehatScope::Num];
+	static uint32 LastFrameAllocs[(int32)EHoffmannMehatScope::Num];
+	static FDelegateHandle BeginFrameHandle;
+};
+
+/** Times a scope for the current frame's CSV row, if a capture is running, and charges its allocations to it */
+class FHoffmannMehatScopeTimer
+{
+public:
+	explicit FHoffmannMehatScopeTimer(EHoffmannMehatScope InScope)
+		: Scope(InScope)
+		, bTiming(FHoffmannMehatFrameCapture::IsCapturing())
+		, StartCycles(bTiming ? FPlatformTime::Cycles() : 0)
+		, OuterAllocScope(FHoffmannMehatAllocCounter::EnterScope(InScope))
+	{
+	}
+
+	~FHoffmannMehatScopeTimer()
+	{
+		FHoffmannMehatAllocCounter::LeaveScope(OuterAllocScope);
+		if (bTiming)
+		{
+			FHoffmannMehatFrameCapture::AddScopeCycles(Scope, FPlatformTime::Cycles() - StartCycles);
+		}
+	}
+
+private:
+	EHoffmannMehatScope Scope;
+	bool bTiming;
+	uint32 StartCycles;
+	int32 OuterAllocScope;
+};
+
+/**
+ * Times the enclosing scope under both `stat HoffmannMehat` and the frame capture. The cycle
+ * counter also shows up as a named event in external profilers with `stat namedevents`.
+ */
+#define HOFFMANNMEHAT_SCOPE(Scope) \
+	SCOPE_CYCLE_COUNTER(STAT_HoffmannMehat_##Scope); \
+	FHoffmannMehatScopeTimer PREPROCESSOR_JOIN(HoffmannMehatScopeTimer, __LINE__)(EHoffmannMehatScope::Scope)
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed-size ring buffer of samples for the live graphs. Pushing never allocates,
+ * once full the oldest sample is overwritten.
+ */
+template<typename ElementType, int32 Capacity>
+class TPerfRingBuffer
+{
+	static_assert(Capacity > 0, "TPerfRingBuffer needs room for at least one sample");
+
+public:
+	TPerfRingBuffer()
+		: Head(0)
+		, Count(0)
+	{
+	}
+
+	void Push(const ElementType& Value)
+	{
+		Samples[Head] = Value;
+		Head = (Head + 1) % Capacity;
+		Count = FMath::Min(Count + 1, Capacity);
+	}
+
+	void Reset()
+	{
+		Head = 0;
+		Count = 0;
+	}
+
+	/** Sample by age, 0 is the oldest */
+	const ElementType& operator[](int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		return Samples[(Head - Count + Index + Capacity) % Capacity];
+	}
+
+	/** Most recently pushed sample */
+	const ElementType& Last() const
+	{
+		check(Count > 0);
+		return Samples[(Head - 1 + Capacity) % Capacity];
+	}
+
+	FORCEINLINE int32 Num() const { return Count; }
+	static constexpr int32 GetCapacity() { return Capacity; }
+
+private:
+	ElementType Samples[Capacity];
+	int32 Head;
+	int32 Count;
+};
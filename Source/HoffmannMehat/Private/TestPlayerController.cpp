@@ -1,4 +1,11 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "TestPlayerController.h"
+#include "HoffmannMehatPlayerCameraManager.h"
+
+ATestPlayerController::ATestPlayerController()
+{
+	// needed for late latched aim
+	PlayerCameraManagerClass = AHoffmannMehatPlayerCameraManager::StaticClass();
+}
 
@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProfileSaveService.h"
+#include "Async/Async.h"
+#include "GameFramework/SaveGame.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <stdio.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogProfileSave, Log, All);
+
+namespace ProfileSave
+{
+	/** Tag at the start of slots written compressed by this service */
+	static const uint32 CompressedMagic = 0x564D5348; // 'HSMV'
+	static const int32 CompressedVersion = 1;
+
+	/**
+	 * Moves From over To, so that a crash at any point leaves either the old To or the new one.
+	 * Windows and POSIX replace the file in one step. Elsewhere the old file is kept as To.bak
+	 * until the new one is in place, and LoadGame recovers from it.
+	 */
+	static bool ReplaceFile(const FString& To, const FString& From)
+	{
+		IFileManager& FileManager = IFileManager::Get();
+		const FString AbsoluteTo = FileManager.ConvertToAbsolutePathForExternalAppForWrite(*To);
+		const FString AbsoluteFrom = FileManager.ConvertToAbsolutePathForExternalAppForWrite(*From);
+
+#if PLATFORM_WINDOWS
+		return ::MoveFileExW(*AbsoluteFrom, *AbsoluteTo, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+		return ::rename(TCHAR_TO_UTF8(*AbsoluteFrom), TCHAR_TO_UTF8(*AbsoluteTo)) == 0;
+#else
+		const FString Backup = To + TEXT(".bak");
+		if (FileManager.FileExists(*To) && !FileManager.Move(*Backup, *To, true, true))
+		{
+			return false;
+		}
+		if (!FileManager.Move(*To, *From, true, true))
+		{
+			return false;
+		}
+		FileManager.Delete(*Backup, false, true, true);
+		return true;
+#endif
+	}
+}
+
+bool UProfileSaveService::SaveGameAsync(USaveGame* SaveGameObject, const FString& SlotName, int32 UserIndex)
+{
+	check(IsInGameThread());
+
+	if (SaveGameObject == nullptr || SlotName.IsEmpty())
+	{
+		return false;
+	}
+
+	// Snapshot on the game thread, the object may change as soon as we return
+	FPendingSave Save;
+	Save.UserIndex = UserIndex;
+	if (!UGameplayStatics::SaveGameToMemory(SaveGameObject, Save.Snapshot))
+	{
+		return false;
+	}
+
+	FSlotState& Slot = Slots.FindOrAdd(SlotName);
+	if (Slot.bWriting)
+	{
+		// Writes to one slot stay ordered, only the newest queued snapshot is kept
+		Slot.Queued = MoveTemp(Save);
+		return true;
+	}
+
+	StartWrite(SlotName, MoveTemp(Save));
+	return true;
+}
+
+void UProfileSaveService::StartWrite(const FString& SlotName, FPendingSave&& Save)
+{
+	TWeakObjectPtr<UProfileSaveService> WeakThis(this);
+	const bool bCompress = bCompressSaves;
+	const int32 UserIndex = Save.UserIndex;
+
+	FSlotState& Slot = Slots.FindChecked(SlotName);
+	Slot.bWriting = true;
+	Slot.InFlight = Async<bool>(EAsyncExecution::ThreadPool,
+		[WeakThis, SlotName, UserIndex, bCompress, Snapshot = MoveTemp(Save.Snapshot)]()
+		{
+			const bool bSuccess = WriteSlotFile(SlotName, Snapshot, bCompress);
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, SlotName, UserIndex, bSuccess]()
+			{
+				if (UProfileSaveService* Service = WeakThis.Get())
+				{
+					Service->OnWriteFinished(SlotName, UserIndex, bSuccess);
+				}
+			});
+
+			return bSuccess;
+		});
+}
+
+void UProfileSaveService::OnWriteFinished(const FString& SlotName, int32 UserIndex, bool bSuccess)
+{
+	if (FSlotState* Slot = Slots.Find(SlotName))
+	{
+		Slot->bWriting = false;
+		if (Slot->Queued.IsSet())
+		{
+			FPendingSave Next = MoveTemp(Slot->Queued.GetValue());
+			Slot->Queued.Reset();
+			StartWrite(SlotName, MoveTemp(Next));
+		}
+	}
+
+	OnSaveComplete.Broadcast(SlotName, UserIndex, bSuccess);
+}
+
+bool UProfileSaveService::IsSaveInProgress(const FString& SlotName) const
+{
+	const FSlotState* Slot = Slots.Find(SlotName);
+	return Slot != nullptr && (Slot->bWriting || Slot->Queued.IsSet());
+}
+
+void UProfileSaveService::Flush()
+{
+	for (TPair<FString, FSlotState>& Pair : Slots)
+	{
+		FSlotState& Slot = Pair.Value;
+		if (Slot.InFlight.IsValid())
+		{
+			Slot.InFlight.Wait();
+		}
+
+		// Completion callbacks won't run once we are shutting down, write the queued snapshot inline
+		if (Slot.Queued.IsSet())
+		{
+			WriteSlotFile(Pair.Key, Slot.Queued.GetValue().Snapshot, bCompressSaves);
+			Slot.Queued.Reset();
+		}
+	}
+}
+
+USaveGame* UProfileSaveService::LoadGame(const FString& SlotName, int32 UserIndex)
+{
+	const FString SlotPath = GetSlotPath(SlotName);
+	const FString BackupPath = SlotPath + TEXT(".bak");
+	const FString TempPath = SlotPath + TEXT(".tmp");
+
+	USaveGame* Loaded = LoadSlotFile(SlotName, SlotPath);
+	if (IsSaveInProgress(SlotName))
+	{
+		// the temp file and backup belong to the running write
+		return Loaded;
+	}
+
+	if (Loaded != nullptr)
+	{
+		// leftovers of a save that died before the replace, the slot is the last good one
+		IFileManager::Get().Delete(*BackupPath, false, true, true);
+		IFileManager::Get().Delete(*TempPath, false, true, true);
+		return Loaded;
+	}
+
+	// the slot is missing or damaged: the backup is the last good one if the replace died half
+	// way, and a temp file that loads was written in full before a crash stopped the replace
+	for (const FString& RecoveryPath : { BackupPath, TempPath })
+	{
+		Loaded = LoadSlotFile(SlotName, RecoveryPath);
+		if (Loaded != nullptr)
+		{
+			UE_LOG(LogProfileSave, Warning, TEXT("Recovered slot %s from %s"), *SlotName, *RecoveryPath);
+			ProfileSave::ReplaceFile(SlotPath, RecoveryPath);
+			return Loaded;
+		}
+	}
+	return nullptr;
+}
+
+USaveGame* UProfileSaveService::LoadSlotFile(const FString& SlotName, const FString& Path)
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *Path, FILEREAD_Silent))
+	{
+		return nullptr;
+	}
+
+	FMemoryReader Reader(FileData);
+	uint32 Magic = 0;
+	if (FileData.Num() >= sizeof(uint32))
+	{
+		Reader << Magic;
+	}
+
+	if (Magic != ProfileSave::CompressedMagic)
+	{
+		// Uncompressed slot, same layout UGameplayStatics writes
+		return UGameplayStatics::LoadGameFromMemory(FileData);
+	}
+
+	int32 Version = 0;
+	int32 UncompressedSize = 0;
+	Reader << Version;
+	Reader << UncompressedSize;
+	if (Reader.IsError() || Version != ProfileSave::CompressedVersion || UncompressedSize <= 0)
+	{
+		UE_LOG(LogProfileSave, Warning, TEXT("Slot %s has an unsupported header"), *SlotName);
+		return nullptr;
+	}
+
+	const int32 HeaderSize = (int32)Reader.Tell();
+	TArray<uint8> Snapshot;
+	Snapshot.SetNumUninitialized(UncompressedSize);
+	if (!FCompression::UncompressMemory(COMPRESS_ZLIB, Snapshot.GetData(), UncompressedSize, FileData.GetData() + HeaderSize, FileData.Num() - HeaderSize))
+	{
+		UE_LOG(LogProfileSave, Warning, TEXT("Slot %s failed to decompress"), *SlotName);
+		return nullptr;
+	}
+
+	return UGameplayStatics::LoadGameFromMemory(Snapshot);
+}
+
+FString UProfileSaveService::GetSlotPath(const FString& SlotName)
+{
+	// Same location the generic platform save system uses
+	return FString::Printf(TEXT("%sSaveGames/%s.sav"), *FPaths::ProjectSavedDir(), *SlotName);
+}
+
+bool UProfileSaveService::WriteSlotFile(const FString& SlotName, const TArray<uint8>& Snapshot, bool bCompress)
+{
+	TArray<uint8> FileData;
+	if (bCompress)
+	{
+		int32 UncompressedSize = Snapshot.Num();
+		int32 CompressedSize = FCompression::CompressMemoryBound(COMPRESS_ZLIB, UncompressedSize);
+
+		uint32 Magic = ProfileSave::CompressedMagic;
+		int32 Version = ProfileSave::CompressedVersion;
+		FMemoryWriter Writer(FileData);
+		Writer << Magic;
+		Writer << Version;
+		Writer << UncompressedSize;
+
+		const int32 HeaderSize = FileData.Num();
+		FileData.AddUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(COMPRESS_ZLIB, FileData.GetData() + HeaderSize, CompressedSize, Snapshot.GetData(), UncompressedSize))
+		{
+			UE_LOG(LogProfileSave, Warning, TEXT("Failed to compress slot %s"), *SlotName);
+			return false;
+		}
+		FileData.SetNum(HeaderSize + CompressedSize, false);
+	}
+
+	const TArray<uint8>& Data = bCompress ? FileData : Snapshot;
+	const FString SlotPath = GetSlotPath(SlotName);
+	const FString TempPath = SlotPath + TEXT(".tmp");
+
+	// Write the temp file first, the rename is the only step that touches the real slot
+	if (!FFileHelper::SaveArrayToFile(Data, *TempPath))
+	{
+		UE_LOG(LogProfileSave, Warning, TEXT("Failed to write %s"), *TempPath);
+		return false;
+	}
+
+	if (!ProfileSave::ReplaceFile(SlotPath, TempPath))
+	{
+		UE_LOG(LogProfileSave, Warning, TEXT("Failed to move %s over %s"), *TempPath, *SlotPath);
+		IFileManager::Get().Delete(*TempPath, false, true, true);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Async/Future.h"
+#include "ProfileSaveService.generated.h"
+
+class USaveGame;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnProfileSaveComplete, const FString&, SlotName, int32, UserIndex, bool, bSuccess);
+
+/**
+ * Writes PlayerSave / PlayerStatsSave slots without stalling the game thread.
+ *
+ * The save object is snapshotted into memory on the game thread, then compressed and
+ * written on a pool thread. Files are written to a temp file and renamed over the slot,
+ * so a crash mid-save leaves the previous profile intact.
+ */
+UCLASS(BlueprintType)
+class HOFFMANNMEHAT_API UProfileSaveService : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Queues a save of SaveGameObject to SlotName. Returns false if the snapshot could not be taken. */
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	bool SaveGameAsync(USaveGame* SaveGameObject, const FString& SlotName, int32 UserIndex);
+
+	/**
+	 * Loads a slot written by this service, or by UGameplayStatics::SaveGameToSlot. Leftovers of
+	 * an interrupted save are only cleaned up or recovered while no save to the slot is running.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	USaveGame* LoadGame(const FString& SlotName, int32 UserIndex);
+
+	/** Returns true while a write for SlotName is queued or in flight */
+	UFUNCTION(BlueprintPure, Category = "SaveGame")
+	bool IsSaveInProgress(const FString& SlotName) const;
+
+	/** Blocks until every queued write has hit the disk. Only meant for shutdown. */
+	void Flush();
+
+	/** Called on the game thread once a slot has been written (or failed to) */
+	UPROPERTY(BlueprintAssignable, Category = "SaveGame")
+	FOnProfileSaveComplete OnSaveComplete;
+
+	/** Compress slot files. Compressed slots can only be read back through LoadGame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SaveGame")
+	bool bCompressSaves = true;
+
+private:
+	struct FPendingSave
+	{
+		int32 UserIndex;
+		TArray<uint8> Snapshot;
+	};
+
+	struct FSlotState
+	{
+		/** The write currently running on the pool */
+		TFuture<bool> InFlight;
+
+		/**
+		 * From StartWrite until OnWriteFinished runs on the game thread. InFlight is ready a little
+		 * earlier, and a write started in between would race the queued one for the temp file.
+		 */
+		bool bWriting = false;
+
+		/** Latest snapshot taken while a write was running; older ones are dropped */
+		TOptional<FPendingSave> Queued;
+	};
+
+	void StartWrite(const FString& SlotName, FPendingSave&& Save);
+	void OnWriteFinished(const FString& SlotName, int32 UserIndex, bool bSuccess);
+
+	static FString GetSlotPath(const FString& SlotName);
+	static bool WriteSlotFile(const FString& SlotName, const TArray<uint8>& Snapshot, bool bCompress);
+
+	/** Reads a slot file written by WriteSlotFile or UGameplayStatics, nullptr if it's missing or damaged */
+	static USaveGame* LoadSlotFile(const FString& SlotName, const FString& Path);
+
+	TMap<FString, FSlotState> Slots;
+};
@@ -0,0 +1,284 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProjectileManager.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatGameInstance.h"
+#include "HoffmannMehatProjectile.h"
+#include "HoffmannMehatStats.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+namespace ProjectileManager
+{
+	/** Scale of the instances that have no shot */
+	static const FTransform HiddenTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+	/** How far a shot is pushed out of something it starts inside of, on top of the penetration (cm) */
+	static const float PullBackDistance = 0.125f;
+}
+
+AProjectileManager::AProjectileManager()
+{
+	// Moves shots before physics, like the movement components did
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	Proxies = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Proxies"));
+	Proxies->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Proxies->SetCanEverAffectNavigation(false);
+	Proxies->CastShadow = false;
+	RootComponent = Proxies;
+
+	ProxyMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Game/FirstPerson/Meshes/FirstPersonProjectileMesh.FirstPersonProjectileMesh")));
+	ProxyScale = 0.06f;
+	MaxIterations = 4;
+	NumVisibleProxies = 0;
+}
+
+void AProjectileManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (ProxyMesh.IsNull())
+	{
+		return;
+	}
+
+	UHoffmannMehatGameInstance* GameInstance = Cast<UHoffmannMehatGameInstance>(GetGameInstance());
+	if (GameInstance == nullptr)
+	{
+		Proxies->SetStaticMesh(ProxyMesh.LoadSynchronous());
+		return;
+	}
+
+	// shots are simulated meanwhile, they just aren't drawn until it arrives
+	TWeakObjectPtr<AProjectileManager> WeakThis(this);
+	GameInstance->GetStreamableManager().RequestAsyncLoad(ProxyMesh.ToSoftObjectPath(), [WeakThis]()
+	{
+		if (AProjectileManager* Manager = WeakThis.Get())
+		{
+			Manager->Proxies->SetStaticMesh(Manager->ProxyMesh.Get());
+		}
+	});
+}
+
+void AProjectileManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FHoffmannMehatFrameCapture::AddLiveProjectiles(-Positions.Num());
+
+	Super::EndPlay(EndPlayReason);
+}
+
+int32 AProjectileManager::FindShotParams(TSubclassOf<AHoffmannMehatProjectile> Class)
+{
+	for (int32 Index = 0; Index < ShotParams.Num(); ++Index)
+	{
+		if (ShotParams[Index].Class == Class)
+		{
+			return Index;
+		}
+	}
+
+	// Blueprint overrides of the inherited components live on the default object
+	const AHoffmannMehatProjectile* Defaults = Class->GetDefaultObject<AHoffmannMehatProjectile>();
+	const USphereComponent* Collision = Defaults->GetCollisionComp();
+	const UProjectileMovementComponent* Movement = Defaults->GetProjectileMovement();
+
+	FShotParams Params;
+	Params.Class = Class;
+	Params.CollisionProfile = Collision->GetCollisionProfileName();
+	Params.Radius = Collision->GetUnscaledSphereRadius();
+	Params.InitialSpeed = Movement->InitialSpeed;
+	Params.MaxSpeed = Movement->MaxSpeed;
+	Params.GravityScale = Movement->ProjectileGravityScale;
+	Params.bShouldBounce = Movement->bShouldBounce;
+	Params.bBounceAngleAffectsFriction = Movement->bBounceAngleAffectsFriction;
+	Params.Bounciness = Movement->Bounciness;
+	Params.Friction = Movement->Friction;
+	Params.BounceStopSpeed = Movement->BounceVelocityStopSimulatingThreshold;
+	Params.LifeSpan = Defaults->InitialLifeSpan;
+	Params.Damage = Defaults->Damage;
+
+	// the index is stored in a byte per shot
+	check(ShotParams.Num() < MAX_uint8);
+	return ShotParams.Add(Params);
+}
+
+void AProjectileManager::Fire(TSubclassOf<AHoffmannMehatProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, APawn* Shooter)
+{
+	HOFFMANNMEHAT_LLM_SCOPE(Projectiles);
+
+	if (ProjectileClass == nullptr)
+	{
+		return;
+	}
+
+	const int32 ParamIndex = FindShotParams(ProjectileClass);
+	const FShotParams& Params = ShotParams[ParamIndex];
+
+	FVector Velocity = Rotation.Vector() * Params.InitialSpeed;
+	if (Params.MaxSpeed > 0.f)
+	{
+		Velocity = Velocity.GetClampedToMaxSize(Params.MaxSpeed);
+	}
+
+	Positions.Add(Location);
+	Velocities.Add(Velocity);
+	Lifetimes.Add(Params.LifeSpan > 0.f ? Params.LifeSpan : MAX_flt);
+	ParamIndices.Add((uint8)ParamIndex);
+	Shooters.Add(Shooter);
+	HitConfirmed.Add(false);
+
+	FHoffmannMehatFrameCapture::AddLiveProjectiles(1);
+}
+
+void AProjectileManager::RemoveShot(int32 Shot)
+{
+	Positions.RemoveAtSwap(Shot, 1, false);
+	Velocities.RemoveAtSwap(Shot, 1, false);
+	Lifetimes.RemoveAtSwap(Shot, 1, false);
+	ParamIndices.RemoveAtSwap(Shot, 1, false);
+	Shooters.RemoveAtSwap(Shot, 1, false);
+	HitConfirmed.RemoveAtSwap(Shot, 1, false);
+
+	FHoffmannMehatFrameCapture::AddLiveProjectiles(-1);
+}
+
+bool AProjectileManager::SimulateShot(int32 Shot, float DeltaTime, float GravityZ, FCollisionQueryParams& QueryParams)
+{
+	const FShotParams& Params = ShotParams[ParamIndices[Shot]];
+	FVector& Position = Positions[Shot];
+	FVector& Velocity = Velocities[Shot];
+
+	// a shot that stopped bouncing lies still until its lifetime runs out
+	if (Velocity.IsZero())
+	{
+		return true;
+	}
+
+	APawn* Shooter = Shooters[Shot].Get();
+	QueryParams.ClearIgnoredActors();
+	if (Shooter != nullptr)
+	{
+		QueryParams.AddIgnoredActor(Shooter);
+	}
+
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(Params.Radius);
+	const FVector Acceleration(0.f, 0.f, GravityZ * Params.GravityScale);
+
+	float Remaining = DeltaTime;
+	for (int32 Iteration = 0; Iteration < MaxIterations && Remaining > KINDA_SMALL_NUMBER; ++Iteration)
+	{
+		const FVector Delta = Velocity * Remaining + 0.5f * Acceleration * FMath::Square(Remaining);
+
+		FHitResult Hit;
+		if (!GetWorld()->SweepSingleByProfile(Hit, Position, Position + Delta, FQuat::Identity, Params.CollisionProfile, Shape, QueryParams))
+		{
+			Position += Delta;
+			Velocity += Acceleration * Remaining;
+			break;
+		}
+
+		if (Hit.bStartPenetrating)
+		{
+			Position += Hit.Normal * (Hit.PenetrationDepth + ProjectileManager::PullBackDistance);
+		}
+		else
+		{
+			Position = Hit.Location;
+		}
+
+		// the actor's OnHit saw the velocity from before the move
+		if (AHoffmannMehatProjectile::ApplyHit(Shooter, Params.Damage, Position, Velocity, Hit.GetActor(), Hit.GetComponent(), Hit, HitConfirmed[Shot]))
+		{
+			return false;
+		}
+
+		const float HitTime = Remaining * Hit.Time;
+		Velocity += Acceleration * HitTime;
+		Remaining -= HitTime;
+
+		if (!Params.bShouldBounce)
+		{
+			Velocity = FVector::ZeroVector;
+			return true;
+		}
+
+		// same response as UProjectileMovementComponent::ComputeBounceDelta
+		const FVector Normal = Hit.Normal;
+		const float VDotNormal = FVector::DotProduct(Velocity, Normal);
+		if (VDotNormal <= 0.f)
+		{
+			const FVector ProjectedNormal = Normal * -VDotNormal;
+			Velocity += ProjectedNormal;
+
+			const float Speed = Velocity.Size();
+			const float ScaledFriction = (Params.bBounceAngleAffectsFriction && Speed > KINDA_SMALL_NUMBER) ? FMath::Clamp(-VDotNormal / Speed, 0.f, 1.f) * Params.Friction : Params.Friction;
+			Velocity *= FMath::Clamp(1.f - ScaledFriction, 0.f, 1.f);
+			Velocity += ProjectedNormal * FMath::Max(Params.Bounciness, 0.f);
+		}
+
+		if (Velocity.SizeSquared() < FMath::Square(Params.BounceStopSpeed))
+		{
+			Velocity = FVector::ZeroVector;
+			return true;
+		}
+	}
+
+	if (Params.MaxSpeed > 0.f)
+	{
+		Velocity = Velocity.GetClampedToMaxSize(Params.MaxSpeed);
+	}
+	return true;
+}
+
+void AProjectileManager::UpdateProxies()
+{
+	const int32 NumShots = Positions.Num();
+	const int32 NumProxies = FMath::Max(NumShots, NumVisibleProxies);
+	if (NumProxies == 0)
+	{
+		return;
+	}
+
+	while (Proxies->GetInstanceCount() < NumShots)
+	{
+		Proxies->AddInstance(ProjectileManager::HiddenTransform);
+	}
+
+	// the render state is rebuilt once, after the last instance
+	const FVector Scale(ProxyScale);
+	for (int32 Index = 0; Index < NumProxies; ++Index)
+	{
+		const FTransform Transform = Index < NumShots ? FTransform(FQuat::Identity, Positions[Index], Scale) : ProjectileManager::HiddenTransform;
+		Proxies->UpdateInstanceTransform(Index, Transform, true, Index == NumProxies - 1, true);
+	}
+	NumVisibleProxies = NumShots;
+}
+
+void AProjectileManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	HOFFMANNMEHAT_SCOPE(ProjectileUpdate);
+	HOFFMANNMEHAT_LLM_SCOPE(Projectiles);
+
+	const float GravityZ = GetWorld()->GetGravityZ();
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileManager), false);
+
+	// walks backwards so removal only swaps in shots that are already done
+	for (int32 Shot = Positions.Num() - 1; Shot >= 0; --Shot)
+	{
+		Lifetimes[Shot] -= DeltaTime;
+		if (Lifetimes[Shot] <= 0.f || !SimulateShot(Shot, DeltaTime, GravityZ, QueryParams))
+		{
+			RemoveShot(Shot);
+		}
+	}
+
+	UpdateProxies();
+}
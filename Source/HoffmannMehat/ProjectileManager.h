@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ProjectileManager.generated.h"
+
+class AHoffmannMehatProjectile;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * Simulates every live shot in one pass per frame instead of an actor with its own movement
+ * component per shot. Shots live in parallel arrays, are swept against the world back to back
+ * with one shared shape and query, and are drawn as instances of a single instanced mesh.
+ * A shot's speed, gravity, bounce, radius, collision profile and lifetime come from the
+ * projectile class it was fired with, and hits go through AHoffmannMehatProjectile::ApplyHit
+ * like the actor's OnHit.
+ *
+ * Only used while the game mode batches shots (AHoffmannMehatGameMode::SetBatchProjectiles):
+ * a shot here is a sweep, not an actor, so it only affects physics bodies and ADamageableTargets.
+ */
+UCLASS()
+class HOFFMANNMEHAT_API AProjectileManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AProjectileManager();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+	/** Adds a shot moving along Rotation, simulated like ProjectileClass would be */
+	void Fire(TSubclassOf<AHoffmannMehatProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, APawn* Shooter);
+
+	/** Shots currently simulated */
+	int32 GetNumShots() const { return Positions.Num(); }
+
+	/** Mesh each shot is drawn with, loaded in the background when play begins */
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile")
+	TSoftObjectPtr<UStaticMesh> ProxyMesh;
+
+	/** Uniform scale of ProxyMesh */
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile", meta = (ClampMin = "0"))
+	float ProxyScale;
+
+	/** Most bounces simulated for one shot in one frame */
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile", meta = (ClampMin = "1"))
+	int32 MaxIterations;
+
+private:
+	/** What a projectile class's default object says about its shots */
+	struct FShotParams
+	{
+		TSubclassOf<AHoffmannMehatProjectile> Class;
+		FName CollisionProfile;
+		float Radius;
+		float InitialSpeed;
+		float MaxSpeed;
+		float GravityScale;
+		bool bShouldBounce;
+		bool bBounceAngleAffectsFriction;
+		float Bounciness;
+		float Friction;
+		float BounceStopSpeed;
+		float LifeSpan;
+		float Damage;
+	};
+
+	/** Index of Class in ShotParams, added on first use */
+	int32 FindShotParams(TSubclassOf<AHoffmannMehatProjectile> Class);
+
+	/** Moves one shot through DeltaTime, returns false once it's used up */
+	bool SimulateShot(int32 Shot, float DeltaTime, float GravityZ, struct FCollisionQueryParams& QueryParams);
+
+	void RemoveShot(int32 Shot);
+
+	/** Writes every shot's position into the instanced mesh, instances past the last shot are hidden */
+	void UpdateProxies();
+
+	UPROPERTY(VisibleAnywhere, Category = "Projectile")
+	UInstancedStaticMeshComponent* Proxies;
+
+	TArray<FShotParams> ShotParams;
+
+	/** By shot, removal swaps the last shot in */
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> Lifetimes;
+	TArray<uint8> ParamIndices;
+	TArray<TWeakObjectPtr<APawn>> Shooters;
+
+	/** Whether the shot has played its hit confirmation, see AHoffmannMehatProjectile::ApplyHit */
+	TArray<bool> HitConfirmed;
+
+	/** Instances shown last frame, the instanced mesh never shrinks */
+	int32 NumVisibleProxies;
+};
@@ -13,5 +13,7 @@ UCLASS()
 class HOFFMANNMEHAT_API ATestPlayerController : public APlayerController
 {
 	GENERATED_BODY()
-	
+
+public:
+	ATestPlayerController();
 };
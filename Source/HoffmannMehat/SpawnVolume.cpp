@@ -1,7 +1,12 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SpawnVolume.h"
+#include "HoffmannMehatStats.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatCharacter.h"
+#include "AimSessionRecorder.h"
 #include "Components/BoxComponent.h"
+#include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "TheFirstActor.h"
 #include "TimerManager.h"
@@ -57,6 +62,9 @@ FVector ASpawnVolume::GetRandomPointinVolume()
 
 void ASpawnVolume::SpawnPickup()
 {
+	HOFFMANNMEHAT_SCOPE(SpawnPickup);
+	HOFFMANNMEHAT_LLM_SCOPE(Targets);
+
 	// if we set something to spawn
 	if (WhatToSpawn != NULL) {
 		// checking if it is a valid world
@@ -79,6 +87,13 @@ void ASpawnVolume::SpawnPickup()
 			// spawn the pickup
 			ATheFirstActor* const SpawnedPickup = World->SpawnActor<ATheFirstActor>(WhatToSpawn, SpawnLocation, SpawnRotation, SpawnParams);
 
+			// reaction times are measured from here
+			const AHoffmannMehatCharacter* Player = Cast<AHoffmannMehatCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+			if (SpawnedPickup != nullptr && Player != nullptr && Player->GetSessionRecorder() != nullptr)
+			{
+				Player->GetSessionRecorder()->RecordTargetSpawn(SpawnedPickup, FPlatformTime::Seconds());
+			}
+
 			//SpawnDelay = FMath::FRandRange(SpawnDelayRangeLow, SpawnDelayRangeHigh);
 			//GetWorldTimerManager().SetTimer(SpawnTimer, this, &ASpawnVolume::SpawnPickup, SpawnDelay, false);
 
@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "StickSweep.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "GameFramework/InputSettings.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogStickSweep, Log, All);
+
+namespace StickSweep
+{
+	/** Pitch steps start this far from the view limit they turn away from (deg) */
+	static const float PitchLimitMargin = 5.f;
+
+	static const TCHAR* AxisNames[] = { TEXT("Yaw"), TEXT("Pitch") };
+}
+
+FStickSweep::FStickSweep(UWorld* InWorld, const TArray<EAxis>& InAxes, int32 InNumSteps, float InHoldSeconds, float InSettleSeconds)
+	: World(InWorld)
+	, Axes(InAxes)
+	, NumSteps(FMath::Max(InNumSteps, 1))
+	, HoldSeconds(InHoldSeconds)
+	, SettleSeconds(InSettleSeconds)
+	, AxisIndex(0)
+	, Step(INDEX_NONE)
+	, StepTime(0.f)
+	, Stick(0.f)
+	, InjectScale(1.f)
+	, LastRotation(FRotator::ZeroRotator)
+	, bHasLastRotation(false)
+	, bFinished(false)
+{
+	// a frame per sample at up to 240 fps
+	const int32 ExpectedSamples = FMath::CeilToInt(NumSteps * (HoldSeconds + SettleSeconds) * 240.f);
+	for (TArray<FStickSweepSample>& AxisSamples : Samples)
+	{
+		AxisSamples.Reserve(ExpectedSamples);
+	}
+}
+
+TStatId FStickSweep::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FStickSweep, STATGROUP_Tickables);
+}
+
+bool FStickSweep::FindGamepadKey(FName AxisName, FKey& OutKey, float& OutScale)
+{
+	for (const FInputAxisKeyMapping& Mapping : UInputSettings::GetInputSettings()->AxisMappings)
+	{
+		if (Mapping.AxisName == AxisName && Mapping.Key.IsGamepadKey() && Mapping.Scale != 0.f)
+		{
+			OutKey = Mapping.Key;
+			OutScale = Mapping.Scale;
+			return true;
+		}
+	}
+	return false;
+}
+
+void FStickSweep::BeginStep(APlayerController* Controller)
+{
+	if (++Step >= NumSteps || Step == 0)
+	{
+		if (Step >= NumSteps)
+		{
+			// release the stick before moving to the next axis
+			Controller->InputAxis(InjectKey, 0.f, 0.f, 1, true);
+			++AxisIndex;
+			Step = 0;
+		}
+
+		if (AxisIndex >= Axes.Num())
+		{
+			Finish();
+			return;
+		}
+
+		const FName AxisName = Axes[AxisIndex] == EAxis::Yaw ? TEXT("TurnRate") : TEXT("LookUpRate");
+		if (!FindGamepadKey(AxisName, InjectKey, InjectScale))
+		{
+			UE_LOG(LogStickSweep, Error, TEXT("No gamepad key is mapped to %s"), *AxisName.ToString());
+			Finish();
+			return;
+		}
+	}
+
+	if (Axes[AxisIndex] == EAxis::Pitch && Controller->PlayerCameraManager != nullptr)
+	{
+		// start every pitch step from the limit it turns away from, so it can't hit the other one
+		const APlayerCameraManager* CameraManager = Controller->PlayerCameraManager;
+		FRotator Rotation = Controller->GetControlRotation();
+		Rotation.Pitch = Controller->InputPitchScale < 0.f ? CameraManager->ViewPitchMax - StickSweep::PitchLimitMargin : CameraManager->ViewPitchMin + StickSweep::PitchLimitMargin;
+		Controller->SetControlRotation(Rotation);
+		bHasLastRotation = false;
+	}
+
+	Stick = GetStepDeflection(Step);
+	StepTime = 0.f;
+}
+
+void FStickSweep::Tick(float DeltaTime)
+{
+	UWorld* SweepWorld = World.Get();
+	APlayerController* Controller = SweepWorld ? SweepWorld->GetFirstPlayerController() : nullptr;
+	if (Controller == nullptr)
+	{
+		Finish();
+		return;
+	}
+
+	if (Step == INDEX_NONE)
+	{
+		BeginStep(Controller);
+		if (bFinished)
+		{
+			return;
+		}
+	}
+	else
+	{
+		const FRotator Rotation = Controller->GetControlRotation();
+		if (bHasLastRotation && DeltaTime > 0.f)
+		{
+			FStickSweepSample Sample;
+			Sample.Seconds = FPlatformTime::Seconds();
+			Sample.Stick = Stick;
+			Sample.YawVelocity = FRotator::NormalizeAxis(Rotation.Yaw - LastRotation.Yaw) / DeltaTime;
+			Sample.PitchVelocity = FRotator::NormalizeAxis(Rotation.Pitch - LastRotation.Pitch) / DeltaTime;
+			Sample.Step = StepTime >= SettleSeconds ? Step : INDEX_NONE;
+
+			// a pitch step that reached the view limit stops measuring the curve
+			const APlayerCameraManager* CameraManager = Controller->PlayerCameraManager;
+			if (Axes[AxisIndex] == EAxis::Pitch && CameraManager != nullptr)
+			{
+				const float Pitch = FRotator::NormalizeAxis(Rotation.Pitch);
+				if (Pitch <= CameraManager->ViewPitchMin + 1.f || Pitch >= CameraManager->ViewPitchMax - 1.f)
+				{
+					Sample.Step = INDEX_NONE;
+				}
+			}
+
+			Samples[(int32)Axes[AxisIndex]].Add(Sample);
+		}
+		LastRotation = Rotation;
+		bHasLastRotation = true;
+
+		StepTime += DeltaTime;
+		if (StepTime >= SettleSeconds + HoldSeconds)
+		{
+			BeginStep(Controller);
+			if (bFinished)
+			{
+				return;
+			}
+		}
+	}
+
+	// gamepads send their axes every frame, so does the sweep
+	Controller->InputAxis(InjectKey, Stick / InjectScale, DeltaTime, 1, true);
+}
+
+void FStickSweep::Finish()
+{
+	if (bFinished)
+	{
+		return;
+	}
+	bFinished = true;
+
+	WriteResults();
+}
+
+void FStickSweep::WriteResults() const
+{
+	const FString BasePath = FPaths::ProjectSavedDir() / TEXT("StickSweep") / FString::Printf(TEXT("StickSweep-%s"), *FDateTime::Now().ToString());
+
+	// response table, the mean settled velocity of every step
+	FString Table = TEXT("input_percent,yaw_deg_per_s,pitch_deg_per_s\n");
+	for (int32 TableStep = 0; TableStep < NumSteps; ++TableStep)
+	{
+		Table += FString::Printf(TEXT("%.3f"), GetStepDeflection(TableStep) * 100.f);
+		for (int32 Axis = 0; Axis < 2; ++Axis)
+		{
+			double Sum = 0.0;
+			int32 Count = 0;
+			for (const FStickSweepSample& Sample : Samples[Axis])
+			{
+				if (Sample.Step == TableStep)
+				{
+					Sum += Axis == (int32)EAxis::Yaw ? Sample.YawVelocity : Sample.PitchVelocity;
+					++Count;
+				}
+			}
+			Table += Count > 0 ? FString::Printf(TEXT(",%.4f"), FMath::Abs(Sum / Count)) : FString(TEXT(","));
+		}
+		Table += TEXT("\n");
+	}
+
+	FString Frames = TEXT("axis,seconds,stick,yaw_deg_per_s,pitch_deg_per_s,step\n");
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		for (const FStickSweepSample& Sample : Samples[Axis])
+		{
+			Frames += FString::Printf(TEXT("%s,%.6f,%.4f,%.4f,%.4f,%d\n"), StickSweep::AxisNames[Axis], Sample.Seconds, Sample.Stick, Sample.YawVelocity, Sample.PitchVelocity, Sample.Step);
+		}
+	}
+
+	const FString TablePath = BasePath + TEXT("-table.csv");
+	const FString FramesPath = BasePath + TEXT("-frames.csv");
+	if (FFileHelper::SaveStringToFile(Table, *TablePath) && FFileHelper::SaveStringToFile(Frames, *FramesPath))
+	{
+		UE_LOG(LogStickSweep, Display, TEXT("Response table written to %s"), *TablePath);
+	}
+	else
+	{
+		UE_LOG(LogStickSweep, Error, TEXT("Failed to write %s"), *BasePath);
+	}
+}
+
+namespace StickSweep
+{
+	/** The running sweep, only kept alive by the ticker until it finishes */
+	static TWeakPtr<FStickSweep> ActiveSweep;
+
+	static void RunStickSweepCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		if (ActiveSweep.IsValid())
+		{
+			UE_LOG(LogStickSweep, Warning, TEXT("A stick sweep is already running"));
+			return;
+		}
+
+		const FString Params = FString::Join(Args, TEXT(" "));
+		FString AxisName = TEXT("Both");
+		int32 NumSteps = 50;
+		float HoldSeconds = 0.5f;
+		float SettleSeconds = 0.15f;
+		FParse::Value(*Params, TEXT("Axis="), AxisName);
+		FParse::Value(*Params, TEXT("Steps="), NumSteps);
+		FParse::Value(*Params, TEXT("Hold="), HoldSeconds);
+		FParse::Value(*Params, TEXT("Settle="), SettleSeconds);
+
+		TArray<FStickSweep::EAxis> Axes;
+		if (AxisName != TEXT("Pitch"))
+		{
+			Axes.Add(FStickSweep::EAxis::Yaw);
+		}
+		if (AxisName != TEXT("Yaw"))
+		{
+			Axes.Add(FStickSweep::EAxis::Pitch);
+		}
+
+		TSharedPtr<FStickSweep> Sweep = MakeShared<FStickSweep>(World, Axes, NumSteps, HoldSeconds, SettleSeconds);
+		ActiveSweep = Sweep;
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Sweep](float)
+		{
+			return !Sweep->IsFinished();
+		}));
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs StickSweepCommand(
+		TEXT("HoffmannMehat.StickSweep"),
+		TEXT("Injects a sweep of stick deflections and writes the measured angular velocity as a response table to Saved/StickSweep. Usage: HoffmannMehat.StickSweep [Axis=Yaw|Pitch|Both] [Steps=N] [Hold=S] [Settle=S]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunStickSweepCommand));
+}
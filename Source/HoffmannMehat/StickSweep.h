@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputCoreTypes.h"
+#include "Tickable.h"
+
+class APlayerController;
+class UWorld;
+
+/** One frame of a stick sweep */
+struct FStickSweepSample
+{
+	/** FPlatformTime::Seconds() when the frame was measured */
+	double Seconds;
+
+	/** Injected deflection [-1, 1] */
+	float Stick;
+
+	/** Angular velocity of the control rotation over the frame (deg/s) */
+	float YawVelocity;
+	float PitchVelocity;
+
+	/** Sweep step the sample belongs to, INDEX_NONE while settling */
+	int32 Step;
+};
+
+/**
+ * Measures what the look pipeline really does with a stick deflection. A programmable sweep of
+ * deflections is injected as gamepad axis events, so the engine's axis config (dead zone,
+ * sensitivity, exponent) and the controller's input scales all apply, and the resulting
+ * angular velocity is recorded every frame. Started with
+ *
+ *	HoffmannMehat.StickSweep [Axis=Yaw|Pitch|Both] [Steps=N] [Hold=S] [Settle=S]
+ *
+ * Writes the response table (deflection in percent against deg/s, the layout of our reference
+ * captures of the target game) and the raw frames as CSV to Saved/StickSweep. Leave the
+ * gamepad alone while it runs.
+ */
+class FStickSweep : public FTickableGameObject
+{
+public:
+	enum class EAxis : uint8
+	{
+		Yaw,
+		Pitch
+	};
+
+	FStickSweep(UWorld* InWorld, const TArray<EAxis>& InAxes, int32 InNumSteps, float InHoldSeconds, float InSettleSeconds);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !bFinished; }
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	bool IsFinished() const { return bFinished; }
+
+private:
+	/** Deflection of a sweep step, evenly spaced from 1/NumSteps to full */
+	float GetStepDeflection(int32 Step) const { return (Step + 1) / (float)NumSteps; }
+
+	/** First gamepad key mapped to an input axis, and the mapping's scale */
+	static bool FindGamepadKey(FName AxisName, FKey& OutKey, float& OutScale);
+
+	/** Moves on to the next step, or the next axis when the current one is done */
+	void BeginStep(APlayerController* Controller);
+
+	void Finish();
+
+	/** Writes the averaged response table and the raw frames */
+	void WriteResults() const;
+
+	TWeakObjectPtr<UWorld> World;
+	TArray<EAxis> Axes;
+	int32 NumSteps;
+	float HoldSeconds;
+	float SettleSeconds;
+
+	int32 AxisIndex;
+	int32 Step;
+	float StepTime;
+	float Stick;
+
+	FKey InjectKey;
+	float InjectScale;
+
+	FRotator LastRotation;
+	bool bHasLastRotation;
+
+	/** Samples per axis */
+	TArray<FStickSweepSample> Samples[2];
+
+	bool bFinished;
+};
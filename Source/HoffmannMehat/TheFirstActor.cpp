@@ -1,7 +1,10 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "TheFirstActor.h"
+#include "HoffmannMehatGameMode.h"
+#include "HoffmannMehatStats.h"
 #include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
 
 // Sets default values
 ATheFirstActor::ATheFirstActor()
@@ -21,12 +24,67 @@ void ATheFirstActor::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	// let the aim systems know there is a new target to measure against
+	if (AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GameMode->RegisterTarget(this);
+	}
+}
+
+void ATheFirstActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		GameMode->UnregisterTarget(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
 void ATheFirstActor::Tick(float DeltaTime)
 {
+	HOFFMANNMEHAT_SCOPE(TargetUpdate);
+
 	Super::Tick(DeltaTime);
 
 }
 
+
+void ATheFirstActor::Release()
+{
+	if (OnReleased.IsBound())
+	{
+		OnReleased.Execute(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void ATheFirstActor::SetPooledActive(bool bActive)
+{
+	SetActorHiddenInGame(!bActive);
+	SetActorEnableCollision(bActive);
+	SetActorTickEnabled(bActive);
+
+	// a shot may have knocked it about before it was killed
+	if (!bActive && TheFirstActor->IsSimulatingPhysics())
+	{
+		TheFirstActor->SetPhysicsLinearVelocity(FVector::ZeroVector);
+		TheFirstActor->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+	}
+
+	if (AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode()))
+	{
+		if (bActive)
+		{
+			GameMode->RegisterTarget(this);
+		}
+		else
+		{
+			GameMode->UnregisterTarget(this);
+		}
+	}
+}
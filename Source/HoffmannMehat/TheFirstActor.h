@@ -6,6 +6,10 @@
 #include "GameFramework/Actor.h"
 #include "TheFirstActor.generated.h"
 
+class ATheFirstActor;
+
+DECLARE_DELEGATE_OneParam(FOnTargetReleased, ATheFirstActor*);
+
 UCLASS()
 class HOFFMANNMEHAT_API ATheFirstActor : public AActor
 {
@@ -19,12 +23,24 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the actor is destroyed or the level is torn down
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
 	FORCEINLINE class UStaticMeshComponent* GetMesh() const { return TheFirstActor; }
 
+	/** Takes the target out of play: back to its pool if it has one, otherwise destroyed */
+	void Release();
+
+	/** Shows or hides a pooled target, and adds it to or removes it from the game mode's live targets */
+	virtual void SetPooledActive(bool bActive);
+
+	/** Bound by the pool that owns the target, Release hands the target back through it */
+	FOnTargetReleased OnReleased;
+
 
 private: 
 	// the static mesh to be the object, 
@@ -0,0 +1,434 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TrackingScore.h"
+#include "HoffmannMehatGameMode.h"
+#include "HoffmannMehatMemory.h"
+#include "HoffmannMehatStats.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+namespace TrackingScore
+{
+	/** Margin of targets behind the camera, far off target */
+	static const float BehindMargin = 1e6f;
+
+	/** Margin while the camera is inside a target's bounds */
+	static const float InsideMargin = -1.f;
+}
+
+float FTrackingScoreBatch::ComputeMargin(const FVector& Origin, const FVector& Direction, const FVector& Center, float Radius)
+{
+	const FVector ToCenter = Center - Origin;
+	const float Along = FVector::DotProduct(ToCenter, Direction);
+	const float LengthSquared = ToCenter.SizeSquared();
+
+	if (LengthSquared <= Radius * Radius)
+	{
+		return TrackingScore::InsideMargin;
+	}
+	if (Along <= KINDA_SMALL_NUMBER)
+	{
+		return TrackingScore::BehindMargin;
+	}
+
+	const float Perpendicular = FMath::Sqrt(FMath::Max(LengthSquared - Along * Along, KINDA_SMALL_NUMBER));
+	return (Perpendicular - Radius) / Along;
+}
+
+void FTrackingScoreBatch::ComputeMargins(const FVector& Origin, const FVector& Direction, const float* X, const float* Y, const float* Z, const float* Radius, int32 Count, float* OutMargins)
+{
+	const VectorRegister OX = VectorSetFloat1(Origin.X);
+	const VectorRegister OY = VectorSetFloat1(Origin.Y);
+	const VectorRegister OZ = VectorSetFloat1(Origin.Z);
+	const VectorRegister DX = VectorSetFloat1(Direction.X);
+	const VectorRegister DY = VectorSetFloat1(Direction.Y);
+	const VectorRegister DZ = VectorSetFloat1(Direction.Z);
+	const VectorRegister VSmall = VectorSetFloat1(KINDA_SMALL_NUMBER);
+	const VectorRegister VBehind = VectorSetFloat1(TrackingScore::BehindMargin);
+	const VectorRegister VInside = VectorSetFloat1(TrackingScore::InsideMargin);
+
+	int32 Index = 0;
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		const VectorRegister VX = VectorSubtract(VectorLoad(X + Index), OX);
+		const VectorRegister VY = VectorSubtract(VectorLoad(Y + Index), OY);
+		const VectorRegister VZ = VectorSubtract(VectorLoad(Z + Index), OZ);
+		const VectorRegister VRadius = VectorLoad(Radius + Index);
+
+		const VectorRegister Along = VectorMultiplyAdd(VX, DX, VectorMultiplyAdd(VY, DY, VectorMultiply(VZ, DZ)));
+		const VectorRegister LengthSquared = VectorMultiplyAdd(VX, VX, VectorMultiplyAdd(VY, VY, VectorMultiply(VZ, VZ)));
+
+		// clamped away from 0 so the reciprocal square root stays finite
+		const VectorRegister PerpendicularSquared = VectorMax(VectorSubtract(LengthSquared, VectorMultiply(Along, Along)), VSmall);
+		const VectorRegister Perpendicular = VectorMultiply(PerpendicularSquared, VectorReciprocalSqrtAccurate(PerpendicularSquared));
+
+		VectorRegister Margin = VectorMultiply(VectorSubtract(Perpendicular, VRadius), VectorReciprocal(VectorMax(Along, VSmall)));
+		Margin = VectorSelect(VectorCompareGT(Along, VSmall), Margin, VBehind);
+		Margin = VectorSelect(VectorCompareGT(LengthSquared, VectorMultiply(VRadius, VRadius)), Margin, VInside);
+		VectorStore(Margin, OutMargins + Index);
+	}
+
+	for (; Index < Count; ++Index)
+	{
+		OutMargins[Index] = ComputeMargin(Origin, Direction, FVector(X[Index], Y[Index], Z[Index]), Radius[Index]);
+	}
+}
+
+float FTrackingScoreBatch::ComputeOnTargetFraction(const float* PrevMargins, const float* Margins, int32 Count)
+{
+	// overlapping targets count once, the longest stretch on any of them stands for the union
+	const VectorRegister VZero = VectorZero();
+	const VectorRegister VOne = VectorOne();
+	VectorRegister VFraction = VZero;
+
+	int32 Index = 0;
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		const VectorRegister Prev = VectorLoad(PrevMargins + Index);
+		const VectorRegister Current = VectorLoad(Margins + Index);
+		const VectorRegister PrevOn = VectorCompareGE(VZero, Prev);
+		const VectorRegister CurrentOn = VectorCompareGE(VZero, Current);
+
+		// where the margin crosses 0, only used in lanes where it does
+		const VectorRegister Crossing = VectorMultiply(Prev, VectorReciprocal(VectorSubtract(Prev, Current)));
+
+		const VectorRegister Fraction = VectorSelect(PrevOn,
+			VectorSelect(CurrentOn, VOne, Crossing),
+			VectorSelect(CurrentOn, VectorSubtract(VOne, Crossing), VZero));
+		VFraction = VectorMax(VFraction, Fraction);
+	}
+
+	MS_ALIGN(16) float Lanes[4] GCC_ALIGN(16);
+	VectorStoreAligned(VFraction, Lanes);
+	float Fraction = FMath::Max(FMath::Max(Lanes[0], Lanes[1]), FMath::Max(Lanes[2], Lanes[3]));
+
+	for (; Index < Count; ++Index)
+	{
+		const float Prev = PrevMargins[Index];
+		const float Current = Margins[Index];
+		if (Prev <= 0.f && Current <= 0.f)
+		{
+			return 1.f;
+		}
+		if (Prev <= 0.f || Current <= 0.f)
+		{
+			const float Crossing = Prev / (Prev - Current);
+			Fraction = FMath::Max(Fraction, Prev <= 0.f ? Crossing : 1.f - Crossing);
+		}
+	}
+	return Fraction;
+}
+
+UTrackingScoreComponent::UTrackingScoreComponent()
+{
+	// Sample after the camera has been updated this frame
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	TargetRadiusScale = 1.f;
+	TrackedSeconds = 0.f;
+	OnTargetSeconds = 0.f;
+	ErrorSeconds = 0.f;
+	LastError = 0.f;
+	bHasLastFrame = false;
+	bTracking = false;
+}
+
+void UTrackingScoreComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BeginTracking();
+}
+
+void UTrackingScoreComponent::BeginTracking()
+{
+	TrackedSeconds = 0.f;
+	OnTargetSeconds = 0.f;
+	ErrorSeconds = 0.f;
+	bHasLastFrame = false;
+	bTracking = true;
+}
+
+void UTrackingScoreComponent::EndTracking()
+{
+	bTracking = false;
+}
+
+float UTrackingScoreComponent::GetOnTargetRatio() const
+{
+	return TrackedSeconds > 0.f ? OnTargetSeconds / TrackedSeconds : 0.f;
+}
+
+float UTrackingScoreComponent::GetMeanAngularError() const
+{
+	return TrackedSeconds > 0.f ? ErrorSeconds / TrackedSeconds : 0.f;
+}
+
+APlayerCameraManager* UTrackingScoreComponent::GetCameraManager() const
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	const APlayerController* Controller = Pawn ? Cast<APlayerController>(Pawn->GetController()) : nullptr;
+	return Controller ? Controller->PlayerCameraManager : nullptr;
+}
+
+void UTrackingScoreComponent::PackTargets(const TArray<AActor*>& LiveTargets)
+{
+	const int32 NumTargets = LiveTargets.Num();
+	const int32 NumOldTargets = Targets.Num();
+
+	Targets.SetNum(NumTargets);
+	LocalCenters.SetNum(NumTargets);
+	Radii.SetNum(NumTargets);
+	CenterX.SetNumUninitialized(NumTargets);
+	CenterY.SetNumUninitialized(NumTargets);
+	CenterZ.SetNumUninitialized(NumTargets);
+	ScaledRadii.SetNumUninitialized(NumTargets);
+	Margins.SetNumUninitialized(NumTargets);
+	PrevMargins.SetNumUninitialized(NumTargets);
+
+	FreshSlots.Reset();
+	for (int32 Slot = 0; Slot < NumTargets; ++Slot)
+	{
+		const AActor* Target = LiveTargets[Slot];
+		const FTransform& Transform = Target->GetActorTransform();
+
+		// the registry only swaps on removal, so nearly every slot keeps its target
+		if (Slot >= NumOldTargets || Targets[Slot] != Target)
+		{
+			FVector Origin, Extent;
+			Target->GetActorBounds(true, Origin, Extent);
+			Targets[Slot] = Target;
+			LocalCenters[Slot] = Transform.InverseTransformPosition(Origin);
+			Radii[Slot] = Extent.Size();
+			FreshSlots.Add(Slot);
+		}
+
+		const FVector Center = Transform.TransformPosition(LocalCenters[Slot]);
+		CenterX[Slot] = Center.X;
+		CenterY[Slot] = Center.Y;
+		CenterZ[Slot] = Center.Z;
+		ScaledRadii[Slot] = Radii[Slot] * TargetRadiusScale;
+	}
+}
+
+void UTrackingScoreComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	HOFFMANNMEHAT_SCOPE(TrackingScore);
+	HOFFMANNMEHAT_LLM_SCOPE(Analytics);
+
+	const APlayerCameraManager* CameraManager = GetCameraManager();
+	const AHoffmannMehatGameMode* GameMode = Cast<AHoffmannMehatGameMode>(GetWorld()->GetAuthGameMode());
+	if (!bTracking || CameraManager == nullptr || GameMode == nullptr || GameMode->GetLiveTargets().Num() == 0)
+	{
+		bHasLastFrame = false;
+		return;
+	}
+
+	// this frame's margins become the previous ones before the new ones are computed
+	Swap(Margins, PrevMargins);
+	PackTargets(GameMode->GetLiveTargets());
+
+	const int32 NumTargets = Targets.Num();
+	const FVector Origin = CameraManager->GetCameraLocation();
+	const FVector Direction = CameraManager->GetCameraRotation().Vector();
+	FTrackingScoreBatch::ComputeMargins(Origin, Direction, CenterX.GetData(), CenterY.GetData(), CenterZ.GetData(), ScaledRadii.GetData(), NumTargets, Margins.GetData());
+
+	for (int32 Slot : FreshSlots)
+	{
+		PrevMargins[Slot] = Margins[Slot];
+	}
+
+	float ClosestMargin = TrackingScore::BehindMargin;
+	for (int32 Slot = 0; Slot < NumTargets; ++Slot)
+	{
+		ClosestMargin = FMath::Min(ClosestMargin, Margins[Slot]);
+	}
+	const float Error = FMath::RadiansToDegrees(FMath::Atan(FMath::Max(ClosestMargin, 0.f)));
+
+	if (bHasLastFrame)
+	{
+		TrackedSeconds += DeltaTime;
+		OnTargetSeconds += DeltaTime * FTrackingScoreBatch::ComputeOnTargetFraction(PrevMargins.GetData(), Margins.GetData(), NumTargets);
+		ErrorSeconds += DeltaTime * 0.5f * (LastError + Error);
+	}
+	LastError = Error;
+	bHasLastFrame = true;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TrackingScore
+{
+	/** The vector paths use reciprocal estimates, the scalar one divides */
+	static const float KernelTolerance = 1e-4f;
+
+	static bool IsNearlyEqualRelative(float A, float B)
+	{
+		return FMath::Abs(A - B) <= KernelTolerance * FMath::Max(1.f, FMath::Max(FMath::Abs(A), FMath::Abs(B)));
+	}
+
+	/** Per target fraction of the frame on it, the longest one, written out the slow way */
+	static float ReferenceOnTargetFraction(const TArray<float>& PrevMargins, const TArray<float>& Margins)
+	{
+		float Fraction = 0.f;
+		for (int32 Index = 0; Index < Margins.Num(); ++Index)
+		{
+			const float Prev = PrevMargins[Index];
+			const float Current = Margins[Index];
+			float TargetFraction = 0.f;
+			if (Prev <= 0.f && Current <= 0.f)
+			{
+				TargetFraction = 1.f;
+			}
+			else if (Prev <= 0.f)
+			{
+				// on until the margin reaches 0
+				TargetFraction = -Prev / (Current - Prev);
+			}
+			else if (Current <= 0.f)
+			{
+				TargetFraction = -Current / (Prev - Current);
+			}
+			Fraction = FMath::Max(Fraction, TargetFraction);
+		}
+		return Fraction;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTrackingScoreMarginsTest, "HoffmannMehat.TrackingScore.Margins", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTrackingScoreMarginsTest::RunTest(const FString& Parameters)
+{
+	const FVector Origin(100.f, -50.f, 170.f);
+	const FVector Direction = FVector(1.f, 0.2f, -0.1f).GetSafeNormal();
+	FRandomStream Stream(41);
+
+	// every count from empty to three vectors and a partial one, so each lane and the tail are covered
+	for (int32 Count = 0; Count <= 13; ++Count)
+	{
+		TArray<float> X, Y, Z, Radius;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			FVector Center;
+			float TargetRadius = Stream.FRandRange(5.f, 60.f);
+			switch (Index % 5)
+			{
+			case 0:
+				// behind the camera
+				Center = Origin - Direction * Stream.FRandRange(100.f, 2000.f) + Stream.GetUnitVector() * 20.f;
+				break;
+			case 1:
+				// the camera is inside it
+				Center = Origin + Stream.GetUnitVector() * TargetRadius * 0.5f;
+				break;
+			case 2:
+				// right on the crosshair
+				Center = Origin + Direction * Stream.FRandRange(200.f, 3000.f);
+				break;
+			default:
+				Center = Origin + Direction * Stream.FRandRange(200.f, 3000.f) + Stream.GetUnitVector() * Stream.FRandRange(0.f, 400.f);
+				break;
+			}
+			X.Add(Center.X);
+			Y.Add(Center.Y);
+			Z.Add(Center.Z);
+			Radius.Add(TargetRadius);
+		}
+
+		TArray<float> Margins;
+		Margins.SetNumUninitialized(Count);
+		FTrackingScoreBatch::ComputeMargins(Origin, Direction, X.GetData(), Y.GetData(), Z.GetData(), Radius.GetData(), Count, Margins.GetData());
+
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector Center(X[Index], Y[Index], Z[Index]);
+			const float Expected = FTrackingScoreBatch::ComputeMargin(Origin, Direction, Center, Radius[Index]);
+
+			// the perpendicular distance comes from a difference of squares, near the crosshair both
+			// paths only agree to the rounding of the squared distance
+			const FVector ToCenter = Center - Origin;
+			const float Along = FMath::Max(FVector::DotProduct(ToCenter, Direction), 1.f);
+			const float Tolerance = TrackingScore::KernelTolerance * FMath::Max(1.f, FMath::Abs(Expected)) + FMath::Sqrt(4.f * FLT_EPSILON * ToCenter.SizeSquared()) / Along;
+			if (FMath::Abs(Margins[Index] - Expected) > Tolerance)
+			{
+				AddError(FString::Printf(TEXT("%d targets, target %d: margin %f, scalar %f"), Count, Index, Margins[Index], Expected));
+			}
+		}
+	}
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTrackingScoreOnTargetTest, "HoffmannMehat.TrackingScore.OnTargetFraction", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTrackingScoreOnTargetTest::RunTest(const FString& Parameters)
+{
+	struct FCase
+	{
+		float Prev;
+		float Current;
+		float Expected;
+	};
+	const FCase Cases[] =
+	{
+		{ 1.f, -1.f, 0.5f },	// acquired half way through the frame
+		{ -1.f, 3.f, 0.25f },	// lost a quarter of the way through
+		{ -0.5f, -0.1f, 1.f },	// on the whole frame
+		{ 0.2f, 0.1f, 0.f },	// off the whole frame
+		{ 0.f, 2.f, 0.f },		// left right at the start
+		{ 2.f, 0.f, 0.f },		// reached right at the end
+	};
+
+	// each case alone among off target fillers, in every lane and in the tail
+	for (const FCase& Case : Cases)
+	{
+		for (int32 Count = 1; Count <= 9; ++Count)
+		{
+			for (int32 Slot = 0; Slot < Count; ++Slot)
+			{
+				TArray<float> PrevMargins, Margins;
+				PrevMargins.Init(TrackingScore::BehindMargin, Count);
+				Margins.Init(0.3f, Count);
+				PrevMargins[Slot] = Case.Prev;
+				Margins[Slot] = Case.Current;
+
+				const float Fraction = FTrackingScoreBatch::ComputeOnTargetFraction(PrevMargins.GetData(), Margins.GetData(), Count);
+				if (!TrackingScore::IsNearlyEqualRelative(Fraction, Case.Expected))
+				{
+					AddError(FString::Printf(TEXT("%d targets, %f -> %f in slot %d: fraction %f, expected %f"), Count, Case.Prev, Case.Current, Slot, Fraction, Case.Expected));
+				}
+			}
+		}
+	}
+
+	// overlapping crossings, the longest stretch on any target counts
+	FRandomStream Stream(41);
+	for (int32 Count = 0; Count <= 13; ++Count)
+	{
+		for (int32 Trial = 0; Trial < 16; ++Trial)
+		{
+			TArray<float> PrevMargins, Margins;
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				PrevMargins.Add(Stream.FRandRange(-0.2f, 1.f));
+				Margins.Add(Stream.FRandRange(-0.2f, 1.f));
+			}
+
+			const float Fraction = FTrackingScoreBatch::ComputeOnTargetFraction(PrevMargins.GetData(), Margins.GetData(), Count);
+			const float Expected = TrackingScore::ReferenceOnTargetFraction(PrevMargins, Margins);
+			if (!TrackingScore::IsNearlyEqualRelative(Fraction, Expected))
+			{
+				AddError(FString::Printf(TEXT("%d targets, trial %d: fraction %f, expected %f"), Count, Trial, Fraction, Expected));
+			}
+		}
+	}
+	return !HasAnyErrors();
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
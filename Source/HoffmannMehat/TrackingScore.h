@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TrackingScore.generated.h"
+
+/**
+ * Crosshair ray against a packed array of target bounding spheres, four targets per vector op.
+ * A target's margin is the ray's distance from the sphere surface divided by the distance along
+ * the ray, about the tangent of the angle between the crosshair and the target's edge: <= 0 on
+ * target, > 0 off it.
+ */
+struct HOFFMANNMEHAT_API FTrackingScoreBatch
+{
+	/** Writes Count margins for the ray from Origin along the unit Direction */
+	static void ComputeMargins(const FVector& Origin, const FVector& Direction, const float* X, const float* Y, const float* Z, const float* Radius, int32 Count, float* OutMargins);
+
+	/**
+	 * Fraction of the frame the crosshair spent on any target, with each target's margin
+	 * interpolated linearly from PrevMargins to Margins
+	 */
+	static float ComputeOnTargetFraction(const float* PrevMargins, const float* Margins, int32 Count);
+
+	static float ComputeMargin(const FVector& Origin, const FVector& Direction, const FVector& Center, float Radius);
+};
+
+/**
+ * Scores tracking drills: every frame the camera ray is tested against the bounds of all live
+ * targets, and the time on target and the angular error to the closest target's edge are
+ * integrated with sub-frame precision.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class HOFFMANNMEHAT_API UTrackingScoreComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTrackingScoreComponent();
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Resets the score and starts tracking */
+	UFUNCTION(BlueprintCallable, Category = "Statistics")
+	void BeginTracking();
+
+	/** Stops tracking, the score is kept until the next BeginTracking */
+	UFUNCTION(BlueprintCallable, Category = "Statistics")
+	void EndTracking();
+
+	/** Time tracked since BeginTracking, frames without targets don't count (s) */
+	UFUNCTION(BlueprintPure, Category = "Statistics")
+	float GetTrackedSeconds() const { return TrackedSeconds; }
+
+	/** Time the crosshair was on a target (s) */
+	UFUNCTION(BlueprintPure, Category = "Statistics")
+	float GetOnTargetSeconds() const { return OnTargetSeconds; }
+
+	/** OnTargetSeconds / TrackedSeconds */
+	UFUNCTION(BlueprintPure, Category = "Statistics")
+	float GetOnTargetRatio() const;
+
+	/** Time averaged angle from the crosshair to the closest target's edge, 0 while on target (deg) */
+	UFUNCTION(BlueprintPure, Category = "Statistics")
+	float GetMeanAngularError() const;
+
+	/** Scales the targets' bounding spheres, which hug the corners of boxy meshes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Statistics", meta = (ClampMin = "0"))
+	float TargetRadiusScale;
+
+protected:
+	/** Camera the player sees through, the same one OnFire shoots from */
+	class APlayerCameraManager* GetCameraManager() const;
+
+	/** Copies the targets' current bounds into the packed arrays */
+	void PackTargets(const TArray<AActor*>& LiveTargets);
+
+private:
+	/** Targets in the game mode's registry order, by slot */
+	TArray<const AActor*> Targets;
+
+	/** Bounding sphere of each slot's target, relative to the actor, measured when it entered the slot */
+	TArray<FVector> LocalCenters;
+	TArray<float> Radii;
+
+	/** Packed world space bounds and margins, by slot */
+	TArray<float> CenterX;
+	TArray<float> CenterY;
+	TArray<float> CenterZ;
+	TArray<float> ScaledRadii;
+	TArray<float> Margins;
+	TArray<float> PrevMargins;
+
+	/** Slots whose target changed this frame, they have no previous margin */
+	TArray<int32> FreshSlots;
+
+	float TrackedSeconds;
+	float OnTargetSeconds;
+
+	/** Angular error integrated over time (deg s) */
+	float ErrorSeconds;
+	float LastError;
+	bool bHasLastFrame;
+
+	bool bTracking;
+};
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WeaponKick.h"
+#include "Components/SceneComponent.h"
+
+namespace WeaponKick
+{
+	/** Below this on every channel the weapon is at rest (cm, deg, per s) */
+	static const float SettleThreshold = 0.001f;
+
+	static const FName DefaultProfile(TEXT("Default"));
+
+	/**
+	 * Velocity that makes a spring starting at rest peak at 1. A spring kicked with v0 peaks at
+	 * v0 / w * exp(-z acos(z) / sqrt(1 - z^2)).
+	 */
+	static float PeakToVelocity(float AngularFrequency, float DampingRatio)
+	{
+		DampingRatio = FMath::Clamp(DampingRatio, 0.f, 0.95f);
+		const float Damped = FMath::Sqrt(1.f - DampingRatio * DampingRatio);
+		return AngularFrequency * FMath::Exp(DampingRatio * FMath::Acos(DampingRatio) / Damped);
+	}
+}
+
+UWeaponKickComponent::UWeaponKickComponent()
+{
+	// Ticks only while the weapon is moving
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	Profiles.Add(WeaponKick::DefaultProfile, FWeaponKickProfile());
+	ActiveProfile = WeaponKick::DefaultProfile;
+	bVisualRecoil = true;
+
+	RestLocation = FVector::ZeroVector;
+	RestRotation = FQuat::Identity;
+	FMemory::Memzero(Position);
+	FMemory::Memzero(Velocity);
+}
+
+void UWeaponKickComponent::SetKickTarget(USceneComponent* Target)
+{
+	Settle();
+
+	KickTarget = Target;
+	if (Target != nullptr)
+	{
+		RestLocation = Target->RelativeLocation;
+		RestRotation = Target->RelativeRotation.Quaternion();
+	}
+}
+
+const FWeaponKickProfile* UWeaponKickComponent::GetActiveProfile() const
+{
+	return Profiles.Find(ActiveProfile);
+}
+
+void UWeaponKickComponent::SetProfile(FName ProfileName)
+{
+	ActiveProfile = ProfileName;
+}
+
+void UWeaponKickComponent::SetVisualRecoilEnabled(bool bEnabled)
+{
+	bVisualRecoil = bEnabled;
+	if (!bVisualRecoil)
+	{
+		Settle();
+	}
+}
+
+void UWeaponKickComponent::Kick()
+{
+	const FWeaponKickProfile* Profile = GetActiveProfile();
+	if (!bVisualRecoil || Profile == nullptr || !KickTarget.IsValid())
+	{
+		return;
+	}
+
+	const float AngularFrequency = 2.f * PI * Profile->Frequency;
+	const float Scale = WeaponKick::PeakToVelocity(AngularFrequency, Profile->DampingRatio);
+
+	// velocity adds up, so a burst climbs further than a single shot
+	Velocity[OffsetX] += Profile->Offset.X * Scale;
+	Velocity[OffsetY] += Profile->Offset.Y * Scale;
+	Velocity[OffsetZ] += Profile->Offset.Z * Scale;
+	Velocity[Pitch] += Profile->Pitch * Scale;
+	Velocity[Yaw] += FMath::FRandRange(-Profile->YawSpread, Profile->YawSpread) * Scale;
+	Velocity[Roll] += FMath::FRandRange(-Profile->RollSpread, Profile->RollSpread) * Scale;
+
+	SetComponentTickEnabled(true);
+}
+
+void UWeaponKickComponent::Settle()
+{
+	FMemory::Memzero(Position);
+	FMemory::Memzero(Velocity);
+
+	if (USceneComponent* Target = KickTarget.Get())
+	{
+		Target->SetRelativeLocationAndRotation(RestLocation, RestRotation);
+	}
+	SetComponentTickEnabled(false);
+}
+
+void UWeaponKickComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const FWeaponKickProfile* Profile = GetActiveProfile();
+	USceneComponent* Target = KickTarget.Get();
+	if (Profile == nullptr || Target == nullptr)
+	{
+		Settle();
+		return;
+	}
+
+	// x(t) = e^(-a t) (x0 cos(wd t) + (v0 + a x0) / wd sin(wd t)), exact for any DeltaTime
+	const float DampingRatio = FMath::Clamp(Profile->DampingRatio, 0.f, 0.95f);
+	const float AngularFrequency = 2.f * PI * Profile->Frequency;
+	const float Decay = DampingRatio * AngularFrequency;
+	const float Damped = AngularFrequency * FMath::Sqrt(1.f - DampingRatio * DampingRatio);
+
+	float Sin, Cos;
+	FMath::SinCos(&Sin, &Cos, Damped * DeltaTime);
+	const float Envelope = FMath::Exp(-Decay * DeltaTime);
+
+	bool bMoving = false;
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		const float X0 = Position[Channel];
+		const float V0 = Velocity[Channel];
+		Position[Channel] = Envelope * (X0 * Cos + (V0 + Decay * X0) / Damped * Sin);
+		Velocity[Channel] = Envelope * (V0 * Cos - (Decay * V0 + AngularFrequency * AngularFrequency * X0) / Damped * Sin);
+
+		bMoving |= FMath::Abs(Position[Channel]) > WeaponKick::SettleThreshold || FMath::Abs(Velocity[Channel]) > WeaponKick::SettleThreshold;
+	}
+
+	if (!bMoving)
+	{
+		Settle();
+		return;
+	}
+
+	// rotates about the parent's origin, the camera, so the muzzle climbs rather than the arms tipping
+	const FQuat KickRotation = FRotator(Position[Pitch], Position[Yaw], Position[Roll]).Quaternion();
+	const FVector Location = KickRotation.RotateVector(RestLocation) + FVector(Position[OffsetX], Position[OffsetY], Position[OffsetZ]);
+	Target->SetRelativeLocationAndRotation(Location, KickRotation * RestRotation);
+}
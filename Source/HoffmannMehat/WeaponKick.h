@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WeaponKick.generated.h"
+
+/** How a single shot kicks the weapon, every channel settles on the same spring */
+USTRUCT(BlueprintType)
+struct FWeaponKickProfile
+{
+	GENERATED_BODY()
+
+	/** Peak offset of one shot in the weapon's parent space, X forward (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recoil")
+	FVector Offset;
+
+	/** Peak muzzle climb of one shot (deg) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recoil")
+	float Pitch;
+
+	/** Each shot's peak yaw and roll are random in [-Spread, Spread] (deg) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recoil", meta = (ClampMin = "0"))
+	float YawSpread;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recoil", meta = (ClampMin = "0"))
+	float RollSpread;
+
+	/** Undamped frequency of the spring (Hz) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recoil", meta = (ClampMin = "0.1"))
+	float Frequency;
+
+	/** 0 rings forever, close to 1 settles without overshooting */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recoil", meta = (ClampMin = "0", ClampMax = "0.95"))
+	float DampingRatio;
+
+	FWeaponKickProfile()
+		: Offset(-3.f, 0.f, 0.5f)
+		, Pitch(2.f)
+		, YawSpread(0.5f)
+		, RollSpread(1.f)
+		, Frequency(8.f)
+		, DampingRatio(0.5f)
+	{
+	}
+};
+
+/**
+ * Procedural recoil for the first person weapon. Each shot adds velocity to a damped spring per
+ * channel, and the spring is stepped with its closed form solution, so a frame costs the same
+ * few multiplies no matter how many shots are in flight or how long the frame was. The offset
+ * is applied on top of the target's rest transform, rotating about the camera.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class HOFFMANNMEHAT_API UWeaponKickComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponKickComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Component to kick, its current relative transform is taken as the rest pose */
+	void SetKickTarget(USceneComponent* Target);
+
+	/** Kicks with the active profile */
+	UFUNCTION(BlueprintCallable, Category = "Recoil")
+	void Kick();
+
+	/** Switches to one of Profiles, shots already in flight settle on the new spring */
+	UFUNCTION(BlueprintCallable, Category = "Recoil")
+	void SetProfile(FName ProfileName);
+
+	/** Turns visual recoil on or off, off snaps the weapon back to rest */
+	UFUNCTION(BlueprintCallable, Category = "Recoil")
+	void SetVisualRecoilEnabled(bool bEnabled);
+
+	UFUNCTION(BlueprintPure, Category = "Recoil")
+	bool IsVisualRecoilEnabled() const { return bVisualRecoil; }
+
+	/** Kick profiles by name, e.g. one per weapon or drill */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recoil")
+	TMap<FName, FWeaponKickProfile> Profiles;
+
+	/** Profile Kick uses */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Recoil")
+	FName ActiveProfile;
+
+protected:
+	/** Off for pure aim drills, where the weapon moving is only a distraction */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Recoil")
+	bool bVisualRecoil;
+
+	/** Puts the target back at rest and stops ticking */
+	void Settle();
+
+private:
+	enum EChannel
+	{
+		OffsetX,
+		OffsetY,
+		OffsetZ,
+		Pitch,
+		Yaw,
+		Roll,
+
+		NumChannels
+	};
+
+	const FWeaponKickProfile* GetActiveProfile() const;
+
+	TWeakObjectPtr<USceneComponent> KickTarget;
+	FVector RestLocation;
+	FQuat RestRotation;
+
+	/** Spring state by EChannel */
+	float Position[NumChannels];
+	float Velocity[NumChannels];
+};